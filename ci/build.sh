@@ -49,7 +49,7 @@ function build_dpdk()
         -Dbuildtype=release \
         -Dmax_numa_nodes=1 \
         -Ddisable_drivers=all \
-        -Denable_drivers=net_e1000,net_igc,net_ixgbe,net_ice,net_af_xdp,net_tap,net_virtio,net_ring,net_bpf,net_vhost
+        -Denable_drivers=net_e1000,net_igc,net_ixgbe,net_ice,net_af_xdp,net_tap,net_virtio,net_ring,net_bpf,net_vhost,event_sw
 
     # Install
     ninja -C build
@@ -87,6 +87,7 @@ function build_apps()
     cmake -S ./ -B "$BUILD_DIR" \
         -DCMAKE_BUILD_TYPE=Release \
         -DBUILD_TESTS=ON \
+        -DBUILD_BENCH=OFF \
         -DBUILD_SAMPLES=OFF \
         -DCMAKE_INSTALL_PREFIX="$INSTALL_DIR" \
         -DCMAKE_CXX_FLAGS_RELEASE="-O3 -msse3" \
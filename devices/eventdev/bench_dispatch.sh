@@ -0,0 +1,42 @@
+#!/bin/bash
+# Dispatch of the processor's workers on the same capture, replayed at full speed:
+#   1. rss: APPID hash to the worker rings, a stream is bound to its worker
+#   2. eventdev: atomic flow per APPID on event_sw, any worker takes any stream
+# Packets of each lcore show the balance, Rate - the throughput of the main lcore.
+#
+# PCAP=skewed.pcap LOOPS=50 LCORES="0-2 0-4" PROC_OPTS="--sv80 100 --sv256 8" ./bench_dispatch.sh
+# Skewed APPIDs: a few SV256 streams among SV80 ones, GOOSE bursts of one publisher...
+# e.g. tcpdump of the generator's traffic. Run as root from the install dir.
+
+set -e
+
+PCAP=${PCAP:?"PCAP must be set"}
+LOOPS=${LOOPS:-50}
+LCORES=${LCORES:-"0-2 0-4"}
+PROC_OPTS=${PROC_OPTS:-"--goose 100 --sv80 100"}
+LOG_DIR=dispatch_bench_logs
+
+# $1 - name, $2 - lcores, $3 - processor's options
+function run_case()
+{
+    local log="$LOG_DIR/$1_${2}.log"
+    echo "*** $1, lcores $2"
+
+    bin/bus_processor -l $2 --no-pci \
+        --huge-dir=/mnt/bus_proc/ --file-prefix=bus_proc \
+        -- $PROC_OPTS --replay "$PCAP" --loops $LOOPS $3 > "$log" 2>&1 || true
+
+    grep -E "^(Main|LCore)" "$log" || true
+    grep -E "^(Eventdev|Replay):" "$log" || true
+    sed -n "/^ Ring/,/^$/p" "$log"
+    echo
+}
+
+mkdir -p $LOG_DIR
+
+for lcores in $LCORES; do
+    run_case rss $lcores ""
+    run_case eventdev $lcores "--eventdev"
+done
+
+echo "Logs: $LOG_DIR/"
@@ -0,0 +1,17 @@
+#!/bin/sh
+# AF_XDP mode: the interface stays with its kernel driver, pbus_xdp.o takes
+# GOOSE/SV/PTP/HSR and R-GOOSE/R-SV of the queue, IP(SSH, SNMP) stays in the kernel.
+#
+# ./run_processor_xdp.sh eth1 --goose 100 --sv80 100
+#
+# GOOSE/SV have no IP header, so RSS puts them into queue 0 usually, otherwise:
+# ethtool -L eth1 combined 1
+
+IFACE=$1
+shift
+
+bin/bus_processor -l 2          \
+    --no-pci                    \
+    --huge-dir=/mnt/bus_proc/   \
+    --file-prefix=bus_proc      \
+    -- --xdp $IFACE --xdp-queue 0 $@
@@ -0,0 +1,80 @@
+#!/bin/bash
+# RX paths of the processor on a veth pair, the generator sends by af_packet:
+#   1. af_packet PMD: DPDK gets a copy of every frame, the kernel still receives them all
+#   2. af_xdp PMD with its default program: all frames go to the socket
+#   3. af_xdp PMD with pbus_xdp.o: ProcessBus frames only, IP stays in the kernel
+# The RX end and the processor are in their own namespace, so ping crosses the pair:
+# IP traffic runs in parallel, its loss shows what the kernel didn't get.
+#
+# DURATION=20 GEN_OPTS="--goose 100,1000 --sv80 100" PROC_OPTS="--goose 100 --sv80 100" ./veth_bench.sh
+# Run as root from the install dir, veth has no zero-copy: AF_XDP is in copy mode.
+
+set -e
+
+DURATION=${DURATION:-20}
+GEN_OPTS=${GEN_OPTS:-"--goose 100,1000 --sv80 100"}
+PROC_OPTS=${PROC_OPTS:-"--goose 100 --sv80 100"}
+TX_IF=pbus_veth_tx
+RX_IF=pbus_veth_rx
+RX_NS=pbus_rx
+LOG_DIR=veth_bench_logs
+
+function setup_veth()
+{
+    ip link del $TX_IF 2>/dev/null || true
+    ip netns del $RX_NS 2>/dev/null || true
+    ip netns add $RX_NS
+    ip link add $TX_IF type veth peer name $RX_IF netns $RX_NS
+    ip addr add 10.99.0.1/24 dev $TX_IF
+    ip netns exec $RX_NS ip addr add 10.99.0.2/24 dev $RX_IF
+    ip link set $TX_IF up
+    ip netns exec $RX_NS ip link set $RX_IF up
+    ip netns exec $RX_NS ip link set lo up
+    # Native XDP of veth needs GRO on the peer
+    ethtool -K $TX_IF gro on > /dev/null
+    ip netns exec $RX_NS ethtool -K $RX_IF gro on > /dev/null
+}
+
+function cleanup()
+{
+    pkill -INT -f bus_generator 2>/dev/null || true
+    ip link del $TX_IF 2>/dev/null || true
+    ip netns del $RX_NS 2>/dev/null || true
+}
+trap cleanup EXIT
+
+# $1 - name, $2 - processor's vdev, $3 - processor's options
+function run_case()
+{
+    echo "*** $1"
+
+    bin/bus_generator -l 1 --no-pci --vdev net_af_packet0,iface=$TX_IF \
+        --huge-dir=/mnt/bus_gen/ --file-prefix=bus_gen \
+        -- $GEN_OPTS > "$LOG_DIR/$1_gen.log" 2>&1 &
+    GEN_PID=$!
+    sleep 2
+
+    ping -q -i 0.01 -w $DURATION -I $TX_IF 10.99.0.2 > "$LOG_DIR/$1_ping.log" 2>&1 &
+    PING_PID=$!
+
+    ip netns exec $RX_NS timeout -s INT $DURATION bin/bus_processor -l 2 --no-pci $2 \
+        --huge-dir=/mnt/bus_proc/ --file-prefix=bus_proc \
+        -- $PROC_OPTS $3 > "$LOG_DIR/$1_proc.log" 2>&1 || true
+
+    kill -INT $GEN_PID 2>/dev/null || true
+    wait $GEN_PID 2>/dev/null || true
+    wait $PING_PID 2>/dev/null || true
+
+    grep -A3 "Cycles/pkt" "$LOG_DIR/$1_proc.log" | tail -n 2 || true
+    grep "packet loss" "$LOG_DIR/$1_ping.log" || true
+    echo
+}
+
+mkdir -p $LOG_DIR
+setup_veth
+
+run_case af_packet "--vdev net_af_packet1,iface=$RX_IF" ""
+run_case af_xdp_all "--vdev net_af_xdp1,iface=$RX_IF,start_queue=0,queue_count=1" ""
+run_case af_xdp_pbus "" "--xdp $RX_IF --xdp-queue 0"
+
+echo "Logs: $LOG_DIR/"
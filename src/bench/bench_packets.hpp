@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bus_generator/goose_traffic_gen.hpp"
+#include "bus_generator/sv_traffic_gen.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Test frames for benchmarks, made by the generator's skeletons
+ *
+ * libiec61850 always puts 802.1Q tag, so the 'no VLAN' case is made by
+ * removing 4 bytes of the tag.
+ */
+namespace BenchPackets
+{
+    inline void strip_vlan(std::vector< uint8_t > &packet)
+    {
+        if (packet.size() > 16 && packet[12] == 0x81 && packet[13] == 0x00) {
+            packet.erase(packet.begin() + 12, packet.begin() + 16);
+        }
+    }
+
+    inline std::vector< uint8_t > make_goose(unsigned numEntries, bool vlan)
+    {
+        GooseTrafficGen gen(1, 1, numEntries);
+
+        std::vector< uint8_t > packet(gen.GetSkeletonBuffer(),
+                                      gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+        if (!vlan) {
+            strip_vlan(packet);
+        }
+        return packet;
+    }
+
+    inline std::vector< uint8_t > make_sv(SV_TYPE type, bool vlan)
+    {
+        SVTrafficGen gen(1, type);
+
+        std::vector< uint8_t > packet(gen.GetSkeletonBuffer(),
+                                      gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+        if (!vlan) {
+            strip_vlan(packet);
+        }
+        return packet;
+    }
+}
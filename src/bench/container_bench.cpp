@@ -0,0 +1,115 @@
+#include "common/goose_container.hpp"
+#include "common/sv_container.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const unsigned KEY_NUM = 4096;
+
+    /**
+     * @brief {streams, hit %}
+     */
+    void find_args(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"streams", "hit"})
+         ->ArgsProduct({{10, 100, 1000, 10000}, {0, 50, 90, 100}});
+    }
+
+    /**
+     * @brief A miss is a known APPID with another GOID/SVID: the unknown
+     * publisher case, which has to compare the whole passport.
+     */
+    std::vector< unsigned > make_lookup_order(unsigned streams, unsigned hitPerc)
+    {
+        std::mt19937 rnd(12345);
+        std::uniform_int_distribution< unsigned > idxDist(0, streams - 1), percDist(0, 99);
+
+        std::vector< unsigned > order(KEY_NUM);
+        for (auto &o : order) {
+            unsigned idx = idxDist(rnd);
+            // Odd value is a miss
+            o = (percDist(rnd) < hitPerc) ? (idx * 2) : (idx * 2 + 1);
+        }
+        return order;
+    }
+}
+
+static void BM_GooseContainerFind(benchmark::State &state)
+{
+    const unsigned streams = state.range(0), hitPerc = state.range(1);
+
+    GooseContainer map;
+    std::vector< GooseSource::ptr > sources;
+    std::vector< std::string > missGOID(streams);
+    std::vector< GoosePassport > keys(streams * 2);
+    for (unsigned i=0;i<streams;++i) {
+        GooseSource::ptr src = std::make_shared< GooseSource >();
+        src->SetMAC(MAC("01:0C:CD:04:00:01"))
+            .SetAppID(0x0001 + i)
+            .SetGOID(std::format("GOID{:08}", i + 1))
+            .SetDataSetRef(std::format("IED{:08}LDName/LLN0$DataSet", i + 1))
+            .SetGOCBRef(std::format("IED{:08}LDName/LLN0$GO$GOCB", i + 1))
+            .SetCRev(1)
+            .SetNumEntries(16);
+        map[src->GetPassport()] = src;
+        sources.push_back(src);
+
+        missGOID[i] = std::format("GOID{:08}", i + 1 + streams);
+        keys[i * 2] = src->GetPassport();
+        keys[i * 2 + 1] = src->GetPassport();
+        keys[i * 2 + 1].goid = missGOID[i];
+    }
+    std::vector< unsigned > order = make_lookup_order(streams, hitPerc);
+
+    unsigned idx = 0, found = 0;
+    for (auto _ : state) {
+        auto it = map.find(keys[order[idx]]);
+        found += (it != map.end());
+        idx = (idx + 1) % KEY_NUM;
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GooseContainerFind)->Apply(find_args);
+
+static void BM_SVContainerFind(benchmark::State &state)
+{
+    const unsigned streams = state.range(0), hitPerc = state.range(1);
+
+    SVContainer map;
+    std::vector< SVStreamSource::ptr > sources;
+    std::vector< std::string > missSVID(streams);
+    std::vector< SVStreamPassport > keys(streams * 2);
+    for (unsigned i=0;i<streams;++i) {
+        SVStreamSource::ptr src = std::make_shared< SVStreamSource >();
+        src->SetMAC(MAC("01:0C:CD:01:00:01"))
+            .SetAppID(0x0001 + i)
+            .SetSVID(std::format("SVID{:04}", i + 1))
+            .SetCRev(1)
+            .SetNumASDU(1);
+        map[src->GetPassport()] = src;
+        sources.push_back(src);
+
+        missSVID[i] = std::format("SVID{:04}", i + 1 + streams);
+        keys[i * 2] = src->GetPassport();
+        keys[i * 2 + 1] = src->GetPassport();
+        keys[i * 2 + 1].svid = missSVID[i];
+    }
+    std::vector< unsigned > order = make_lookup_order(streams, hitPerc);
+
+    unsigned idx = 0, found = 0;
+    for (auto _ : state) {
+        auto it = map.find(keys[order[idx]]);
+        found += (it != map.end());
+        idx = (idx + 1) % KEY_NUM;
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SVContainerFind)->Apply(find_args);
@@ -0,0 +1,115 @@
+#include "bus_generator/goose_traffic_gen.hpp"
+#include "bus_generator/sv_traffic_gen.hpp"
+#include "bus_generator/timing_wheel.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+/**
+ * @brief Amend the whole TX second of the generator, one packet per iteration
+ */
+template< typename GenClass, typename TAmend >
+static void amend_tx_units(benchmark::State &state, GenClass &gen, TAmend amend)
+{
+    std::vector< uint8_t > packet(gen.GetSkeletonBuffer(),
+                                  gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+
+    std::vector< typename GenClass::Desc > descs;
+    for (const auto &blk : gen.GetTxUnits().front().blocks) {
+        descs.insert(descs.end(), blk.packets.begin(), blk.packets.end());
+    }
+
+    size_t idx = 0, size = 0;
+    for (auto _ : state) {
+        size = amend(packet.data(), descs[idx]);
+        benchmark::ClobberMemory();
+        idx = (idx + 1 < descs.size()) ? (idx + 1) : 0;
+    }
+    benchmark::DoNotOptimize(size);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_GooseAmendPacket(benchmark::State &state)
+{
+    GooseTrafficGen gen(state.range(0), 1, state.range(1));
+    amend_tx_units(state, gen, [&gen](uint8_t *packet, const GooseTrafficGen::Desc &desc) {
+        return gen.AmendPacket(packet, desc);
+    });
+}
+BENCHMARK(BM_GooseAmendPacket)
+    ->ArgNames({"streams", "entries"})
+    ->ArgsProduct({{10, 100, 1000, 10000}, {16, 128}});
+
+static void BM_SV80AmendPacket(benchmark::State &state)
+{
+    SVTrafficGen gen(state.range(0), SV_TYPE::SV80);
+    amend_tx_units(state, gen, [&gen](uint8_t *packet, const SVTrafficGen::Desc &desc) {
+        return gen.AmendPacketSV80(packet, desc);
+    });
+}
+BENCHMARK(BM_SV80AmendPacket)->ArgName("streams")->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_SV256AmendPacket(benchmark::State &state)
+{
+    SVTrafficGen gen(state.range(0), SV_TYPE::SV256);
+    amend_tx_units(state, gen, [&gen](uint8_t *packet, const SVTrafficGen::Desc &desc) {
+        return gen.AmendPacketSV256(packet, desc);
+    });
+}
+BENCHMARK(BM_SV256AmendPacket)->ArgName("streams")->RangeMultiplier(10)->Range(10, 10000);
+
+/**
+ * @brief Prebuilt per-IED mbufs: only the counters are written
+ */
+static void BM_GooseAmendCounters(benchmark::State &state)
+{
+    GooseTrafficGen gen(state.range(0), 1, state.range(1));
+    amend_tx_units(state, gen, [&gen](uint8_t *packet, const GooseTrafficGen::Desc &desc) {
+        return gen.AmendCounters(packet, desc);
+    });
+}
+BENCHMARK(BM_GooseAmendCounters)
+    ->ArgNames({"streams", "entries"})
+    ->ArgsProduct({{10, 100, 1000, 10000}, {16, 128}});
+
+static void BM_SV256AmendCounters(benchmark::State &state)
+{
+    SVTrafficGen gen(state.range(0), SV_TYPE::SV256);
+    amend_tx_units(state, gen, [&gen](uint8_t *packet, const SVTrafficGen::Desc &desc) {
+        return gen.AmendCountersSV256(packet, desc);
+    });
+}
+BENCHMARK(BM_SV256AmendCounters)->ArgName("streams")->RangeMultiplier(10)->Range(10, 10000);
+
+/**
+ * @brief GOOSE event mode: heartbeats of all publishers and the retransmission
+ * curve of changed ones, one wheel tick per iteration
+ */
+static void BM_GooseTimingWheel(benchmark::State &state)
+{
+    const uint64_t T0 = 4, HEARTBEAT = 2000; // 500 us ticks: 2 ms and 1 s
+    const size_t iedNum = state.range(0);
+
+    TimingWheel<> wheel(iedNum);
+    std::vector< uint64_t > interval(iedNum, HEARTBEAT);
+    for (size_t i=0;i<iedNum;++i) {
+        wheel.Schedule(i, 1 + i * HEARTBEAT / iedNum);
+    }
+
+    size_t expired = 0, nextIED = 0;
+    for (auto _ : state) {
+        // A change per tick
+        interval[nextIED] = T0;
+        wheel.Schedule(nextIED, 1);
+        nextIED = (nextIED + 1 < iedNum) ? (nextIED + 1) : 0;
+
+        wheel.Advance([&](uint32_t id) {
+            wheel.Schedule(id, interval[id]);
+            interval[id] = std::min(interval[id] * 2, HEARTBEAT);
+            ++expired;
+        });
+    }
+    benchmark::DoNotOptimize(expired);
+    state.SetItemsProcessed(expired);
+}
+BENCHMARK(BM_GooseTimingWheel)->ArgName("publishers")->RangeMultiplier(10)->Range(100, 100000);
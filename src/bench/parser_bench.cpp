@@ -0,0 +1,117 @@
+#include "bench_packets.hpp"
+#include "bus_processor/process_bus_parser.hpp"
+
+// Baseline: GOOSE parsing by libiec61850
+#include "goose_receiver.h"
+#include "goose_subscriber.h"
+
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * @brief GOOSE frame for each {VLAN, NumEntries}
+     */
+    void goose_args(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"vlan", "entries"})
+         ->ArgsProduct({{0, 1}, {4, 16, 64, 128}});
+    }
+
+    /**
+     * @brief SV frame for each {VLAN, SV80/SV256}
+     */
+    void sv_args(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"vlan", "sv256"})
+         ->ArgsProduct({{0, 1}, {0, 1}});
+    }
+}
+
+static void BM_GetProtoType(benchmark::State &state)
+{
+    const bool vlan = state.range(0) != 0;
+    std::vector< uint8_t > packets[2] = {
+        BenchPackets::make_goose(16, vlan),
+        BenchPackets::make_sv(SV_TYPE::SV80, vlan)
+    };
+
+    unsigned idx = 0;
+    for (auto _ : state) {
+        unsigned appid = 0;
+        BUS_PROTO type = ProcessBusParser::get_proto_type(packets[idx].data(), packets[idx].size(), &appid);
+        benchmark::DoNotOptimize(type);
+        benchmark::DoNotOptimize(appid);
+        idx ^= 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetProtoType)->ArgName("vlan")->Arg(0)->Arg(1);
+
+static void BM_ParseGoosePacket(benchmark::State &state)
+{
+    std::vector< uint8_t > packet = BenchPackets::make_goose(state.range(1), state.range(0) != 0);
+
+    for (auto _ : state) {
+        GoosePassport pass;
+        GooseState st;
+        int retval = ProcessBusParser::parse_goose_packet(packet.data(), packet.size(), pass, st);
+        benchmark::DoNotOptimize(retval);
+        benchmark::DoNotOptimize(pass);
+        benchmark::DoNotOptimize(st);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_ParseGoosePacket)->Apply(goose_args);
+
+static void BM_ParseSVPacket(benchmark::State &state)
+{
+    SV_TYPE type = (state.range(1) != 0) ? SV_TYPE::SV256 : SV_TYPE::SV80;
+    std::vector< uint8_t > packet = BenchPackets::make_sv(type, state.range(0) != 0);
+
+    for (auto _ : state) {
+        SVStreamPassport pass;
+        SVStreamState st;
+        int retval = ProcessBusParser::parse_sv_packet(packet.data(), packet.size(), pass, st);
+        benchmark::DoNotOptimize(retval);
+        benchmark::DoNotOptimize(pass);
+        benchmark::DoNotOptimize(st);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_ParseSVPacket)->Apply(sv_args);
+
+/**
+ * @brief Baseline: the same GOOSE frames through GooseReceiver_handleMessage
+ */
+static void BM_LibGooseReceiver(benchmark::State &state)
+{
+    std::vector< uint8_t > packet = BenchPackets::make_goose(state.range(1), state.range(0) != 0);
+
+    // Observer subscriber receives every GOOSE
+    char port[8] = "";
+    GooseSubscriber subscriber = GooseSubscriber_create(port, NULL);
+    if (subscriber == NULL) {
+        throw std::runtime_error("Can't create GooseSubscriber from libiec61850!");
+    }
+    GooseSubscriber_setObserver(subscriber);
+
+    GooseReceiver receiver = GooseReceiver_create();
+    if (receiver == NULL) {
+        throw std::runtime_error("Can't create GooseReceiver from libiec61850!");
+    }
+    GooseReceiver_addSubscriber(receiver, subscriber);
+
+    for (auto _ : state) {
+        GooseReceiver_handleMessage(receiver, packet.data(), packet.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * packet.size());
+
+    // Subscribers are destroyed by the receiver
+    GooseReceiver_destroy(receiver);
+}
+BENCHMARK(BM_LibGooseReceiver)->Apply(goose_args);
@@ -0,0 +1,198 @@
+#include "comtrade.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static std::vector< std::string > split_fields(const std::string &line)
+{
+    std::vector< std::string > fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        // Trim spaces and CR of DOS files
+        size_t first = field.find_first_not_of(" \t\r");
+        size_t last = field.find_last_not_of(" \t\r");
+        fields.push_back((first == std::string::npos) ? "" : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+static std::vector< std::string > read_fields(std::istream &in, size_t minNum, const char *what)
+{
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error(std::string("COMTRADE cfg: unexpected end at ") + what);
+    }
+    auto fields = split_fields(line);
+    if (fields.size() < minNum) {
+        throw std::runtime_error(std::string("COMTRADE cfg: invalid ") + what + ": " + line);
+    }
+    return fields;
+}
+
+static double to_double(const std::string &str, double def = 0.0)
+{
+    return str.empty() ? def : std::stod(str);
+}
+
+ComtradeRecord ComtradeRecord::Load(const std::string &cfgPath)
+{
+    std::ifstream cfg(cfgPath);
+    if (!cfg) {
+        throw std::runtime_error("Can't open COMTRADE cfg: " + cfgPath);
+    }
+
+    std::string datPath = cfgPath.substr(0, cfgPath.find_last_of('.'));
+    datPath += (cfgPath.back() == 'G') ? ".DAT" : ".dat";
+    std::ifstream dat(datPath, std::ios::binary);
+    if (!dat) {
+        throw std::runtime_error("Can't open COMTRADE dat: " + datPath);
+    }
+
+    return Parse(cfg, dat);
+}
+
+ComtradeRecord ComtradeRecord::Parse(std::istream &cfg, std::istream &dat)
+{
+    ComtradeRecord rec;
+    rec.ParseConfig(cfg);
+    if (rec.m_binary) {
+        rec.ParseBinaryData(dat);
+    } else {
+        rec.ParseAsciiData(dat);
+    }
+    if (rec.m_timesUS.empty()) {
+        throw std::runtime_error("COMTRADE dat has no samples");
+    }
+    return rec;
+}
+
+void ComtradeRecord::ParseConfig(std::istream &cfg)
+{
+    read_fields(cfg, 2, "station line");
+
+    // TT,##A,##D
+    auto counts = read_fields(cfg, 3, "channel counts");
+    unsigned analogNum = std::stoul(counts[1]);
+    m_digitalNum = std::stoul(counts[2]);
+
+    for (unsigned i=0;i<analogNum;++i) {
+        // An,ch_id,ph,ccbm,uu,a,b,skew,min,max[,primary,secondary,PS]
+        auto f = read_fields(cfg, 10, "analog channel");
+
+        ComtradeChannel ch;
+        ch.id = f[1];
+        ch.phase = f[2];
+        ch.unit = f[4];
+        ch.a = to_double(f[5], 1.0);
+        ch.b = to_double(f[6]);
+        if (f.size() >= 13) {
+            ch.primary = to_double(f[10], 1.0);
+            ch.secondary = to_double(f[11], 1.0);
+            ch.ps = f[12].empty() ? 'P' : (char)toupper(f[12][0]);
+        }
+        m_channels.push_back(ch);
+    }
+    for (unsigned i=0;i<m_digitalNum;++i) {
+        read_fields(cfg, 1, "digital channel");
+    }
+
+    m_lineFreq = to_double(read_fields(cfg, 1, "line frequency")[0], 50.0);
+
+    unsigned rateNum = std::stoul(read_fields(cfg, 1, "sample rate number")[0]);
+    for (unsigned i=0;i<std::max(rateNum, 1U);++i) {
+        auto f = read_fields(cfg, 2, "sample rate");
+        double rate = to_double(f[0]);
+        if (rate > 0.0) {
+            m_rates.emplace_back(rate, std::stoul(f[1]));
+        }
+    }
+
+    read_fields(cfg, 1, "start time");
+    read_fields(cfg, 1, "trigger time");
+
+    std::string type = read_fields(cfg, 1, "file type")[0];
+    std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+    if (type == "BINARY") {
+        m_binary = true;
+    } else if (type != "ASCII") {
+        throw std::runtime_error("COMTRADE dat type isn't supported: " + type);
+    }
+
+    // 1999: timemult is optional
+    std::string line;
+    if (std::getline(cfg, line)) {
+        auto f = split_fields(line);
+        if (!f.empty() && !f[0].empty()) {
+            m_timeMult = to_double(f[0], 1.0);
+        }
+    }
+
+    m_values.resize(m_channels.size());
+}
+
+void ComtradeRecord::AddSample(uint32_t num, double timeUS)
+{
+    // Sample rates of cfg are preferred over timestamps of dat
+    if (!m_rates.empty()) {
+        double t = 0.0;
+        uint32_t prevLast = 0;
+        for (const auto &[rate, last] : m_rates) {
+            uint32_t n = std::min(num, last);
+            if (n > prevLast) {
+                t += (n - prevLast) * 1e6 / rate;
+            }
+            prevLast = last;
+            if (num <= last) {
+                break;
+            }
+        }
+        // The first sample is at 0
+        timeUS = t - 1e6 / m_rates.front().first;
+    } else {
+        timeUS *= m_timeMult;
+    }
+    m_timesUS.push_back(timeUS);
+}
+
+void ComtradeRecord::ParseAsciiData(std::istream &dat)
+{
+    std::string line;
+    while (std::getline(dat, line)) {
+        auto f = split_fields(line);
+        if (f.size() < 2 + m_channels.size()) {
+            continue; // Empty lines at the end
+        }
+
+        AddSample(std::stoul(f[0]), to_double(f[1]));
+        for (size_t i=0;i<m_channels.size();++i) {
+            double x = to_double(f[2 + i]);
+            x = (x == 99999.0) ? 0.0 : x; // Missing value
+            m_values[i].push_back(m_channels[i].a * x + m_channels[i].b);
+        }
+    }
+}
+
+void ComtradeRecord::ParseBinaryData(std::istream &dat)
+{
+    // n, timestamp, int16 per analog channel, uint16 per 16 digital ones: little-endian
+    const size_t recSize = 4 + 4 + 2 * m_channels.size() + 2 * ((m_digitalNum + 15) / 16);
+    std::vector< uint8_t > rec(recSize);
+    auto le16 = [&rec](size_t off) { return (int16_t)(rec[off] | (rec[off + 1] << 8)); };
+    auto le32 = [&rec](size_t off) {
+        return (uint32_t)rec[off] | ((uint32_t)rec[off + 1] << 8) |
+               ((uint32_t)rec[off + 2] << 16) | ((uint32_t)rec[off + 3] << 24);
+    };
+
+    while (dat.read((char *)rec.data(), recSize)) {
+        AddSample(le32(0), le32(4));
+        for (size_t i=0;i<m_channels.size();++i) {
+            int16_t x = le16(8 + 2 * i);
+            x = (x == (int16_t)0x8000) ? 0 : x; // Missing value
+            m_values[i].push_back(m_channels[i].a * x + m_channels[i].b);
+        }
+    }
+}
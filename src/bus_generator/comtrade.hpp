@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Analog channel of COMTRADE: value = a * x + b
+ */
+struct ComtradeChannel
+{
+    std::string id;
+    std::string phase;
+    std::string unit;
+    double      a = 1.0,
+                b = 0.0;
+    double      primary = 1.0,
+                secondary = 1.0;
+    char        ps = 'P'; // Values are primary(P) or secondary(S)
+};
+
+/**
+ * @class ComtradeRecord
+ * @brief IEEE C37.111 record(1991/1999): .cfg and ASCII or BINARY .dat.
+ * Only analog channels are kept, digital ones are skipped.
+ */
+class ComtradeRecord
+{
+public:
+    /**
+     * @brief Load the record, the .dat file is next to the .cfg
+     */
+    static ComtradeRecord Load(const std::string &cfgPath);
+    static ComtradeRecord Parse(std::istream &cfg, std::istream &dat);
+
+    const std::vector< ComtradeChannel >& GetChannels() const { return m_channels; }
+    double  GetLineFreq() const { return m_lineFreq; }
+
+    size_t  GetSampleNum() const { return m_timesUS.size(); }
+    double  GetTimeUS(size_t idx) const { return m_timesUS[idx]; }
+    /**
+     * @brief Scaled value: a * x + b in channel's units
+     */
+    double  GetValue(size_t channel, size_t idx) const { return m_values[channel][idx]; }
+
+private:
+    void ParseConfig(std::istream &cfg);
+    void ParseAsciiData(std::istream &dat);
+    void ParseBinaryData(std::istream &dat);
+    void AddSample(uint32_t num, double timeUS);
+
+private:
+    std::vector< ComtradeChannel >          m_channels;
+    unsigned                                m_digitalNum = 0;
+    double                                  m_lineFreq = 50.0;
+    double                                  m_timeMult = 1.0;
+    bool                                    m_binary = false;
+
+    // Sample rates: {rate, last sample}, timestamps of .dat are used if empty
+    std::vector< std::pair< double, uint32_t > > m_rates;
+
+    std::vector< double >                   m_timesUS;
+    std::vector< std::vector< double > >    m_values; // [channel][sample]
+};
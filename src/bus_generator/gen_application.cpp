@@ -7,13 +7,21 @@
 #include "dpdk_cpp/dpdk_poolsetter_class.hpp"
 #include "dpdk_cpp/dpdk_mempool_class.hpp"
 #include "dpdk_cpp/dpdk_info_class.hpp"
+#include "dpdk_cpp/dpdk_nicclock_class.hpp"
 
 #include "goose_traffic_gen.hpp"
+#include "goose_event_source.hpp"
 #include "sv_traffic_gen.hpp"
+#include "sv_waveform.hpp"
+#include "comtrade.hpp"
+#include "tx_source.hpp"
 
 #include "cxxopts.hpp"
 
-const unsigned BURST_SIZE = 32;
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <queue>
 
 template< typename TxUnitArray >
 static void display_tx_units_info(TxUnitArray &txUnits)
@@ -43,82 +51,220 @@ static void display_tx_units_info(TxUnitArray &txUnits)
 
 struct TxCycleConfig
 {
-    rte_mempool* pool = nullptr;
     uint16_t     nicPortID = 0;
     uint16_t     nicQueueID = 0;
+    uint64_t     startTick = 0; // The first PPS, is shared by all TX lcores
+    unsigned     pacingPerc = 0; // Part of the unit's interval to spread packets, 0 is a burst
+
+    // SEND_ON_TIMESTAMP, isn't used if tsOffset < 0
+    DPDK::NicClock* nicClock = nullptr;
+    bool         ownsNicClock = false;  // The lcore recalibrates the NIC clock
+    int          tsOffset = -1;
+    uint64_t     tsFlag = 0;
 };
 
-template<
-    typename GenClass,
-    size_t (GenClass::*Amend)(uint8_t *packet, const typename GenClass::Desc &desc)
-        = &GenClass::AmendPacket
->
-static void tx_packets_cycle(TxCycleConfig &conf, GenAppStat &stat, GenClass &gen, StopVarType &doWork)
+/**
+ * @brief Ticks between the unit and the next one, the last unit ends with the second
+ */
+static inline uint64_t tx_unit_interval(const TxSource &src, size_t idx)
+{
+    uint64_t end = (idx + 1 < src.GetUnitNum()) ? src.GetUnitOffsetTicks(idx + 1)
+                                                : DPDK::Clocks::get_ticks_per_sec();
+    return end - src.GetUnitOffsetTicks(idx);
+}
+
+/**
+ * @brief TX timeline of several sources: TxUnits of all sources are merged
+ * by a min-heap keyed by the TX tick, so one lcore emits interleaved traffic.
+ */
+static void tx_timeline_cycle(TxCycleConfig &conf, GenAppStat &stat,
+                              std::vector< TxSource::ptr > &sources, StopVarType &doWork)
 {
-    typename GenClass::TxUnitArray &txUnits = gen.GetTxUnits();
-    if (txUnits.empty()) {
-        throw std::runtime_error("TX unit array is empty! Nothing to send!");
+    if (sources.empty()) {
+        throw std::runtime_error("TX sources are empty! Nothing to send!");
     }
-    /* display_tx_units_info< typename GenClass::TxUnitArray >(txUnits); */
 
-    std::cout << "\n\tStart main loop\n";
+    struct TxMoment
+    {
+        uint64_t tick = 0;
+        unsigned srcIdx = 0;
+        bool     paced = false;  // Packets of the source's pacer, not a new unit
+
+        bool operator>(const TxMoment &other) const { return tick > other.tick; }
+    };
+    struct SourceCursor
+    {
+        size_t   unitIdx = 0;
+        uint64_t secStartTick = 0;
+        uint64_t pacerTick = UINT64_MAX;   // The moment of the pacer in the timeline
+    };
+
     /* set_thread_priority(DEF_GENERATOR_PRIORITY); */
 
+    // Wait for the first PPS, its phase is shared with other TX lcores
+    uint64_t now = DPDK::Clocks::delay_until_ticks(conf.startTick);
+    uint64_t startTick = (conf.startTick != 0) ? conf.startTick : now;
+
+    std::vector< SourceCursor > cursors(sources.size());
+    std::priority_queue< TxMoment, std::vector< TxMoment >, std::greater< TxMoment > > timeline;
+    for (unsigned i=0;i<sources.size();++i) {
+        cursors[i].secStartTick = startTick;
+        timeline.push({startTick + sources[i]->GetUnitOffsetTicks(0), i});
+    }
+
+    TxContext ctx;
+    ctx.portID = conf.nicPortID;
+    ctx.queueID = conf.nicQueueID;
+    ctx.nicClock = conf.nicClock;
+    ctx.tsOffset = conf.tsOffset;
+    ctx.tsFlag = conf.tsFlag;
+
     // Main cycle
-    unsigned txUnitIdx = 0;
-    rte_mbuf* mbufs[BURST_SIZE] = { 0 };
     stat.procStat.MarkStartCycling();
-    uint64_t secStartTick = DPDK::Clocks::get_current_ticks();
     while (doWork) {
-        stat.procStat.MarkProcBegin();
-        for (const auto &blk : txUnits[txUnitIdx].blocks) {
-            unsigned count = blk.packets.size(), sendNum = 0;
-            while (sendNum < count) {
-                unsigned num = ((count - sendNum) >= BURST_SIZE) ? BURST_SIZE
-                                                                 : (count - sendNum);
-                if (rte_pktmbuf_alloc_bulk(conf.pool, mbufs, num) == 0) {
-                    for (size_t i=0;i<num;++i) {
-                        uint8_t *packet = rte_pktmbuf_mtod(mbufs[i], uint8_t *);
-
-                        mbufs[i]->pkt_len = (gen.*Amend)(packet, blk.packets[sendNum + i]);
-                        mbufs[i]->data_len = mbufs[i]->pkt_len;
-                    }
-
-                    uint16_t nb_tx = rte_eth_tx_burst(conf.nicPortID, conf.nicQueueID, mbufs, num);
-                    if (nb_tx < num) {
-                        for (uint16_t i=nb_tx;i<num;i++) {
-                            rte_pktmbuf_free(mbufs[i]);
-                        }
-                        stat.errSendCnt += num - nb_tx;
-                    }
-                } else {
-                    rte_eth_tx_done_cleanup(conf.nicPortID, conf.nicQueueID, 0);
-                    continue;
-                }
+        TxMoment next = timeline.top();
+        timeline.pop();
+
+        // Wait until the timestamp of sending next Unit
+        now = DPDK::Clocks::delay_until_ticks(next.tick);
+
+        TxSource &src = *sources[next.srcIdx];
+        SourceCursor &cur = cursors[next.srcIdx];
 
-                sendNum += num;
+        // Paced packets of the source which are due, an earlier moment replaced this one
+        if (next.paced) {
+            if (next.tick != cur.pacerTick) {
+                continue;
             }
+            TxPacer &pacer = src.GetPacer();
+            stat.procStat.MarkProcBegin();
+            pacer.Send(ctx.portID, ctx.queueID, now, stat.errSendCnt);
+            stat.procStat.MarkProcEnd();
+            cur.pacerTick = pacer.IsEmpty() ? UINT64_MAX : pacer.GetNextTick();
+            if (!pacer.IsEmpty()) {
+                timeline.push({cur.pacerTick, next.srcIdx, true});
+            }
+            continue;
         }
-        stat.procStat.MarkProcEnd();
 
-        txUnitIdx = (txUnitIdx + 1) % txUnits.size();
-        if (txUnitIdx == 0) {
-            // New PPS(new second pulse)
-            secStartTick = DPDK::Clocks::delay_until_ticks(
-                               secStartTick + DPDK::Clocks::get_ticks_per_sec()
-                           );
-        } else {
-            // Wait until the timestamp of sending next Unit
-            DPDK::Clocks::delay_until_ticks(
-                secStartTick + DPDK::Clocks::delay_us_to_ticks(txUnits[txUnitIdx].offsetUS)
-            );
+        if (stat.jitter) {
+            // Late start: a stall of the lcore or the previous unit was too long
+            stat.jitter->Record(now - next.tick, now);
+        }
+
+        ctx.unitTick = next.tick;
+        ctx.gapTicks = 0;
+        ctx.pacer = &src.GetPacer();
+        if (conf.pacingPerc > 0) {
+            size_t pktNum = src.GetUnitPacketNum(cur.unitIdx);
+            if (pktNum > 0) {
+                ctx.gapTicks = tx_unit_interval(src, cur.unitIdx) * conf.pacingPerc / 100 / pktNum;
+            }
+        }
+
+        stat.procStat.MarkProcBegin();
+        src.SendUnit(cur.unitIdx, ctx, stat);
+        const uint64_t procTicks = stat.procStat.MarkProcEnd();
+        if (stat.jitter) {
+            stat.jitter->RecordWork(procTicks);
         }
+
+        if (conf.ownsNicClock) {
+            // NIC and CPU clocks drift apart, the mapping is re-anchored once per second
+            conf.nicClock->RecalibrateIfDue(now);
+        }
+
+        if (!ctx.pacer->IsEmpty() && ctx.pacer->GetNextTick() < cur.pacerTick) {
+            cur.pacerTick = ctx.pacer->GetNextTick();
+            timeline.push({cur.pacerTick, next.srcIdx, true});
+        }
+
+        cur.unitIdx = (cur.unitIdx + 1) % src.GetUnitNum();
+        if (cur.unitIdx == 0) {
+            // New PPS(new second pulse), is kept on the grid of the start tick
+            cur.secStartTick += DPDK::Clocks::get_ticks_per_sec();
+        }
+        timeline.push({cur.secStartTick + src.GetUnitOffsetTicks(cur.unitIdx), next.srcIdx});
     }
     stat.procStat.MarkFinishCycling();
 
     /* DPDK::Info::display_eth_stats(nicPortID); */
 }
 
+struct TxLCoreTask
+{
+    std::vector< TxSource::ptr > sources;
+    TxCycleConfig   conf;
+    GenAppStat*     stat = nullptr;
+    StopVarType*    doWork = nullptr;
+};
+
+static int tx_lcore(void *arg)
+{
+    TxLCoreTask *task = reinterpret_cast< TxLCoreTask* >(arg);
+    try {
+        tx_timeline_cycle(task->conf, *task->stat, task->sources, *task->doWork);
+    } catch (const std::exception &exp) {
+        std::cerr << "LCore " << rte_lcore_id() << ": " << exp.what() << std::endl;
+        *task->doWork = false;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Source of the generator: each packet is a new mbuf or prebuilt mbufs of IEDs
+ * @param prebuiltDepth Prebuilt mbufs per IED, 0: each packet is a new mbuf
+ */
+template<
+    typename GenClass,
+    size_t (GenClass::*Amend)(uint8_t *packet, const typename GenClass::Desc &desc),
+    void (GenClass::*Stamp)(uint8_t *packet, unsigned idx),
+    size_t (GenClass::*Counters)(uint8_t *packet, const typename GenClass::Desc &desc)
+>
+static auto gen_source_maker(rte_mempool *pool, const char *name, unsigned prebuiltDepth)
+{
+    return [=](std::unique_ptr< GenClass > gen) -> TxSource::ptr {
+        if (prebuiltDepth > 0) {
+            return std::make_unique< TxPrebuiltSource< GenClass, Stamp, Counters > >(std::move(gen), pool,
+                                                                                    name, prebuiltDepth);
+        }
+        return std::make_unique< TxGenSource< GenClass, Amend > >(std::move(gen), pool, name);
+    };
+}
+
+/**
+ * @brief Split IEDs of the traffic among TX lcores: each lcore gets its own
+ * generator for a range of IEDs. The pool is filled by the traffic's skeleton.
+ *
+ * @param makeGen Creates a generator for IEDs [first, first + num)
+ * @param makeSource Wraps the generator into a TX source
+ * @param prpStream PRP: the stream's byte of source MACs, 0 - no duplicates
+ */
+template< typename TMakeGen, typename TMakeSource >
+static void add_sharded_traffic(std::vector< TxLCoreTask > &tasks, rte_mempool *pool,
+                                unsigned iedNum, TMakeGen makeGen, TMakeSource makeSource,
+                                uint8_t prpStream)
+{
+    const unsigned shardNum = std::min< unsigned >(tasks.size(), iedNum);
+    for (unsigned s=0;s<shardNum;++s) {
+        unsigned first = (uint64_t)iedNum * s / shardNum;
+        unsigned last = (uint64_t)iedNum * (s + 1) / shardNum;
+
+        auto gen = makeGen(first, last - first);
+        if (s == 0) {
+            // Skeleton is the same for all shards
+            DPDK::PoolSetter(gen->GetSkeletonBuffer(), gen->GetSkeletonSize())
+                            .FillPackets(pool);
+        }
+
+        TxSource::ptr source = makeSource(std::move(gen));
+        if (prpStream != 0) {
+            source->EnablePrp(prpStream, first, last - first, pool);
+        }
+        tasks[s].sources.push_back(std::move(source));
+    }
+}
 
 GenApplication::GenApplication(int argc, char *argv[])
 {
@@ -128,8 +274,31 @@ GenApplication::GenApplication(int argc, char *argv[])
         options.add_options()
             ("h,help", "Print usage")
             ("goose", "The number of unique GOOSE to generate and the frequency", cxxopts::value<std::vector<int>>())
+            ("goose-events", "GOOSE: event mode, state changes per second of all IEDs", cxxopts::value<double>())
+            ("goose-avalanche", "GOOSE: event mode, all IEDs change the state each N sec", cxxopts::value<int>())
+            ("goose-t0", "GOOSE: event mode, the first retransmission after a change in ms", cxxopts::value<int>())
+            ("goose-tal", "GOOSE: timeAllowedToLive in ms, the heartbeat of event mode is TAL/2", cxxopts::value<int>())
             ("sv80", "The number of unique SV with 80 points", cxxopts::value<int>())
-            ("sv256", "The number of unique SV with 256 points", cxxopts::value<int>());
+            ("sv256", "The number of unique SV with 256 points", cxxopts::value<int>())
+            ("pacing", "Spread packets of a TX unit over N % of its interval", cxxopts::value<int>())
+            ("tx-timestamp", "Pace packets by NIC: RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP")
+            ("prebuilt", "N prebuilt mbufs per IED are reused instead of new ones", cxxopts::value<int>())
+            ("sv-freq", "SV: the power frequency, Hz", cxxopts::value<double>())
+            ("sv-current", "SV: the phase current, A rms", cxxopts::value<double>())
+            ("sv-voltage", "SV: the phase voltage, V rms", cxxopts::value<double>())
+            ("sv-harmonics", "SV: harmonics as order,% pairs: 3,20,5,10", cxxopts::value<std::vector<double>>())
+            ("sv-fault", "SV: the fault at T ms with current and voltage multipliers: T,I,U", cxxopts::value<std::vector<double>>())
+            ("sv-fault-phases", "SV: the faulted phases, e.g. A or ABC", cxxopts::value<std::string>())
+            ("sv-dc-tau", "SV: the decaying DC of the fault current, time constant in ms", cxxopts::value<double>())
+            ("sv-duration", "SV: the waveform repeats each N sec", cxxopts::value<double>())
+            ("comtrade", "SV: samples from COMTRADE, the .dat is next to the .cfg", cxxopts::value<std::string>())
+            ("routable", "Send R-GOOSE/R-SV: IPv4/UDP multicast with IEC 61850-90-5 session header")
+            ("r-src", "R-GOOSE/R-SV: the source IPv4 address", cxxopts::value<std::string>())
+            ("r-dst", "R-GOOSE/R-SV: the multicast group", cxxopts::value<std::string>())
+            ("r-ttl", "R-GOOSE/R-SV: IPv4 TTL", cxxopts::value<int>())
+            ("r-sw-cksum", "R-GOOSE/R-SV: UDP checksum by CPU even if NIC can offload it")
+            ("prp", "PRP: each frame with RCT is sent twice, for LAN A and LAN B")
+            ("jitter", "Record TX units which started more than N us late(stalls)", cxxopts::value<int>());
 
         auto result = options.parse(argc, argv);
         if (result.count("help")) {
@@ -137,14 +306,44 @@ GenApplication::GenApplication(int argc, char *argv[])
             rte_exit(0, "");
         }
 
+        if (result.count("goose-events")) {
+            m_gooseEvent.eventsPerSec = result["goose-events"].as<double>();
+            if (m_gooseEvent.eventsPerSec < 0.0) {
+                throw std::invalid_argument("The goose-events option must not be negative");
+            }
+            m_gooseEventMode = true;
+        }
+        if (result.count("goose-avalanche")) {
+            int sec = result["goose-avalanche"].as<int>();
+            if (sec <= 0) {
+                throw std::invalid_argument("The goose-avalanche option must be positive");
+            }
+            m_gooseEvent.avalancheSec = sec;
+            m_gooseEventMode = true;
+        }
+        if (result.count("goose-t0")) {
+            int t0 = result["goose-t0"].as<int>();
+            if (t0 <= 0) {
+                throw std::invalid_argument("The goose-t0 option must be positive");
+            }
+            m_gooseEvent.t0MS = t0;
+        }
+        if (result.count("goose-tal")) {
+            int tal = result["goose-tal"].as<int>();
+            if (tal <= 0) {
+                throw std::invalid_argument("The goose-tal option must be positive");
+            }
+            m_gooseEvent.talMS = tal;
+        }
         if (result.count("goose")) {
             auto gooseOpts = result["goose"].as<std::vector<int>>();
-            if (gooseOpts.size() != 2) {
+            // The frequency isn't used by event mode
+            if (gooseOpts.size() != 2 && !(m_gooseEventMode && gooseOpts.size() == 1)) {
                 throw std::invalid_argument("The goose option is invalid, must be: N,M");
             }
 
             m_gooseNum = gooseOpts[0];
-            m_gooseSendFreq = gooseOpts[1];
+            m_gooseSendFreq = (gooseOpts.size() == 2) ? gooseOpts[1] : 1;
         }
         if (result.count("sv80")) {
             m_sv80Num = result["sv80"].as<int>();
@@ -152,6 +351,101 @@ GenApplication::GenApplication(int argc, char *argv[])
         if (result.count("sv256")) {
             m_sv256Num = result["sv256"].as<int>();
         }
+        if (result.count("pacing")) {
+            int pacing = result["pacing"].as<int>();
+            if (pacing <= 0 || pacing > 100) {
+                throw std::invalid_argument("The pacing option must be in 1..100 %");
+            }
+            m_pacingPerc = pacing;
+        }
+        if (result.count("tx-timestamp")) {
+            m_txTimestamp = true;
+        }
+        if (result.count("prebuilt")) {
+            int depth = result["prebuilt"].as<int>();
+            if (depth <= 0) {
+                throw std::invalid_argument("The prebuilt option must be positive");
+            }
+            m_prebuiltDepth = depth;
+        }
+        if (result.count("sv-freq")) {
+            m_svWave.freqHz = result["sv-freq"].as<double>();
+        }
+        if (result.count("sv-current")) {
+            m_svWave.currentA = result["sv-current"].as<double>();
+        }
+        if (result.count("sv-voltage")) {
+            m_svWave.voltageV = result["sv-voltage"].as<double>();
+        }
+        if (result.count("sv-harmonics")) {
+            auto harmonics = result["sv-harmonics"].as<std::vector<double>>();
+            if (harmonics.size() % 2 != 0) {
+                throw std::invalid_argument("The sv-harmonics option is invalid, must be: N,P[,N,P]");
+            }
+            for (size_t i=0;i<harmonics.size();i+=2) {
+                if (harmonics[i] < 2) {
+                    throw std::invalid_argument("The harmonic order must be 2 or more");
+                }
+                m_svWave.harmonics.emplace_back((unsigned)harmonics[i], harmonics[i + 1]);
+            }
+        }
+        if (result.count("sv-fault")) {
+            auto fault = result["sv-fault"].as<std::vector<double>>();
+            if (fault.empty() || fault.size() > 3 || fault[0] < 0) {
+                throw std::invalid_argument("The sv-fault option is invalid, must be: T[,I[,U]]");
+            }
+            m_svWave.faultMS = fault[0];
+            if (fault.size() > 1) {
+                m_svWave.faultCurrentMult = fault[1];
+            }
+            if (fault.size() > 2) {
+                m_svWave.faultVoltageMult = fault[2];
+            }
+        }
+        if (result.count("sv-fault-phases")) {
+            m_svWave.faultPhases = result["sv-fault-phases"].as<std::string>();
+        }
+        if (result.count("sv-dc-tau")) {
+            m_svWave.dcTauMS = result["sv-dc-tau"].as<double>();
+        }
+        if (result.count("sv-duration")) {
+            m_svWave.durationSec = result["sv-duration"].as<double>();
+        }
+        if (result.count("comtrade")) {
+            m_comtradeFile = result["comtrade"].as<std::string>();
+        }
+        if (result.count("routable")) {
+            m_routable = true;
+        }
+        if (result.count("r-src")) {
+            m_routableConf.srcIP = parse_ipv4(result["r-src"].as<std::string>());
+        }
+        if (result.count("r-dst")) {
+            m_routableConf.dstIP = parse_ipv4(result["r-dst"].as<std::string>());
+            if ((m_routableConf.dstIP >> 28) != 0xE) {
+                throw std::invalid_argument("The r-dst option must be a multicast address");
+            }
+        }
+        if (result.count("r-ttl")) {
+            int ttl = result["r-ttl"].as<int>();
+            if (ttl <= 0 || ttl > 255) {
+                throw std::invalid_argument("The r-ttl option must be in 1..255");
+            }
+            m_routableConf.ttl = ttl;
+        }
+        if (result.count("r-sw-cksum")) {
+            m_routableSwCksum = true;
+        }
+        if (result.count("prp")) {
+            m_prp = true;
+        }
+        if (result.count("jitter")) {
+            int threshold = result["jitter"].as<int>();
+            if (threshold <= 0) {
+                throw std::invalid_argument("The jitter option must be positive");
+            }
+            m_jitterUS = threshold;
+        }
     } catch (const std::exception &e) {
         std::cerr << "cxxopts: Error parsing options: " << e.what() << std::endl;
         throw;
@@ -160,9 +454,28 @@ GenApplication::GenApplication(int argc, char *argv[])
 
 void GenApplication::DisplayStatistic()
 {
-    Console::CyclicStat::PrintTableHeader({"No-mbuf"});
-    Console::CyclicStat::PrintTableRow("Main", m_stat.procStat)
-                      << std::format(" {:<10} |\n", m_stat.errSendCnt);
+    Console::CyclicStat::PrintTableHeader({"No-mbuf", "Reuse miss", "Events"});
+    for (size_t i=0;i<m_stat.size();++i) {
+        std::string label = (i == 0) ? "Main" : "LCore" + std::to_string(m_lcores[i]);
+        Console::CyclicStat::PrintTableRow(label, m_stat[i].procStat)
+                          << std::format(" {:<10} | {:<10} | {:<10} |\n", m_stat[i].errSendCnt,
+                                                                         m_stat[i].prebuiltMissCnt,
+                                                                         m_stat[i].gooseEventCnt);
+    }
+
+    if (m_jitterUS > 0) {
+        const size_t MAX_STALLS = 16;
+        std::cout << std::endl;
+        Console::JitterStat::PrintTableHeader();
+        for (size_t i=0;i<m_stat.size();++i) {
+            std::string label = (i == 0) ? "Main" : "LCore" + std::to_string(m_lcores[i]);
+            Console::JitterStat::PrintTableRow(label, *m_stat[i].jitter);
+        }
+        std::cout << std::format("\nLast TX units later than {} us:\n", m_jitterUS);
+        for (const GenAppStat &st : m_stat) {
+            Console::JitterStat::PrintStalls(*st.jitter, MAX_STALLS);
+        }
+    }
 }
 
 void GenApplication::Run(StopVarType &doWork)
@@ -173,14 +486,44 @@ void GenApplication::Run(StopVarType &doWork)
                    RX_DESC_NUM = 128,
                    TX_DESC_NUM = 63 * 1024;
 
-    // Memory pool for skeletons
-    DPDK::Mempool pool("bus_gen_pool", MBUF_NUM, CACHE_NUM);
+    // TX lcores: the main one is the first
+    m_lcores.clear();
+    m_lcores.push_back(rte_get_main_lcore());
+    unsigned lcore = 0;
+    RTE_LCORE_FOREACH_WORKER(lcore) {
+        m_lcores.push_back(lcore);
+    }
+    m_stat = std::vector< GenAppStat >(m_lcores.size());
+    if (m_jitterUS > 0) {
+        for (size_t i=0;i<m_lcores.size();++i) {
+            m_stat[i].jitter = std::make_unique< JitterDetector >(m_lcores[i], DPDK::Clocks::us_to_ticks(m_jitterUS),
+                                                                  DPDK::Clocks::us_to_ticks(1));
+        }
+    }
 
-    uint16_t nicPortID = 0, nicQueueID = 0;
+    // Memory pool per traffic type: each pool is filled by its skeleton
+    const unsigned trafficNum = (m_gooseNum > 0) + (m_sv80Num > 0) + (m_sv256Num > 0);
+    if (trafficNum == 0) {
+        std::cerr << "You have to specify GOOSE or SV to generate!\n";
+        return;
+    }
+    std::vector< std::unique_ptr< DPDK::Mempool > > pools;
+    auto make_pool = [&](const std::string &name) {
+        // Each lcore has its own cache
+        pools.push_back(std::make_unique< DPDK::Mempool >(name, MBUF_NUM / trafficNum, CACHE_NUM));
+        return pools.back()->Get();
+    };
+    rte_mempool *goosePool = (m_gooseNum > 0) ? make_pool("bus_gen_goose_pool") : nullptr;
+    rte_mempool *sv80Pool = (m_sv80Num > 0) ? make_pool("bus_gen_sv80_pool") : nullptr;
+    rte_mempool *sv256Pool = (m_sv256Num > 0) ? make_pool("bus_gen_sv256_pool") : nullptr;
+
+    uint16_t nicPortID = 0;
     DPDK::Port port = DPDK::PortBuilder(nicPortID)
-                            .SetMemPool(pool.Get())
-                            .AdjustQueues(1, 1)
+                            .SetMemPool(pools.front()->Get())
+                            .AdjustQueues(1, m_lcores.size())
                             .SetDescriptors(RX_DESC_NUM, TX_DESC_NUM)
+                            .SetTxTimestamp(m_txTimestamp)
+                            .SetTxUdpCksum(m_routable && !m_routableSwCksum)
                             .Build();
 
     // Start NIC port
@@ -189,40 +532,121 @@ void GenApplication::Run(StopVarType &doWork)
         throw std::runtime_error("Link is still down after 10 sec...");
     }
 
-    TxCycleConfig conf{pool.Get(), port.GetID(), nicQueueID};
+    // NIC paces packets by timestamps, otherwise CPU does it
+    DPDK::NicClock nicClock(port.GetID());
+    int tsOffset = -1;
+    uint64_t tsFlag = 0;
+    if (m_txTimestamp) {
+        if (!port.IsTxTimestampEnabled()) {
+            std::cerr << "SEND_ON_TIMESTAMP isn't supported by NIC, CPU pacing is used\n";
+        } else if (rte_mbuf_dyn_tx_timestamp_register(&tsOffset, &tsFlag) != 0) {
+            std::cerr << "Can't register TX timestamp mbuf field, CPU pacing is used\n";
+            tsOffset = -1;
+        } else {
+            nicClock.Calibrate();
+            std::cout << std::format("\n\tTX timestamps: NIC clock = {:.3f} MHz\n",
+                                     nicClock.GetNicHz() / 1'000'000.0);
+        }
+    }
 
-    // Main cycle
+    // R-GOOSE/R-SV: NIC computes UDP checksum, otherwise it's updated incrementally
+    if (m_routable) {
+        m_routableConf.udpCksumOffload = port.IsTxUdpCksumEnabled();
+        std::cout << "\n\tR-GOOSE/R-SV: UDP checksum by "
+                  << (m_routableConf.udpCksumOffload ? "NIC" : "CPU") << "\n";
+    }
+    auto routable = [&](auto gen) {
+        if (m_routable) {
+            gen->MakeRoutable(m_routableConf);
+        }
+        return gen;
+    };
+
+    // PRP: streams are told apart by a byte of source MACs
+    auto prpStream = [&](uint8_t stream) -> uint8_t {
+        return m_prp ? stream : 0;
+    };
+
+    // Sources of each TX lcore
+    std::vector< TxLCoreTask > tasks(m_lcores.size());
     if (m_gooseNum > 0) {
         // GOOSE
         const unsigned DEF_GOOSE_ENTRIES = 16;
-        GooseTrafficGen gen(m_gooseNum, m_gooseSendFreq, DEF_GOOSE_ENTRIES);
-
-        DPDK::PoolSetter(gen.GetSkeletonBuffer(), gen.GetSkeletonSize())
-                        .FillPackets(pool.Get());
+        auto makeGen = [&](unsigned first, unsigned num) {
+            return routable(std::make_unique< GooseTrafficGen >(num, m_gooseSendFreq, DEF_GOOSE_ENTRIES,
+                                                                 first, m_gooseEvent.talMS));
+        };
+        if (m_gooseEventMode) {
+            add_sharded_traffic(tasks, goosePool, m_gooseNum, makeGen,
+                [&](std::unique_ptr< GooseTrafficGen > gen) -> TxSource::ptr {
+                    return std::make_unique< GooseEventSource >(std::move(gen), goosePool, m_gooseEvent);
+                },
+                prpStream(1));
+        } else {
+            add_sharded_traffic(tasks, goosePool, m_gooseNum, makeGen,
+                gen_source_maker< GooseTrafficGen,
+                                  &GooseTrafficGen::AmendPacket,
+                                  &GooseTrafficGen::StampIdentity,
+                                  &GooseTrafficGen::AmendCounters >(goosePool, "GOOSE", m_prebuiltDepth),
+                prpStream(1));
+        }
+    }
+    // SV samples are computed once per sample rate and shared by all lcores
+    std::unique_ptr< ComtradeRecord > comtrade;
+    if (!m_comtradeFile.empty() && (m_sv80Num > 0 || m_sv256Num > 0)) {
+        comtrade = std::make_unique< ComtradeRecord >(ComtradeRecord::Load(m_comtradeFile));
+        std::cout << std::format("\n\tCOMTRADE: {} channels, {} samples\n",
+                                 comtrade->GetChannels().size(), comtrade->GetSampleNum());
+    }
+    auto make_wave = [&](SV_TYPE type) {
+        unsigned rate = SVTrafficGen::GetSampleRate(type);
+        return comtrade ? SVWaveform::FromComtrade(*comtrade, rate)
+                        : SVWaveform::Synthesize(m_svWave, rate);
+    };
 
-        // Generate cycle with GOOSE packets
-        tx_packets_cycle< GooseTrafficGen >(conf, m_stat, gen, doWork);
-    } else if (m_sv80Num > 0) {
+    if (m_sv80Num > 0) {
         // SV 80 points
-        SVTrafficGen gen(m_sv80Num, SV_TYPE::SV80);
-
-        DPDK::PoolSetter(gen.GetSkeletonBuffer(), gen.GetSkeletonSize())
-                        .FillPackets(pool.Get());
-
-        // Generate cycle with SV packets
-        tx_packets_cycle< SVTrafficGen, &SVTrafficGen::AmendPacketSV80 >(conf, m_stat, gen, doWork);
-    } else if (m_sv256Num > 0) {
+        add_sharded_traffic(tasks, sv80Pool, m_sv80Num,
+            [&, wave = make_wave(SV_TYPE::SV80)](unsigned first, unsigned num) {
+                return routable(std::make_unique< SVTrafficGen >(num, SV_TYPE::SV80, first, wave));
+            },
+            gen_source_maker< SVTrafficGen,
+                              &SVTrafficGen::AmendPacketSV80,
+                              &SVTrafficGen::StampIdentitySV80,
+                              &SVTrafficGen::AmendCountersSV80 >(sv80Pool, "SV80", m_prebuiltDepth),
+            prpStream(2));
+    }
+    if (m_sv256Num > 0) {
         // SV 256 points
-        SVTrafficGen gen(m_sv256Num, SV_TYPE::SV256);
+        add_sharded_traffic(tasks, sv256Pool, m_sv256Num,
+            [&, wave = make_wave(SV_TYPE::SV256)](unsigned first, unsigned num) {
+                return routable(std::make_unique< SVTrafficGen >(num, SV_TYPE::SV256, first, wave));
+            },
+            gen_source_maker< SVTrafficGen,
+                              &SVTrafficGen::AmendPacketSV256,
+                              &SVTrafficGen::StampIdentitySV256,
+                              &SVTrafficGen::AmendCountersSV256 >(sv256Pool, "SV256", m_prebuiltDepth),
+            prpStream(3));
+    }
 
-        DPDK::PoolSetter(gen.GetSkeletonBuffer(), gen.GetSkeletonSize())
-                        .FillPackets(pool.Get());
+    // Let all lcores reach their loops before the first PPS
+    uint64_t startTick = DPDK::Clocks::get_current_ticks() + DPDK::Clocks::get_ticks_per_sec() / 10;
+    for (unsigned i=0;i<tasks.size();++i) {
+        tasks[i].conf = TxCycleConfig{port.GetID(), (uint16_t)i, startTick, m_pacingPerc,
+                                      &nicClock, i == 0 && tsOffset >= 0, tsOffset, tsFlag};
+        tasks[i].stat = &m_stat[i];
+        tasks[i].doWork = &doWork;
+    }
 
-        // Generate cycle with SV packets
-        tx_packets_cycle< SVTrafficGen, &SVTrafficGen::AmendPacketSV256 >(conf, m_stat, gen, doWork);
-    } else {
-        std::cerr << "You have to specify GOOSE or SV to generate!\n";
+    // Main cycle
+    std::cout << "\n\tStart main loop with TX lcores: " << tasks.size() << "\n";
+    for (unsigned i=1;i<tasks.size();++i) {
+        if (!tasks[i].sources.empty()) {
+            rte_eal_remote_launch(tx_lcore, &tasks[i], m_lcores[i]);
+        }
     }
+    tx_lcore(&tasks[0]);
+    rte_eal_mp_wait_lcore();
 
     // Finish delimiter
     std::cout << std::format("\n\n{:*<80}\n{:*^80}\n{:*<80}\n\n",
@@ -1,14 +1,24 @@
 #pragma once
 
 #include "common/utils.hpp"
+#include "common/jitter_detector.hpp"
 #include "dpdk_cpp/dpdk_cyclestat_class.hpp"
 
+#include "goose_traffic_gen.hpp"
+#include "sv_waveform.hpp"
+
+#include <memory>
+#include <vector>
+
 using StopVarType = volatile bool;
 
 struct GenAppStat
 {
     DPDK::CyclicStat procStat;
     unsigned         errSendCnt = 0;
+    uint64_t         prebuiltMissCnt = 0; // Prebuilt mbufs of IED were still in TX ring
+    uint64_t         gooseEventCnt = 0;   // GOOSE state changes of event mode
+    std::unique_ptr< JitterDetector > jitter;  // Lateness of TX units, nullptr if it's off
 };
 
 /**
@@ -28,9 +38,32 @@ private:
     unsigned m_gooseNum = 0,
              m_gooseSendFreq = 1,
              m_sv80Num = 0,
-             m_sv256Num = 0;
+             m_sv256Num = 0,
+             m_pacingPerc = 0,
+             m_prebuiltDepth = 0;
+    bool     m_txTimestamp = false;
+
+    // R-GOOSE/R-SV instead of L2 frames
+    bool             m_routable = false;
+    RoutableConfig   m_routableConf;
+    bool             m_routableSwCksum = false;
+
+    // PRP: LAN A and LAN B copies of each frame
+    bool             m_prp = false;
+
+    // Stall threshold of TX lcores, 0 - no detector
+    unsigned         m_jitterUS = 0;
+
+    // GOOSE by events with the retransmission curve instead of a fixed frequency
+    bool             m_gooseEventMode = false;
+    GooseEventConfig m_gooseEvent;
+
+    // SV samples: synthesized or from COMTRADE
+    SVWaveformConfig m_svWave;
+    std::string      m_comtradeFile;
 
-    // Statistics
-    GenAppStat m_stat;
+    // Statistics of each TX lcore, the main lcore is the first
+    std::vector< unsigned >   m_lcores;
+    std::vector< GenAppStat > m_stat;
 };
 
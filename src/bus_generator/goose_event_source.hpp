@@ -0,0 +1,175 @@
+#pragma once
+
+#include "goose_traffic_gen.hpp"
+#include "timing_wheel.hpp"
+#include "tx_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @class GooseEventSource
+ * @brief Each TX unit is a tick of the timing wheel: IEDs whose retransmission
+ * expired and IEDs which changed their state are sent. Work per tick is O(1)
+ * per sent packet, so 10k+ publishers fit one lcore.
+ */
+class GooseEventSource : public TxSource
+{
+public:
+    GooseEventSource(std::unique_ptr< GooseTrafficGen > gen, rte_mempool *pool,
+                     const GooseEventConfig &conf)
+        : m_gen(std::move(gen)), m_pool(pool), m_conf(conf),
+          m_wheel(m_gen->GetIEDNum()),
+          m_interval(m_gen->GetIEDNum()),
+          m_dueTick(m_gen->GetIEDNum(), UINT64_MAX)
+    {
+        if (m_conf.tickUS == 0 || 1'000'000 % m_conf.tickUS != 0) {
+            throw std::invalid_argument("GOOSE event tick must divide a second: " + std::to_string(m_conf.tickUS));
+        }
+        if (m_conf.t0MS == 0 || m_conf.talMS < 2 * m_conf.t0MS) {
+            throw std::invalid_argument("GOOSE T0 must be positive and TAL/2 must be T0 or more");
+        }
+
+        m_unitNum = 1'000'000 / m_conf.tickUS;
+        m_t0Ticks = std::max< uint64_t >(1, m_conf.t0MS * 1'000ULL / m_conf.tickUS);
+        m_heartbeatTicks = std::max< uint64_t >(m_t0Ticks, m_conf.talMS * 1'000ULL / 2 / m_conf.tickUS);
+        if (m_heartbeatTicks > decltype(m_wheel)::MAX_DELAY) {
+            throw std::invalid_argument("GOOSE heartbeat is out of the timing wheel: " + std::to_string(m_conf.talMS));
+        }
+        m_eventsPerTick = m_conf.eventsPerSec / m_unitNum;
+        m_hz = DPDK::Clocks::get_ticks_per_sec();
+
+        // Heartbeats of IEDs are spread over the interval
+        const size_t iedNum = m_gen->GetIEDNum();
+        for (size_t i=0;i<iedNum;++i) {
+            m_interval[i] = m_heartbeatTicks;
+            m_wheel.Schedule(i, 1 + i * m_heartbeatTicks / iedNum);
+        }
+        m_due.reserve(iedNum);
+    }
+
+    const char* GetName() const override { return "GOOSE events"; }
+
+    size_t GetUnitNum() const override { return m_unitNum; }
+    uint64_t GetUnitOffsetTicks(size_t idx) const override {
+        return idx * m_hz / m_unitNum;
+    }
+    /**
+     * @brief Expected for pacing: retransmissions of the next tick and new events
+     */
+    size_t GetUnitPacketNum(size_t idx) const override {
+        return m_wheel.GetDueNum() + (size_t)(m_eventAcc + m_eventsPerTick);
+    }
+
+    void SendUnit(size_t idx, const TxContext &ctx, GenAppStat &stat) override {
+        const size_t iedNum = m_gen->GetIEDNum();
+        if (m_startNS == 0) {
+            // The initial state of all IEDs: stNum = 1
+            m_startNS = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+            for (size_t i=0;i<iedNum;++i) {
+                m_gen->ChangeState(i, GooseTrafficGen::ToUtcTime(m_startNS));
+            }
+        }
+
+        m_due.clear();
+        m_wheel.Advance([this](uint32_t id) { AddDue(id); });
+
+        const uint64_t now = m_wheel.GetNow();
+        const uint64_t utc = GooseTrafficGen::ToUtcTime(m_startNS + now * m_conf.tickUS * 1'000ULL);
+        if (m_conf.avalancheSec > 0 && now % ((uint64_t)m_conf.avalancheSec * m_unitNum) == 0) {
+            for (size_t i=0;i<iedNum;++i) {
+                ChangeState(i, utc, stat);
+            }
+        } else if (m_eventsPerTick > 0.0) {
+            m_eventAcc = std::min(m_eventAcc + m_eventsPerTick, (double)iedNum);
+            for (;m_eventAcc >= 1.0;m_eventAcc -= 1.0) {
+                ChangeState(m_nextIED, utc, stat);
+                m_nextIED = (m_nextIED + 1 < iedNum) ? (m_nextIED + 1) : 0;
+            }
+        }
+
+        Transmit(ctx, stat);
+
+        // The next retransmission: T0 is doubled up to the heartbeat
+        for (uint32_t id : m_due) {
+            m_wheel.Schedule(id, m_interval[id]);
+            m_interval[id] = std::min(m_interval[id] * 2, m_heartbeatTicks);
+        }
+    }
+
+private:
+    inline void AddDue(uint32_t id) {
+        const uint64_t now = m_wheel.GetNow();
+        if (m_dueTick[id] != now) {
+            m_dueTick[id] = now;
+            m_due.push_back(id);
+        }
+    }
+
+    inline void ChangeState(uint32_t id, uint64_t utc, GenAppStat &stat) {
+        m_gen->ChangeState(id, utc);
+        m_interval[id] = m_t0Ticks;
+        m_wheel.Cancel(id);
+        AddDue(id);
+        ++stat.gooseEventCnt;
+    }
+
+    void Transmit(const TxContext &ctx, GenAppStat &stat) {
+        rte_mbuf* mbufs[TX_BURST_SIZE] = { 0 };
+        rte_mbuf* copies[TX_BURST_SIZE] = { 0 };
+        size_t sendNum = 0;
+        uint64_t pktIdx = 0; // Packet index inside the unit
+        while (sendNum < m_due.size()) {
+            unsigned num = std::min< size_t >(m_due.size() - sendNum, TX_BURST_SIZE);
+            if (rte_pktmbuf_alloc_bulk(m_pool, mbufs, num) != 0) {
+                rte_eth_tx_done_cleanup(ctx.portID, ctx.queueID, 0);
+                continue;
+            }
+
+            for (unsigned i=0;i<num;++i) {
+                uint8_t *packet = rte_pktmbuf_mtod(mbufs[i], uint8_t *);
+
+                mbufs[i]->pkt_len = m_gen->AmendEventPacket(packet, GoosePacketDesc{ m_due[sendNum + i] });
+                mbufs[i]->data_len = mbufs[i]->pkt_len;
+                if (m_prp.IsEnabled()) {
+                    m_prp.Tag(mbufs[i], m_due[sendNum + i]);
+                }
+                m_gen->GetTxOffload().Apply(mbufs[i]);
+            }
+            unsigned copyNum = prp_duplicate(m_prp, mbufs, num, copies, stat);
+
+            uint16_t nb_tx = tx_transmit(ctx, mbufs, num, pktIdx);
+            if (nb_tx < num) {
+                for (uint16_t i=nb_tx;i<num;i++) {
+                    rte_pktmbuf_free(mbufs[i]);
+                }
+                stat.errSendCnt += num - nb_tx;
+            }
+            prp_transmit(ctx, copies, copyNum, pktIdx, stat);
+            sendNum += num;
+            pktIdx += nb_tx;
+        }
+    }
+
+private:
+    std::unique_ptr< GooseTrafficGen >  m_gen;
+    rte_mempool*                        m_pool = nullptr;
+    GooseEventConfig                    m_conf;
+
+    TimingWheel<>                       m_wheel;
+    std::vector< uint64_t >             m_interval; // The next retransmission of each IED, ticks
+    std::vector< uint64_t >             m_dueTick;  // The IED is already due at the tick
+    std::vector< uint32_t >             m_due;      // IEDs to send at the current tick
+
+    size_t      m_unitNum = 1;
+    uint64_t    m_hz = 1;
+    uint64_t    m_t0Ticks = 1,
+                m_heartbeatTicks = 1;
+    double      m_eventsPerTick = 0.0,
+                m_eventAcc = 0.0;
+    size_t      m_nextIED = 0;
+    uint64_t    m_startNS = 0;
+};
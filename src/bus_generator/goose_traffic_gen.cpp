@@ -5,6 +5,7 @@
 #include "goose_receiver.h"
 
 #include <iostream>
+#include <vector>
 #include <inttypes.h>
 #include <stdexcept>
 
@@ -34,14 +35,15 @@ namespace
     }
 }
 
-GooseTrafficGen::GooseTrafficGen(unsigned MaxGooseNum, unsigned SndFreq, unsigned SignalsPerGoose)
-    : m_ieds(MaxGooseNum)
+GooseTrafficGen::GooseTrafficGen(unsigned MaxGooseNum, unsigned SndFreq, unsigned SignalsPerGoose,
+                                 unsigned FirstIED, unsigned TimeAllowedToLive)
+    : m_ieds(MaxGooseNum), m_firstIED(FirstIED)
 {
     for (size_t i=0;i<m_ieds.size();++i) {
-        InitIED(m_ieds[i], i + 1);
+        InitIED(m_ieds[i], m_firstIED + i + 1);
     }
 
-    MakeSkeletonPacket(SignalsPerGoose);
+    MakeSkeletonPacket(SignalsPerGoose, TimeAllowedToLive);
 
     GenerateTxUnits(SndFreq);
 }
@@ -51,7 +53,7 @@ void GooseTrafficGen::InitIED(GooseSourceIED &ied, unsigned idx)
 	snprintf(ied.sID, sizeof(ied.sID), "%08" PRIu64 "", (uint64_t)idx);
 }
 
-void GooseTrafficGen::MakeSkeletonPacket(unsigned sigNum)
+void GooseTrafficGen::MakeSkeletonPacket(unsigned sigNum, unsigned timeAllowedToLive)
 {
     CommParameters gooseCommParameters = {
         .vlanPriority = 4,
@@ -72,7 +74,7 @@ void GooseTrafficGen::MakeSkeletonPacket(unsigned sigNum)
         GoosePublisher_setGoCbRef(publisher, const_cast< char* >(GOCB_REF_PATTERN));
         GoosePublisher_setDataSetRef(publisher, const_cast< char* >(DS_REF_PATTERN));
         GoosePublisher_setConfRev(publisher, 1);
-        GoosePublisher_setTimeAllowedToLive(publisher, 2000);
+        GoosePublisher_setTimeAllowedToLive(publisher, timeAllowedToLive);
         GoosePublisher_setStNum(publisher, 0x7FFFFFFF);
         GoosePublisher_setSqNum(publisher, 0x7FFFFFFF);
 
@@ -113,32 +115,26 @@ void GooseTrafficGen::MakeSkeletonPacket(unsigned sigNum)
 void GooseTrafficGen::GenerateTxUnits(unsigned pps)
 {
     const unsigned BUNCH_SIZE = 32;
-    m_units.reserve(pps);
-    for (size_t i=0;i<pps;i++) {
-        TxGooseUnit unit;
-        unit.offsetUS = 1'000'000 / pps * i;
-
-        const unsigned BLK_PER_UNIT = m_ieds.size() / BUNCH_SIZE;
-        const unsigned LAST_BLK_SIZE = m_ieds.size() % BUNCH_SIZE;
-        unit.blocks.resize(BLK_PER_UNIT + (LAST_BLK_SIZE > 0 ? 1 : 0));
-
-        unsigned iedIndex = 0;
-        for (size_t j=0;j<BLK_PER_UNIT;++j) {
-            TxGooseUnit::BlockType &blk = unit.blocks[j];
-            blk.packets.resize(BUNCH_SIZE);
-            for (auto &desc : blk.packets) {
-                desc.idx = iedIndex++;
-            }
-        }
-        if (LAST_BLK_SIZE > 0) {
-            TxGooseUnit::BlockType &blk = unit.blocks.back();
-            blk.packets.resize(LAST_BLK_SIZE);
-            for (auto &desc : blk.packets) {
-                desc.idx = iedIndex++;
-            }
-        }
+    m_units = TxUnitArray(pps, m_ieds.size(), BUNCH_SIZE);
+}
 
-        m_units.push_back(std::move(unit));
+void GooseTrafficGen::MakeRoutable(const RoutableConfig &conf)
+{
+    int shift = m_routable.Wrap(m_skeleton, m_skeletonSize, sizeof(m_skeleton), RSession::SI_GOOSE, conf);
+    for (int i=0;i<GOOSE_OFFSET_NUM;++i) {
+        m_offsets[i] += shift;
     }
-}
+    m_offsets[GOOSE_APPID_OFFSET] = m_routable.GetAppIDOffset();
 
+    m_routable.AddVarField(m_offsets[GOOSE_TIMESTAMP_OFFSET], 8);
+    m_routable.AddVarField(m_offsets[GOOSE_ST_NUM_OFFSET], 4);
+    m_routable.AddVarField(m_offsets[GOOSE_SQ_NUM_OFFSET], 4);
+    m_routable.AddVarField(m_offsets[GOOSE_D1_OFFSET], 1);
+
+    // Constant bytes of each IED: identity is stamped, variable fields are zero
+    std::vector< uint8_t > packet(m_skeleton, m_skeleton + m_skeletonSize);
+    for (size_t i=0;i<m_ieds.size();++i) {
+        StampIdentity(packet.data(), i);
+        m_ieds[i].udpBaseSum = m_routable.BaseSum(packet.data());
+    }
+}
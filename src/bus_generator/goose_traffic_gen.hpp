@@ -1,11 +1,13 @@
 #pragma once
 
-#include "tx_unit.hpp"
+#include "tx_schedule.hpp"
+#include "routable_frame.hpp"
 #include "common/goose_container.hpp"
 #include "rte_byteorder.h"
 
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #define MAX_GOOSE_PACKET_SIZE      1518
 
@@ -29,6 +31,10 @@ struct GooseSourceIED
     uint32_t    stNum = 0;
     uint32_t    sqNum = 0;
     uint64_t    timestamp = 0;
+
+    // R-GOOSE
+    uint32_t    spduNum = 0;
+    uint16_t    udpBaseSum = 0; // UDP checksum of constant bytes
 };
 
 struct GoosePacketDesc
@@ -36,6 +42,20 @@ struct GoosePacketDesc
     unsigned    idx = 0; // The GOOSE IED index
 };
 
+/**
+ * @brief GOOSE event mode: state changes and the retransmission curve
+ * of IEC 61850-8-1. After a change the packet is repeated in T0, 2*T0,
+ * 4*T0, ... until the heartbeat of timeAllowedToLive/2.
+ */
+struct GooseEventConfig
+{
+    unsigned tickUS = 500;          // Resolution of the timing wheel
+    unsigned t0MS = 2;              // The first retransmission after a change
+    unsigned talMS = 2000;          // timeAllowedToLive, the heartbeat is a half of it
+    double   eventsPerSec = 0.0;    // State changes of all IEDs, they change by turns
+    unsigned avalancheSec = 0;      // All IEDs change at once each N sec, 0 is off
+};
+
 /**
  * @brief CreateUnitser a banch of Gooses with fixed offsets
  */
@@ -43,18 +63,52 @@ class GooseTrafficGen
 {
 public:
     using Desc = GoosePacketDesc;
-    using TxGooseUnit = TxUnit< GoosePacketDesc >;
-    using TxUnitArray = std::vector< GooseTrafficGen::TxGooseUnit >;
-    GooseTrafficGen(unsigned MaxGooseNum, unsigned SndFreq, unsigned SignalsPerGoose);
+    using TxUnitArray = TxSchedule< GoosePacketDesc >;
+    using TxGooseUnit = TxUnitArray::Unit;
+    /**
+     * @param FirstIED The index of the first IED, when IEDs are shared among generators
+     * @param TimeAllowedToLive The value of timeAllowedToLive in ms
+     */
+    GooseTrafficGen(unsigned MaxGooseNum, unsigned SndFreq, unsigned SignalsPerGoose,
+                    unsigned FirstIED = 0, unsigned TimeAllowedToLive = 2000);
+
+    /**
+     * @brief UtcTime of GOOSE(seconds, 24 bit fraction, quality) as it's in the packet
+     */
+    static inline uint64_t ToUtcTime(uint64_t ns)
+    {
+        uint32_t sec = ns / 1'000'000'000ULL;
+        uint32_t frac = ((ns % 1'000'000'000ULL) << 24) / 1'000'000'000ULL;
+
+        uint8_t utc[8] = {
+            (uint8_t)(sec >> 24), (uint8_t)(sec >> 16), (uint8_t)(sec >> 8), (uint8_t)sec,
+            (uint8_t)(frac >> 16), (uint8_t)(frac >> 8), (uint8_t)frac,
+            0x0A // 10 bits of accuracy
+        };
+        uint64_t value = 0;
+        std::memcpy(&value, utc, sizeof(value));
+        return value;
+    }
 
-    inline size_t AmendPacket(uint8_t *packet, const GoosePacketDesc &desc)
+    /**
+     * @brief Fields which never change for the IED: APPID, GOID, GOCBRef, DataSetRef
+     */
+    inline void StampIdentity(uint8_t *packet, unsigned idx)
     {
-        GooseSourceIED &ied = m_ieds[desc.idx];
+        GooseSourceIED &ied = m_ieds[idx];
 
-        *(uint16_t *)(packet + m_offsets[GOOSE_APPID_OFFSET]) = RTE_STATIC_BSWAP16((desc.idx + 1) & 0xFFFF);
+        *(uint16_t *)(packet + m_offsets[GOOSE_APPID_OFFSET]) = RTE_STATIC_BSWAP16((m_firstIED + idx + 1) & 0xFFFF);
         *(uint64_t *)(packet + m_offsets[GOOSE_GOID_OFFSET] + 4/*GOID*/) = *(uint64_t *)ied.sID;
         *(uint64_t *)(packet + m_offsets[GOOSE_GOCB_REF_OFFSET] + 3/*IED*/) = *(uint64_t *)ied.sID;
         *(uint64_t *)(packet + m_offsets[GOOSE_DS_REF_OFFSET] + 3/*IED*/) = *(uint64_t *)ied.sID;
+    }
+
+    /**
+     * @brief Per-packet fields: t, stNum, sqNum and the data, the packet must be stamped by the IED
+     */
+    inline size_t AmendCounters(uint8_t *packet, const GoosePacketDesc &desc)
+    {
+        GooseSourceIED &ied = m_ieds[desc.idx];
 
         ied.timestamp += m_tsDeltaChange;
         *(uint64_t *)(packet + m_offsets[GOOSE_TIMESTAMP_OFFSET]) = ied.timestamp;
@@ -65,9 +119,65 @@ public:
 
         packet[m_offsets[GOOSE_D1_OFFSET]] = (ied.stNum % 2 == 0) ? 1 : 0;
 
+        if (m_routable.IsEnabled()) {
+            m_routable.Finish(packet, ied.spduNum, ied.udpBaseSum);
+        }
         return m_skeletonSize;
     }
 
+    inline size_t AmendPacket(uint8_t *packet, const GoosePacketDesc &desc)
+    {
+        StampIdentity(packet, desc.idx);
+        return AmendCounters(packet, desc);
+    }
+
+    /**
+     * @brief Event mode: the new state with its time, next packets are its retransmissions
+     */
+    inline void ChangeState(unsigned idx, uint64_t utcTime)
+    {
+        GooseSourceIED &ied = m_ieds[idx];
+
+        ++ied.stNum;
+        ied.sqNum = 0;
+        ied.timestamp = utcTime;
+    }
+
+    /**
+     * @brief Event mode: the current state, stNum is kept and sqNum is incremented
+     */
+    inline size_t AmendState(uint8_t *packet, const GoosePacketDesc &desc)
+    {
+        GooseSourceIED &ied = m_ieds[desc.idx];
+
+        *(uint64_t *)(packet + m_offsets[GOOSE_TIMESTAMP_OFFSET]) = ied.timestamp;
+        *(uint32_t *)(packet + m_offsets[GOOSE_ST_NUM_OFFSET]) = RTE_STATIC_BSWAP32(ied.stNum);
+        *(uint32_t *)(packet + m_offsets[GOOSE_SQ_NUM_OFFSET]) = RTE_STATIC_BSWAP32(ied.sqNum);
+
+        packet[m_offsets[GOOSE_D1_OFFSET]] = (ied.stNum % 2 == 0) ? 1 : 0;
+
+        // sqNum rolls over to 1, 0 is the first packet of a state
+        ied.sqNum = (ied.sqNum == UINT32_MAX) ? 1 : (ied.sqNum + 1);
+
+        if (m_routable.IsEnabled()) {
+            m_routable.Finish(packet, ied.spduNum, ied.udpBaseSum);
+        }
+        return m_skeletonSize;
+    }
+
+    inline size_t AmendEventPacket(uint8_t *packet, const GoosePacketDesc &desc)
+    {
+        StampIdentity(packet, desc.idx);
+        return AmendState(packet, desc);
+    }
+
+    /**
+     * @brief R-GOOSE: the skeleton is wrapped into IPv4/UDP/session, offsets are moved
+     */
+    void        MakeRoutable(const RoutableConfig &conf);
+    const TxOffload& GetTxOffload() const { return m_routable.GetTxOffload(); }
+
+    size_t      GetIEDNum() const { return m_ieds.size(); }
     size_t      GetSkeletonSize() const { return m_skeletonSize; }
     uint8_t*    GetSkeletonBuffer() { return m_skeleton; }
 
@@ -75,18 +185,21 @@ public:
 
 private:
     void        InitIED(GooseSourceIED &ied, unsigned idx);
-    void        MakeSkeletonPacket(unsigned sigNum);
+    void        MakeSkeletonPacket(unsigned sigNum, unsigned timeAllowedToLive);
     void        GenerateTxUnits(unsigned pps);
 
 private:
     std::vector< GooseSourceIED >   m_ieds; // 1 GOOSE <-> 1 IED
     GooseTrafficGen::TxUnitArray    m_units; // TX moments with {blocks}
 
+    unsigned    m_firstIED = 0;
     unsigned    m_signalNum = 16;
     unsigned    m_tsDeltaChange = 0;
 
     uint16_t    m_offsets[GOOSE_OFFSET_NUM] = { 0 };
     uint8_t     m_skeleton[MAX_GOOSE_PACKET_SIZE] = { 0 };
     size_t      m_skeletonSize = 0;
+
+    RoutableFrame m_routable;
 };
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @class PrpTagger
+ * @brief IEC 62439-3 PRP traffic: each IED is a doubly attached node with its
+ * own source MAC, its frames get the redundancy control trailer(RCT) and are
+ * sent twice, for LAN A and LAN B. Both copies leave the same port, a switch
+ * or the receiver's duplicate discard sees them as two LANs.
+ */
+class PrpTagger
+{
+public:
+    static const uint16_t RCT_SIZE = 6;
+    static const uint16_t MIN_FRAME_SIZE = 60;  // Without FCS
+    static const uint8_t  LAN_A = 0xA,
+                          LAN_B = 0xB;
+
+    PrpTagger() = default;
+
+    /**
+     * @param stream The byte of source MACs which separates streams of one generator
+     */
+    PrpTagger(uint8_t stream, unsigned firstIED, size_t iedNum, rte_mempool *pool)
+        : m_seq(iedNum, 0), m_stream(stream), m_firstIED(firstIED), m_pool(pool)
+    {}
+
+    bool IsEnabled() const { return m_pool != nullptr; }
+
+    /**
+     * @brief Source MAC of the IED and RCT of LAN A after the frame, short frames
+     * are padded before RCT. The mbuf's lengths are updated.
+     */
+    inline void Tag(rte_mbuf *m, unsigned idx) {
+        uint8_t *packet = rte_pktmbuf_mtod(m, uint8_t *);
+        const unsigned ied = m_firstIED + idx;
+        // Locally administered: 02:50:52:<stream>:<IED>
+        packet[6] = 0x02; packet[7] = 0x50; packet[8] = 0x52;
+        packet[9] = m_stream;
+        packet[10] = (ied >> 8) & 0xFF;
+        packet[11] = ied & 0xFF;
+
+        uint16_t len = m->data_len;
+        if (len + RCT_SIZE < MIN_FRAME_SIZE) {
+            std::memset(packet + len, 0, MIN_FRAME_SIZE - RCT_SIZE - len);
+            len = MIN_FRAME_SIZE - RCT_SIZE;
+        }
+        const bool vlan = packet[12] == 0x81 && packet[13] == 0x00;
+        const uint16_t lsdu = len + RCT_SIZE - 12 - (vlan ? 4 : 0);
+        const uint16_t seq = m_seq[idx]++;
+
+        uint8_t *rct = packet + len;
+        rct[0] = seq >> 8;
+        rct[1] = seq & 0xFF;
+        rct[2] = (LAN_A << 4) | ((lsdu >> 8) & 0x0F);
+        rct[3] = lsdu & 0xFF;
+        rct[4] = 0x88;
+        rct[5] = 0xFB;
+        m->data_len = len + RCT_SIZE;
+        m->pkt_len = m->data_len;
+    }
+
+    /**
+     * @brief Copies for LAN B of tagged mbufs, they must be taken before
+     * the originals are sent
+     * @return The number of copies, an mbuf without a copy goes to LAN A only
+     */
+    inline unsigned Duplicate(rte_mbuf **mbufs, unsigned num, rte_mbuf **copies) {
+        unsigned copyNum = 0;
+        for (unsigned i=0;i<num;++i) {
+            rte_mbuf *c = rte_pktmbuf_copy(mbufs[i], m_pool, 0, UINT32_MAX);
+            if (c == nullptr) {
+                continue;
+            }
+            uint8_t *rct = rte_pktmbuf_mtod_offset(c, uint8_t *, c->data_len - RCT_SIZE);
+            rct[2] = (LAN_B << 4) | (rct[2] & 0x0F);
+            copies[copyNum++] = c;
+        }
+        return copyNum;
+    }
+
+private:
+    std::vector< uint16_t > m_seq;  // The next sequence number of each IED
+    uint8_t         m_stream = 0;
+    unsigned        m_firstIED = 0;
+    rte_mempool*    m_pool = nullptr;
+};
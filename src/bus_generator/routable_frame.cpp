@@ -0,0 +1,143 @@
+#include "routable_frame.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const uint16_t ETH_ADDRS_SIZE = 12;
+    const uint16_t VLAN_TAG_SIZE = 4;
+    const uint16_t L2_APDU_HEADER_SIZE = 8; // APPID, Length, Reserved 1/2
+
+    inline void put_be16(uint8_t *p, uint16_t value) {
+        p[0] = value >> 8;
+        p[1] = value;
+    }
+    inline void put_be32(uint8_t *p, uint32_t value) {
+        p[0] = value >> 24;
+        p[1] = value >> 16;
+        p[2] = value >> 8;
+        p[3] = value;
+    }
+}
+
+int RoutableFrame::Wrap(uint8_t *skeleton, size_t &size, size_t capacity, uint8_t sessionID,
+                        const RoutableConfig &conf)
+{
+    // L2 frame: MACs, 802.1Q tag(optional), EtherType, APPID, Length, Reserved, APDU
+    uint16_t typeOffset = ETH_ADDRS_SIZE;
+    if (size > typeOffset + 2 && skeleton[typeOffset] == 0x81 && skeleton[typeOffset + 1] == 0x00) {
+        typeOffset += VLAN_TAG_SIZE;
+    }
+    const uint16_t l2ApduOffset = typeOffset + 2 + L2_APDU_HEADER_SIZE;
+    if (size <= l2ApduOffset) {
+        throw std::invalid_argument("L2 skeleton is too short: " + std::to_string(size));
+    }
+    const uint16_t appid = (skeleton[typeOffset + 2] << 8) | skeleton[typeOffset + 3];
+    const uint16_t apduLen = size - l2ApduOffset;
+
+    const uint16_t l2Len = typeOffset + 2;
+    const uint16_t l3Len = sizeof(rte_ipv4_hdr);
+    const uint16_t sessionOffset = l2Len + l3Len + sizeof(rte_udp_hdr);
+    const size_t newSize = sessionOffset + RSession::APDU_OFFSET + apduLen + RSession::SIGNATURE_SIZE;
+    if (newSize > capacity) {
+        throw std::invalid_argument("R-GOOSE/R-SV frame doesn't fit the skeleton: " + std::to_string(newSize));
+    }
+
+    std::vector< uint8_t > frame(newSize, 0);
+    uint8_t *p = frame.data();
+
+    // Ethernet: IPv4 multicast MAC, the source MAC and VLAN tag are kept
+    RSession::multicast_mac(conf.dstIP, p);
+    std::memcpy(p + 6, skeleton + 6, typeOffset - 6);
+    put_be16(p + typeOffset, 0x0800);
+
+    // IPv4: constant for all IEDs, so its checksum is done once
+    rte_ipv4_hdr *ip = (rte_ipv4_hdr *)(p + l2Len);
+    ip->version_ihl = 0x45;
+    ip->type_of_service = conf.tos;
+    ip->total_length = rte_cpu_to_be_16(newSize - l2Len);
+    ip->packet_id = 0;
+    ip->fragment_offset = rte_cpu_to_be_16(0x4000); // Don't fragment
+    ip->time_to_live = conf.ttl;
+    ip->next_proto_id = 17; // UDP
+    ip->src_addr = rte_cpu_to_be_32(conf.srcIP);
+    ip->dst_addr = rte_cpu_to_be_32(conf.dstIP);
+    ip->hdr_checksum = 0;
+    ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+    rte_udp_hdr *udp = (rte_udp_hdr *)(p + l2Len + l3Len);
+    udp->src_port = rte_cpu_to_be_16(conf.udpPort);
+    udp->dst_port = rte_cpu_to_be_16(conf.udpPort);
+    udp->dgram_len = rte_cpu_to_be_16(newSize - l2Len - l3Len);
+    udp->dgram_cksum = 0;
+
+    // Session header without security: algorithms and keys are zero
+    uint8_t *s = p + sessionOffset;
+    s[RSession::SI_OFFSET] = sessionID;
+    s[RSession::SI_OFFSET + 1] = RSession::SESSION_LI;
+    s[RSession::SI_OFFSET + 2] = RSession::COMMON_PI;
+    s[RSession::SI_OFFSET + 3] = RSession::COMMON_LI;
+    put_be32(s + RSession::SPDU_LENGTH_OFFSET,
+             RSession::APDU_OFFSET + apduLen + RSession::SIGNATURE_SIZE - RSession::SPDU_NUMBER_OFFSET);
+    put_be16(s + RSession::VERSION_OFFSET, RSession::VERSION);
+    put_be32(s + RSession::PAYLOAD_LENGTH_OFFSET, RSession::APDU_OFFSET - RSession::PAYLOAD_TYPE_OFFSET + apduLen);
+    s[RSession::PAYLOAD_TYPE_OFFSET] = (sessionID == RSession::SI_SV) ? RSession::PAYLOAD_SV
+                                                                      : RSession::PAYLOAD_GOOSE;
+    s[RSession::SIMULATION_OFFSET] = 0;
+    put_be16(s + RSession::APPID_OFFSET, appid);
+    put_be16(s + RSession::APDU_LENGTH_OFFSET, apduLen);
+    std::memcpy(s + RSession::APDU_OFFSET, skeleton + l2ApduOffset, apduLen);
+    s[RSession::APDU_OFFSET + apduLen] = RSession::SIGNATURE_TAG;
+    s[RSession::APDU_OFFSET + apduLen + 1] = 0;
+
+    m_udpOffset = l2Len + l3Len;
+    m_cksumOffset = m_udpOffset + offsetof(rte_udp_hdr, dgram_cksum);
+    m_spduNumOffset = sessionOffset + RSession::SPDU_NUMBER_OFFSET;
+    m_varNum = 0;
+
+    m_offload = TxOffload();
+    if (conf.udpCksumOffload) {
+        // NIC expects the pseudo header sum in the UDP checksum
+        m_offload.flags = RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_UDP_CKSUM;
+        m_offload.l2Len = l2Len;
+        m_offload.l3Len = l3Len;
+        udp->dgram_cksum = rte_ipv4_phdr_cksum(ip, m_offload.flags);
+    } else {
+        udp->dgram_cksum = rte_ipv4_udptcp_cksum(ip, udp);
+    }
+
+    std::memcpy(skeleton, frame.data(), newSize);
+    size = newSize;
+    m_enabled = true;
+
+    return (int)(sessionOffset + RSession::APDU_OFFSET) - (int)l2ApduOffset;
+}
+
+void RoutableFrame::AddVarField(uint16_t offset, uint16_t len)
+{
+    if (m_varNum >= MAX_VAR_FIELDS) {
+        throw std::invalid_argument("Too many variable fields of R-GOOSE/R-SV");
+    }
+    m_varFields[m_varNum++] = VarField{ offset, len };
+}
+
+uint16_t RoutableFrame::BaseSum(uint8_t *packet) const
+{
+    std::memset(packet + m_spduNumOffset, 0, 4);
+    for (unsigned i=0;i<m_varNum;++i) {
+        std::memset(packet + m_varFields[i].offset, 0, m_varFields[i].len);
+    }
+    *(uint16_t *)(packet + m_cksumOffset) = 0;
+
+    const rte_ipv4_hdr *ip = (const rte_ipv4_hdr *)(packet + m_udpOffset - sizeof(rte_ipv4_hdr));
+    const rte_udp_hdr *udp = (const rte_udp_hdr *)(packet + m_udpOffset);
+
+    uint32_t sum = rte_ipv4_phdr_cksum(ip, 0);
+    sum += rte_raw_cksum(udp, rte_be_to_cpu_16(udp->dgram_len));
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return sum;
+}
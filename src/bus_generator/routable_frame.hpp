@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/routable_session.hpp"
+
+#include <rte_byteorder.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_udp.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Addressing of R-GOOSE/R-SV: all IEDs of the generator share
+ * the multicast group, so IPv4 header and its checksum are constant
+ */
+struct RoutableConfig
+{
+    uint32_t srcIP = 0x0A000001;    // 10.0.0.1
+    uint32_t dstIP = RSession::DEF_GROUP;
+    uint16_t udpPort = RSession::UDP_PORT;
+    uint8_t  ttl = 16;
+    uint8_t  tos = 0xB8;            // DSCP EF
+    bool     udpCksumOffload = false; // NIC computes UDP checksum
+};
+
+/**
+ * @brief TX offload of the packet: mbufs are reset on allocation, so it's set per packet
+ */
+struct TxOffload
+{
+    uint64_t flags = 0;
+    uint16_t l2Len = 0,
+             l3Len = 0;
+
+    inline void Apply(rte_mbuf *mbuf) const {
+        if (flags != 0) {
+            mbuf->ol_flags |= flags;
+            mbuf->l2_len = l2Len;
+            mbuf->l3_len = l3Len;
+        }
+    }
+};
+
+/**
+ * @class RoutableFrame
+ * @brief L2 GOOSE/SV skeleton -> Ethernet/IPv4/UDP/90-5 session with the same APDU.
+ *
+ * UDP checksum is done by TX offload or incrementally: the sum of constant
+ * bytes is kept per IED, so only variable fields(counters, samples) are summed
+ * for each packet.
+ */
+class RoutableFrame
+{
+public:
+    static const unsigned MAX_VAR_FIELDS = 24;
+
+    bool IsEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Rebuild the skeleton in place, the capacity must fit the new headers
+     * @return The shift of APDU offsets of the L2 skeleton
+     */
+    int Wrap(uint8_t *skeleton, size_t &size, size_t capacity, uint8_t sessionID,
+             const RoutableConfig &conf);
+
+    /**
+     * @brief The field is changed per packet, it isn't included into the base sum
+     */
+    void AddVarField(uint16_t offset, uint16_t len);
+
+    /**
+     * @brief The sum of constant bytes of the stamped packet: UDP pseudo header,
+     * UDP header and payload without variable fields. The packet is modified.
+     */
+    uint16_t BaseSum(uint8_t *packet) const;
+
+    uint16_t GetAppIDOffset() const { return m_udpOffset + sizeof(rte_udp_hdr) + RSession::APPID_OFFSET; }
+    const TxOffload& GetTxOffload() const { return m_offload; }
+
+    /**
+     * @brief SPDU number and UDP checksum, after all fields are written
+     */
+    inline void Finish(uint8_t *packet, uint32_t &spduNum, uint16_t baseSum) const {
+        *(uint32_t *)(packet + m_spduNumOffset) = rte_cpu_to_be_32(spduNum);
+        ++spduNum;
+
+        if (m_offload.flags == 0) {
+            uint32_t sum = baseSum + FieldSum(packet, m_spduNumOffset, 4);
+            for (unsigned i=0;i<m_varNum;++i) {
+                sum += FieldSum(packet, m_varFields[i].offset, m_varFields[i].len);
+            }
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = (sum & 0xFFFF) + (sum >> 16);
+
+            uint16_t cksum = ~sum;
+            *(uint16_t *)(packet + m_cksumOffset) = (cksum == 0) ? 0xFFFF : cksum;
+        }
+    }
+
+private:
+    /**
+     * @brief One's complement sum of the field, bytes at odd offsets of UDP are swapped
+     */
+    inline uint32_t FieldSum(const uint8_t *packet, uint16_t offset, uint16_t len) const {
+        uint16_t sum = rte_raw_cksum(packet + offset, len);
+        return ((offset - m_udpOffset) & 1) ? rte_bswap16(sum) : sum;
+    }
+
+private:
+    struct VarField
+    {
+        uint16_t offset = 0;
+        uint16_t len = 0;
+    };
+
+    bool        m_enabled = false;
+    uint16_t    m_udpOffset = 0;
+    uint16_t    m_cksumOffset = 0;
+    uint16_t    m_spduNumOffset = 0;
+    TxOffload   m_offload;
+
+    VarField    m_varFields[MAX_VAR_FIELDS];
+    unsigned    m_varNum = 0;
+};
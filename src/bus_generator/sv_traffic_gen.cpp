@@ -5,26 +5,29 @@
 
 #include <inttypes.h>
 #include <stdexcept>
+#include <vector>
 
 #define PLACEHOLDER             "1234"
 const char *SVID_PATTERN = "SVID" PLACEHOLDER;
 
-SVTrafficGen::SVTrafficGen(unsigned num, SV_TYPE type) : m_ieds(num)
+SVTrafficGen::SVTrafficGen(unsigned num, SV_TYPE type, unsigned firstIED, SVWaveform::ptr wave)
+    : m_ieds(num), m_wave(wave), m_firstIED(firstIED)
 {
     for (size_t i=0;i<m_ieds.size();++i) {
-        InitIED(m_ieds[i], i + 1);
+        InitIED(m_ieds[i], m_firstIED + i + 1);
     }
 
     switch (type) {
     case SV80: {
-        m_freq = 4000;
+        m_freq = SV80_SAMPLE_RATE;
         MakeSkeletonSV80();
         m_units = CreateTxUnits(m_freq);
         break;
     }
     case SV256: {
-        m_freq = 12800;
+        m_freq = SV256_SAMPLE_RATE;
         MakeSkeletonSV256();
+        m_asduNum = MAX_SV_ASDU_NUM;
         m_units = CreateTxUnits(m_freq / MAX_SV_ASDU_NUM);
         break;
     }
@@ -32,6 +35,14 @@ SVTrafficGen::SVTrafficGen(unsigned num, SV_TYPE type) : m_ieds(num)
         throw std::invalid_argument("Unknown SV type");
     }
     }
+
+    if (!m_wave) {
+        m_wave = SVWaveform::Synthesize(SVWaveformConfig(), m_freq);
+    }
+    if (m_wave->GetRowNum() == 0) {
+        throw std::invalid_argument("SV waveform is empty");
+    }
+    m_waveRowNum = m_wave->GetRowNum();
 }
 
 void SVTrafficGen::InitIED(SVSourceIED &ied, unsigned idx)
@@ -120,35 +131,30 @@ void SVTrafficGen::MakeSkeletonSV256()
 
 SVTrafficGen::TxUnitArray SVTrafficGen::CreateTxUnits(int pps)
 {
-    std::vector< SVTrafficGen::TxSVUnit > units;
-
     const unsigned BUNCH_SIZE = 64;
-    units.reserve(pps);
-    for (size_t i=0;i<pps;i++) {
-        TxSVUnit unit;
-        unit.offsetUS = 1'000'000 / pps * i;
-
-        const unsigned BLK_PER_UNIT = m_ieds.size() / BUNCH_SIZE;
-        const unsigned LAST_BLK_SIZE = m_ieds.size() % BUNCH_SIZE;
-        unit.blocks.resize(BLK_PER_UNIT + (LAST_BLK_SIZE > 0 ? 1 : 0));
-
-        unsigned iedIndex = 0;
-        for (size_t j=0;j<BLK_PER_UNIT;++j) {
-            TxSVUnit::BlockType &blk = unit.blocks[j];
-            blk.packets.resize(BUNCH_SIZE);
-            for (auto &desc : blk.packets) {
-                desc.idx = iedIndex++;
-            }
-        }
-        if (LAST_BLK_SIZE > 0) {
-            TxSVUnit::BlockType &blk = unit.blocks.back();
-            blk.packets.resize(LAST_BLK_SIZE);
-            for (auto &desc : blk.packets) {
-                desc.idx = iedIndex++;
-            }
+    return TxUnitArray(pps, m_ieds.size(), BUNCH_SIZE);
+}
+
+void SVTrafficGen::MakeRoutable(const RoutableConfig &conf)
+{
+    int shift = m_routable.Wrap(m_skeleton, m_skeletonSize, sizeof(m_skeleton), RSession::SI_SV, conf);
+    m_appidOffset = m_routable.GetAppIDOffset();
+    for (unsigned i=0;i<m_asduNum;++i) {
+        for (int j=0;j<SV_ASDU_OFFSET_NUM;++j) {
+            m_asduOffs[i][j] += shift;
         }
+        m_routable.AddVarField(m_asduOffs[i][SV_SMP_CNT_OFFSET], 2);
+        m_routable.AddVarField(m_asduOffs[i][SV_DATA_OFFSET], sizeof(SVSampleRow::data));
+    }
 
-        units.push_back(std::move(unit));
+    // Constant bytes of each IED: identity is stamped, variable fields are zero
+    std::vector< uint8_t > packet(m_skeleton, m_skeleton + m_skeletonSize);
+    for (size_t i=0;i<m_ieds.size();++i) {
+        if (m_asduNum == 1) {
+            StampIdentitySV80(packet.data(), i);
+        } else {
+            StampIdentitySV256(packet.data(), i);
+        }
+        m_ieds[i].udpBaseSum = m_routable.BaseSum(packet.data());
     }
-    return std::move(units);
 }
@@ -1,11 +1,18 @@
 #pragma once
 
-#include "tx_unit.hpp"
+#include "tx_schedule.hpp"
+#include "sv_waveform.hpp"
+#include "routable_frame.hpp"
 #include "rte_byteorder.h"
 
+#include <vector>
+
 #define MAX_SV_PACKET_SIZE      1518
 #define MAX_SV_ASDU_NUM         8
 
+const unsigned SV80_SAMPLE_RATE = 4000;
+const unsigned SV256_SAMPLE_RATE = 12800;
+
 enum SV_ASDU_OFFSETS
 {
     SV_SVID_OFFSET = 0,
@@ -20,6 +27,11 @@ struct SVSourceIED
     char sID[4 + 1] = { 0 }; // Is used in Patterns
 
     uint16_t smpCnt = 0;
+    uint32_t wavePos = 0; // The row of the waveform
+
+    // R-SV
+    uint32_t spduNum = 0;
+    uint16_t udpBaseSum = 0; // UDP checksum of constant bytes
 };
 
 struct SVPacketDesc
@@ -41,54 +53,114 @@ class SVTrafficGen
 {
 public:
     using Desc = SVPacketDesc;
-    using TxSVUnit = TxUnit< SVPacketDesc >;
-    using TxUnitArray = std::vector< SVTrafficGen::TxSVUnit >;
-    SVTrafficGen(unsigned num, SV_TYPE type);
+    using TxUnitArray = TxSchedule< SVPacketDesc >;
+    using TxSVUnit = TxUnitArray::Unit;
+    /**
+     * @param firstIED The index of the first IED, when IEDs are shared among generators
+     * @param wave Samples of the dataset, nominal 50 Hz if it isn't set
+     */
+    SVTrafficGen(unsigned num, SV_TYPE type, unsigned firstIED = 0, SVWaveform::ptr wave = nullptr);
+
+    static unsigned GetSampleRate(SV_TYPE type) {
+        return (type == SV256) ? SV256_SAMPLE_RATE : SV80_SAMPLE_RATE;
+    }
 
-    inline size_t AmendPacketSV80(uint8_t *packet, const SVPacketDesc &desc) {
-        SVSourceIED &ied = m_ieds[desc.idx];
+    /**
+     * @brief Fields which never change for the IED: APPID, svID
+     */
+    inline void StampIdentitySV80(uint8_t *packet, unsigned idx) {
+        SVSourceIED &ied = m_ieds[idx];
 
-        *(uint16_t *)(packet + m_appidOffset) = RTE_STATIC_BSWAP16((desc.idx + 1) & 0xFFFF);
+        *(uint16_t *)(packet + m_appidOffset) = RTE_STATIC_BSWAP16((m_firstIED + idx + 1) & 0xFFFF);
         *(uint32_t *)(packet + m_asduOffs[0][SV_SVID_OFFSET] + 4) = *(uint32_t *)ied.sID;
+    }
+
+    inline size_t AmendCountersSV80(uint8_t *packet, const SVPacketDesc &desc) {
+        SVSourceIED &ied = m_ieds[desc.idx];
+
         *(uint16_t *)(packet + m_asduOffs[0][SV_SMP_CNT_OFFSET]) = RTE_STATIC_BSWAP16(ied.smpCnt);
+        NextSample(packet + m_asduOffs[0][SV_DATA_OFFSET], ied);
 
         ied.smpCnt = (ied.smpCnt + 1 < m_freq) ? (ied.smpCnt + 1) : 0;
+
+        if (m_routable.IsEnabled()) {
+            m_routable.Finish(packet, ied.spduNum, ied.udpBaseSum);
+        }
         return m_skeletonSize;
     }
 
-    inline size_t AmendPacketSV256(uint8_t *packet, const SVPacketDesc &desc) {
-        SVSourceIED &ied = m_ieds[desc.idx];
+    inline size_t AmendPacketSV80(uint8_t *packet, const SVPacketDesc &desc) {
+        StampIdentitySV80(packet, desc.idx);
+        return AmendCountersSV80(packet, desc);
+    }
 
-        *(uint16_t *)(packet + m_appidOffset) = RTE_STATIC_BSWAP16((desc.idx + 1) & 0xFFFF);
+    inline void StampIdentitySV256(uint8_t *packet, unsigned idx) {
+        SVSourceIED &ied = m_ieds[idx];
+
+        *(uint16_t *)(packet + m_appidOffset) = RTE_STATIC_BSWAP16((m_firstIED + idx + 1) & 0xFFFF);
         for (int i=0;i<MAX_SV_ASDU_NUM;++i) {
             *(uint32_t *)(packet + m_asduOffs[i][SV_SVID_OFFSET] + 4) = *(uint32_t *)ied.sID;
+        }
+    }
+
+    inline size_t AmendCountersSV256(uint8_t *packet, const SVPacketDesc &desc) {
+        SVSourceIED &ied = m_ieds[desc.idx];
+
+        for (int i=0;i<MAX_SV_ASDU_NUM;++i) {
             *(uint16_t *)(packet + m_asduOffs[i][SV_SMP_CNT_OFFSET]) = RTE_STATIC_BSWAP16(ied.smpCnt);
+            NextSample(packet + m_asduOffs[i][SV_DATA_OFFSET], ied);
 
             ied.smpCnt = (ied.smpCnt + 1 < m_freq) ? (ied.smpCnt + 1) : 0;
         }
 
+        if (m_routable.IsEnabled()) {
+            m_routable.Finish(packet, ied.spduNum, ied.udpBaseSum);
+        }
         return m_skeletonSize;
     }
 
+    inline size_t AmendPacketSV256(uint8_t *packet, const SVPacketDesc &desc) {
+        StampIdentitySV256(packet, desc.idx);
+        return AmendCountersSV256(packet, desc);
+    }
+
+    /**
+     * @brief R-SV: the skeleton is wrapped into IPv4/UDP/session, offsets are moved
+     */
+    void        MakeRoutable(const RoutableConfig &conf);
+    const TxOffload& GetTxOffload() const { return m_routable.GetTxOffload(); }
+
+    size_t      GetIEDNum() const { return m_ieds.size(); }
     size_t      GetSkeletonSize() const { return m_skeletonSize; }
     uint8_t*    GetSkeletonBuffer() { return m_skeleton; }
 
     SVTrafficGen::TxUnitArray& GetTxUnits() { return m_units; }   
 
 private:
+    inline void NextSample(uint8_t *data, SVSourceIED &ied) {
+        SVWaveform::CopyRow(data, m_wave->GetRow(ied.wavePos));
+        ied.wavePos = (ied.wavePos + 1 < m_waveRowNum) ? (ied.wavePos + 1) : 0;
+    }
+
     void InitIED(SVSourceIED &ied, unsigned idx);
     void MakeSkeletonSV80();
     void MakeSkeletonSV256();
-    std::vector< SVTrafficGen::TxSVUnit > CreateTxUnits(int pps);
+    SVTrafficGen::TxUnitArray CreateTxUnits(int pps);
 
 private:
     std::vector< SVSourceIED >  m_ieds; // 1 SV <-> 1 IED
     SVTrafficGen::TxUnitArray   m_units; // TX moments with {blocks}
+    SVWaveform::ptr             m_wave;  // Shared by the generators of a type
+    uint32_t                    m_waveRowNum = 1;
 
     uint16_t    m_appidOffset = 0; // One for the whole packet
     uint16_t    m_asduOffs[MAX_SV_ASDU_NUM][SV_ASDU_OFFSET_NUM] = { 0 };
     uint8_t     m_skeleton[MAX_SV_PACKET_SIZE] = { 0 };
     size_t      m_skeletonSize = 0;
     unsigned    m_freq = 1;
+    unsigned    m_firstIED = 0;
+    unsigned    m_asduNum = 1;
+
+    RoutableFrame m_routable;
 };
 
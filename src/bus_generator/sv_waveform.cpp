@@ -0,0 +1,173 @@
+#include "sv_waveform.hpp"
+#include "comtrade.hpp"
+
+#include <rte_byteorder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+static const double PHASE_SHIFT[3] = { 0.0, -2.0 * M_PI / 3.0, 2.0 * M_PI / 3.0 };
+
+static int32_t to_lsb(double value, double lsb)
+{
+    double x = std::round(value / lsb);
+    x = std::clamp(x, (double)INT32_MIN, (double)INT32_MAX);
+    return (int32_t)x;
+}
+
+void SVWaveform::SetSample(size_t idx, const double (&values)[SV_CHANNEL_NUM])
+{
+    uint32_t *row = (uint32_t *)m_rows[idx].data;
+    for (unsigned ch=0;ch<SV_CHANNEL_NUM;++ch) {
+        double lsb = (ch < SV_CHANNEL_NUM / 2) ? SV_CURRENT_LSB : SV_VOLTAGE_LSB;
+        row[2 * ch] = rte_cpu_to_be_32((uint32_t)to_lsb(values[ch], lsb));
+        row[2 * ch + 1] = 0; // Quality: good
+    }
+}
+
+int32_t SVWaveform::GetValue(size_t idx, unsigned channel) const
+{
+    const uint32_t *row = (const uint32_t *)m_rows[idx].data;
+    return (int32_t)rte_be_to_cpu_32(row[2 * channel]);
+}
+
+SVWaveform::ptr SVWaveform::Synthesize(const SVWaveformConfig &conf, unsigned sampleRate)
+{
+    if (conf.freqHz <= 0.0 || conf.durationSec <= 0.0 || sampleRate == 0) {
+        throw std::invalid_argument("SV waveform: frequency, duration and sample rate must be positive");
+    }
+
+    size_t rowNum = std::max< size_t >(1, std::llround(conf.durationSec * sampleRate));
+    std::shared_ptr< SVWaveform > wave(new SVWaveform(rowNum));
+
+    bool faulted[3] = { false };
+    for (char ph : conf.faultPhases) {
+        unsigned p = toupper(ph) - 'A';
+        if (p < 3) {
+            faulted[p] = true;
+        }
+    }
+
+    const double w = 2.0 * M_PI * conf.freqHz;
+    const double faultSec = conf.faultMS / 1'000.0;
+    const double tauSec = conf.dcTauMS / 1'000.0;
+    for (size_t n=0;n<rowNum;++n) {
+        const double t = (double)n / sampleRate;
+        const bool fault = (conf.faultMS >= 0.0) && (t >= faultSec);
+
+        double values[SV_CHANNEL_NUM] = { 0.0 };
+        for (unsigned p=0;p<3;++p) {
+            const double angle = w * t + PHASE_SHIFT[p];
+            double shape = std::sin(angle);
+            for (const auto &[order, perc] : conf.harmonics) {
+                shape += perc / 100.0 * std::sin(order * angle);
+            }
+
+            double iAmp = conf.currentA * M_SQRT2;
+            double uAmp = conf.voltageV * M_SQRT2;
+            double dc = 0.0;
+            if (fault && faulted[p]) {
+                iAmp *= conf.faultCurrentMult;
+                uAmp *= conf.faultVoltageMult;
+                if (tauSec > 0.0) {
+                    // The offset cancels the AC step at the inception
+                    dc = -iAmp * std::sin(w * faultSec + PHASE_SHIFT[p]) * std::exp(-(t - faultSec) / tauSec);
+                }
+            }
+
+            values[p] = iAmp * shape + dc;
+            values[4 + p] = uAmp * shape;
+        }
+        values[3] = values[0] + values[1] + values[2];
+        values[7] = values[4] + values[5] + values[6];
+
+        wave->SetSample(n, values);
+    }
+
+    return wave;
+}
+
+SVWaveform::ptr SVWaveform::FromComtrade(const ComtradeRecord &rec, unsigned sampleRate)
+{
+    if (sampleRate == 0 || rec.GetSampleNum() == 0) {
+        throw std::invalid_argument("SV waveform: COMTRADE record is empty");
+    }
+
+    // SV channel -> record channel, with the scale to A or V
+    int map[SV_CHANNEL_NUM];
+    double scale[SV_CHANNEL_NUM];
+    std::fill(std::begin(map), std::end(map), -1);
+    std::fill(std::begin(scale), std::end(scale), 1.0);
+
+    const auto &channels = rec.GetChannels();
+    for (size_t i=0;i<channels.size();++i) {
+        std::string unit = channels[i].unit;
+        std::transform(unit.begin(), unit.end(), unit.begin(), ::toupper);
+
+        double mult = 1.0;
+        if (unit.size() == 2 && unit[0] == 'K') {
+            mult = 1'000.0;
+            unit.erase(0, 1);
+        }
+        if (unit != "A" && unit != "V") {
+            continue;
+        }
+
+        const char ph = channels[i].phase.empty() ? 0 : toupper(channels[i].phase.back());
+        const char *PHASES = "ABCN";
+        const char *pos = (ph != 0) ? strchr(PHASES, ph) : nullptr;
+        if (pos == nullptr) {
+            continue;
+        }
+
+        unsigned ch = (unit == "V" ? 4 : 0) + (pos - PHASES);
+        if (map[ch] < 0) {
+            map[ch] = i;
+            scale[ch] = mult;
+            if (channels[i].ps == 'S' && channels[i].secondary != 0.0) {
+                scale[ch] *= channels[i].primary / channels[i].secondary;
+            }
+        }
+    }
+    if (std::all_of(std::begin(map), std::end(map), [](int m) { return m < 0; })) {
+        throw std::invalid_argument("SV waveform: COMTRADE has no phase currents or voltages");
+    }
+
+    const double firstUS = rec.GetTimeUS(0);
+    const double lastUS = rec.GetTimeUS(rec.GetSampleNum() - 1);
+    size_t rowNum = (size_t)((lastUS - firstUS) * sampleRate / 1e6) + 1;
+    std::shared_ptr< SVWaveform > wave(new SVWaveform(rowNum));
+
+    // Linear interpolation between the samples of the record
+    size_t k = 0;
+    for (size_t n=0;n<rowNum;++n) {
+        const double t = firstUS + n * 1e6 / sampleRate;
+        while (k + 2 < rec.GetSampleNum() && rec.GetTimeUS(k + 1) <= t) {
+            ++k;
+        }
+        const size_t k1 = std::min(k + 1, rec.GetSampleNum() - 1);
+        const double span = rec.GetTimeUS(k1) - rec.GetTimeUS(k);
+        const double frac = (span > 0.0) ? std::clamp((t - rec.GetTimeUS(k)) / span, 0.0, 1.0) : 0.0;
+
+        double values[SV_CHANNEL_NUM] = { 0.0 };
+        for (unsigned ch=0;ch<SV_CHANNEL_NUM;++ch) {
+            if (map[ch] >= 0) {
+                double v0 = rec.GetValue(map[ch], k), v1 = rec.GetValue(map[ch], k1);
+                values[ch] = (v0 + (v1 - v0) * frac) * scale[ch];
+            }
+        }
+        // Neutrals are the sums if the record doesn't have them
+        if (map[3] < 0) {
+            values[3] = values[0] + values[1] + values[2];
+        }
+        if (map[7] < 0) {
+            values[7] = values[4] + values[5] + values[6];
+        }
+
+        wave->SetSample(n, values);
+    }
+
+    return wave;
+}
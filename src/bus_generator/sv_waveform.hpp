@@ -0,0 +1,83 @@
+#pragma once
+
+#include <rte_memcpy.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ComtradeRecord;
+
+// 9-2LE dataset: Ia, Ib, Ic, In, Ua, Ub, Uc, Un - INT32 + Quality each
+const unsigned SV_CHANNEL_NUM = 8;
+const double   SV_CURRENT_LSB = 0.001; // 1 mA
+const double   SV_VOLTAGE_LSB = 0.01;  // 10 mV
+
+/**
+ * @brief Samples of one smpCnt as they're in the ASDU: network order
+ */
+struct alignas(64) SVSampleRow
+{
+    uint8_t data[SV_CHANNEL_NUM * 8];
+};
+
+/**
+ * @brief 3-phase waveform: nominal values, harmonics and a fault at faultMS
+ * which lasts until the end of the waveform. The waveform repeats each
+ * durationSec, so the whole number of periods gives a seamless loop.
+ */
+struct SVWaveformConfig
+{
+    double      freqHz = 50.0;
+    double      currentA = 100.0;      // Phase current, rms
+    double      voltageV = 63'500.0;   // Phase voltage, rms
+    double      durationSec = 1.0;
+
+    // {order, % of fundamental}
+    std::vector< std::pair< unsigned, double > > harmonics;
+
+    double      faultMS = -1.0;        // No fault if < 0
+    std::string faultPhases = "A";
+    double      faultCurrentMult = 10.0;
+    double      faultVoltageMult = 0.3;
+    double      dcTauMS = 0.0;         // Decaying DC of fault currents, none if 0
+};
+
+/**
+ * @class SVWaveform
+ * @brief Precomputed sample rows: the generator only copies 64 bytes
+ * by SIMD per ASDU, no math on the TX path.
+ */
+class SVWaveform
+{
+public:
+    using ptr = std::shared_ptr< const SVWaveform >;
+
+    static ptr Synthesize(const SVWaveformConfig &conf, unsigned sampleRate);
+    /**
+     * @brief Channels are mapped by phase(A/B/C/N) and unit(A/V/kV),
+     * the record is resampled to sampleRate
+     */
+    static ptr FromComtrade(const ComtradeRecord &rec, unsigned sampleRate);
+
+    size_t GetRowNum() const { return m_rows.size(); }
+    const SVSampleRow& GetRow(size_t idx) const { return m_rows[idx]; }
+
+    /**
+     * @brief Decoded value of the row in LSBs, mostly for tests
+     */
+    int32_t GetValue(size_t idx, unsigned channel) const;
+
+    static inline void CopyRow(uint8_t *dst, const SVSampleRow &row) {
+        rte_mov64(dst, row.data);
+    }
+
+private:
+    explicit SVWaveform(size_t rowNum) : m_rows(rowNum) {}
+
+    void SetSample(size_t idx, const double (&values)[SV_CHANNEL_NUM]);
+
+private:
+    std::vector< SVSampleRow > m_rows;
+};
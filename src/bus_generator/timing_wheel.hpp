@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel of entries [0, entryNum): Schedule,
+ * Cancel and expiring are O(1) per entry. Entries are intrusive lists over
+ * indices, so nothing is allocated after the construction.
+ *
+ * Level L has SLOT_NUM slots of SLOT_NUM^L ticks, an entry of a higher level
+ * is cascaded down when the wheel reaches its slot.
+ */
+template< unsigned LEVEL_NUM = 3, unsigned SLOT_BITS = 8 >
+class TimingWheel
+{
+public:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr unsigned SLOT_NUM = 1U << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOT_NUM - 1;
+    static constexpr uint64_t MAX_DELAY = (1ULL << (SLOT_BITS * LEVEL_NUM)) - 1;
+
+    explicit TimingWheel(size_t entryNum) : m_entries(entryNum)
+    {
+        for (auto &level : m_heads) {
+            std::fill(std::begin(level), std::end(level), NIL);
+        }
+    }
+
+    /**
+     * @brief Expire the entry in delay ticks: 1..MAX_DELAY, it's rescheduled if it's already in the wheel
+     */
+    void Schedule(uint32_t id, uint64_t delay) {
+        Cancel(id);
+        m_entries[id].expire = m_now + std::clamp< uint64_t >(delay, 1, MAX_DELAY);
+        Link(id);
+    }
+
+    void Cancel(uint32_t id) {
+        if (m_entries[id].level != NO_LEVEL) {
+            Unlink(id);
+        }
+    }
+
+    bool        IsScheduled(uint32_t id) const { return m_entries[id].level != NO_LEVEL; }
+    uint64_t    GetNow() const { return m_now; }
+    size_t      GetEntryNum() const { return m_entries.size(); }
+
+    /**
+     * @brief Entries which are in the first level for the next tick, entries
+     * cascaded at the next tick aren't counted yet
+     */
+    size_t      GetDueNum() const { return m_slotSize[(m_now + 1) & SLOT_MASK]; }
+
+    /**
+     * @brief Move by one tick, onExpire(id) is called for each expired entry.
+     * The entry is out of the wheel in the callback, so it can be scheduled again
+     * with a delay of 1 tick or more.
+     */
+    template< typename TExpire >
+    void Advance(TExpire &&onExpire) {
+        ++m_now;
+
+        // Higher levels first: their entries may go to a lower level cascaded at the same tick
+        unsigned top = 0;
+        while (top + 1 < LEVEL_NUM && (m_now & ((1ULL << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (unsigned lvl=top;lvl>0;--lvl) {
+            const unsigned slot = (m_now >> (SLOT_BITS * lvl)) & SLOT_MASK;
+            for (uint32_t id=m_heads[lvl][slot];id!=NIL;id=m_heads[lvl][slot]) {
+                Unlink(id);
+                Link(id);
+            }
+        }
+
+        // The head is taken each time: the callback may schedule or cancel any entry
+        const unsigned slot = m_now & SLOT_MASK;
+        for (uint32_t id=m_heads[0][slot];id!=NIL;id=m_heads[0][slot]) {
+            Unlink(id);
+            onExpire(id);
+        }
+    }
+
+private:
+    static constexpr uint8_t NO_LEVEL = 0xFF;
+
+    struct Entry
+    {
+        uint64_t expire = 0;
+        uint32_t prev = NIL,
+                 next = NIL;
+        uint8_t  level = NO_LEVEL;
+        uint16_t slot = 0;
+    };
+
+    void Link(uint32_t id) {
+        Entry &e = m_entries[id];
+        const uint64_t delta = (e.expire > m_now) ? (e.expire - m_now) : 0;
+
+        unsigned lvl = 0;
+        while (lvl + 1 < LEVEL_NUM && delta >= (1ULL << (SLOT_BITS * (lvl + 1)))) {
+            ++lvl;
+        }
+        // Overdue entries of a cascade expire at the current tick
+        const uint64_t at = (delta == 0) ? m_now : e.expire;
+
+        e.level = lvl;
+        e.slot = (at >> (SLOT_BITS * lvl)) & SLOT_MASK;
+        e.prev = NIL;
+        e.next = m_heads[lvl][e.slot];
+        if (e.next != NIL) {
+            m_entries[e.next].prev = id;
+        }
+        m_heads[lvl][e.slot] = id;
+        if (lvl == 0) {
+            ++m_slotSize[e.slot];
+        }
+    }
+
+    void Unlink(uint32_t id) {
+        Entry &e = m_entries[id];
+        if (e.prev != NIL) {
+            m_entries[e.prev].next = e.next;
+        } else {
+            m_heads[e.level][e.slot] = e.next;
+        }
+        if (e.next != NIL) {
+            m_entries[e.next].prev = e.prev;
+        }
+        if (e.level == 0) {
+            --m_slotSize[e.slot];
+        }
+        e.level = NO_LEVEL;
+        e.prev = e.next = NIL;
+    }
+
+private:
+    std::vector< Entry >    m_entries;
+    uint32_t                m_heads[LEVEL_NUM][SLOT_NUM];
+    uint32_t                m_slotSize[SLOT_NUM] = { 0 }; // The first level only
+    uint64_t                m_now = 0;
+};
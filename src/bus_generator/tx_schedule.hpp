@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+/**
+ * @brief Random access over an indexed view: *it is owner[idx], by value
+ */
+template< typename TOwner, typename TValue >
+class TxIndexIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = TValue;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = TValue;
+
+    TxIndexIterator(const TOwner *owner, size_t idx) : m_owner(owner), m_idx(idx) {}
+
+    TValue operator*() const { return (*m_owner)[m_idx]; }
+    TxIndexIterator& operator++() { ++m_idx; return *this; }
+    TxIndexIterator operator++(int) { TxIndexIterator tmp = *this; ++m_idx; return tmp; }
+
+    bool operator==(const TxIndexIterator &other) const { return m_idx == other.m_idx; }
+    bool operator!=(const TxIndexIterator &other) const { return m_idx != other.m_idx; }
+
+private:
+    const TOwner*   m_owner = nullptr;
+    size_t          m_idx = 0;
+};
+
+/**
+ * @class TxSchedule
+ * @brief TX moments of a second: unitNum units are evenly spaced and each
+ * one sends all IEDs [0, iedNum) in blocks of blockSize. Nothing is
+ * materialized: units, blocks and descriptors are computed by index.
+ *
+ * Views keep the shape of TX units: unit.blocks[i].packets[j] is a descriptor.
+ */
+template< typename TDesc >
+class TxSchedule
+{
+public:
+    /**
+     * @brief IED descriptors [first, first + num)
+     */
+    struct Packets
+    {
+        unsigned first = 0;
+        unsigned num = 0;
+
+        size_t size() const { return num; }
+        bool   empty() const { return num == 0; }
+        TDesc  operator[](size_t i) const { return TDesc{ (unsigned)(first + i) }; }
+
+        TxIndexIterator< Packets, TDesc > begin() const { return { this, 0 }; }
+        TxIndexIterator< Packets, TDesc > end() const { return { this, num }; }
+    };
+
+    struct Block
+    {
+        Packets packets;
+    };
+
+    struct Blocks
+    {
+        unsigned iedNum = 0;
+        unsigned blockSize = 1;
+
+        size_t size() const { return (iedNum + blockSize - 1) / blockSize; }
+        bool   empty() const { return iedNum == 0; }
+        Block  operator[](size_t i) const {
+            unsigned first = i * blockSize;
+            unsigned num = (iedNum - first < blockSize) ? (iedNum - first) : blockSize;
+            return Block{ Packets{ first, num } };
+        }
+
+        TxIndexIterator< Blocks, Block > begin() const { return { this, 0 }; }
+        TxIndexIterator< Blocks, Block > end() const { return { this, size() }; }
+    };
+
+    struct Unit
+    {
+        uint64_t offsetUS = 0; // Timestamp
+        uint64_t offsetNS = 0; // Exact timestamp, offsetUS is rounded down from it
+
+        Blocks   blocks;
+
+        size_t GetPacketNum() const { return blocks.iedNum; }
+    };
+
+    TxSchedule() = default;
+    TxSchedule(unsigned unitNum, unsigned iedNum, unsigned blockSize)
+        : m_unitNum(unitNum), m_iedNum(iedNum), m_blockSize(blockSize ? blockSize : 1)
+    {}
+
+    size_t size() const { return m_unitNum; }
+    bool   empty() const { return m_unitNum == 0; }
+
+    Unit operator[](size_t idx) const {
+        Unit unit;
+        // No rounding is accumulated along the second
+        unit.offsetNS = 1'000'000'000ULL * idx / m_unitNum;
+        unit.offsetUS = unit.offsetNS / 1'000;
+        unit.blocks = Blocks{ m_iedNum, m_blockSize };
+        return unit;
+    }
+
+    Unit front() const { return (*this)[0]; }
+
+    TxIndexIterator< TxSchedule, Unit > begin() const { return { this, 0 }; }
+    TxIndexIterator< TxSchedule, Unit > end() const { return { this, m_unitNum }; }
+
+private:
+    unsigned m_unitNum = 0;
+    unsigned m_iedNum = 0;
+    unsigned m_blockSize = 1;
+};
@@ -0,0 +1,424 @@
+#pragma once
+
+#include "gen_application.hpp"
+#include "prp_tagger.hpp"
+#include "dpdk_cpp/dpdk_clocks_class.hpp"
+#include "dpdk_cpp/dpdk_nicclock_class.hpp"
+
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_mempool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+const unsigned TX_BURST_SIZE = 32;
+
+/**
+ * @class TxPacer
+ * @brief CPU pacing without spinning inside a unit: packets wait here with
+ * their TX ticks, the timeline sends them when they are due, so the units of
+ * other sources on the lcore aren't held back. Min-heap by tick: PRP copies
+ * are pushed after their burst but go at the same moments.
+ */
+class TxPacer
+{
+public:
+    TxPacer() = default;
+    TxPacer(const TxPacer&) = delete;
+    TxPacer& operator=(const TxPacer&) = delete;
+
+    ~TxPacer() {
+        for (const Paced &p : m_heap) {
+            rte_pktmbuf_free(p.m);
+        }
+    }
+
+    inline void Push(uint64_t tick, rte_mbuf *m) {
+        m_heap.push_back(Paced{ tick, m });
+        std::push_heap(m_heap.begin(), m_heap.end());
+    }
+
+    inline bool IsEmpty() const { return m_heap.empty(); }
+    inline uint64_t GetNextTick() const { return m_heap.front().tick; }
+
+    /**
+     * @brief Packets due by now go in one burst, unsent ones are send errors
+     */
+    inline void Send(uint16_t portID, uint16_t queueID, uint64_t now, unsigned &errSendCnt) {
+        rte_mbuf* mbufs[TX_BURST_SIZE];
+        unsigned num = 0;
+        while (num < TX_BURST_SIZE && !m_heap.empty() && m_heap.front().tick <= now) {
+            mbufs[num++] = m_heap.front().m;
+            std::pop_heap(m_heap.begin(), m_heap.end());
+            m_heap.pop_back();
+        }
+        uint16_t nb_tx = rte_eth_tx_burst(portID, queueID, mbufs, num);
+        if (nb_tx < num) {
+            rte_pktmbuf_free_bulk(mbufs + nb_tx, num - nb_tx);
+            errSendCnt += num - nb_tx;
+        }
+    }
+
+private:
+    struct Paced
+    {
+        uint64_t    tick = 0;
+        rte_mbuf*   m = nullptr;
+
+        // The earliest is on the top
+        bool operator<(const Paced &other) const { return tick > other.tick; }
+    };
+
+    std::vector< Paced > m_heap;    // Keeps its capacity, so no allocations after warm-up
+};
+
+/**
+ * @brief How the packets of a TxUnit leave the port
+ */
+struct TxContext
+{
+    uint16_t    portID = 0;
+    uint16_t    queueID = 0;
+
+    uint64_t    unitTick = 0;   // The scheduled tick of the unit
+    uint64_t    gapTicks = 0;   // Spacing of packets inside the unit, 0 is a burst
+
+    // CPU pacing: packets wait for the timeline here
+    TxPacer*    pacer = nullptr;
+
+    // SEND_ON_TIMESTAMP: NIC paces packets instead of the CPU
+    const DPDK::NicClock*   nicClock = nullptr;
+    int                     tsOffset = -1;
+    uint64_t                tsFlag = 0;
+};
+
+/**
+ * @class TxSource
+ * @brief Traffic of one generator in the TX timeline. The timeline calls
+ * the source once per TxUnit, so a virtual call isn't on the per-packet path.
+ */
+class TxSource
+{
+public:
+    using ptr = std::unique_ptr< TxSource >;
+    virtual ~TxSource() = default;
+
+    virtual const char* GetName() const = 0;
+
+    virtual size_t      GetUnitNum() const = 0;
+    virtual uint64_t    GetUnitOffsetTicks(size_t idx) const = 0;
+    virtual size_t      GetUnitPacketNum(size_t idx) const = 0;
+
+    virtual void        SendUnit(size_t idx, const TxContext &ctx, GenAppStat &stat) = 0;
+
+    /**
+     * @brief PRP duplicates of IEDs [firstIED, firstIED + iedNum), copies are taken from the pool
+     */
+    void EnablePrp(uint8_t stream, unsigned firstIED, size_t iedNum, rte_mempool *pool) {
+        m_prp = PrpTagger(stream, firstIED, iedNum, pool);
+    }
+
+    TxPacer& GetPacer() { return m_pacer; }
+
+protected:
+    PrpTagger   m_prp;
+    TxPacer     m_pacer;
+};
+
+/**
+ * @brief Burst as is, by NIC's timestamps or queued to the pacer of the CPU
+ * @param pktIdx The index of the first packet inside the unit
+ * @return The number of sent(or queued) packets
+ */
+inline uint16_t tx_transmit(const TxContext &ctx, rte_mbuf **mbufs, unsigned num, uint64_t pktIdx)
+{
+    if (ctx.tsOffset >= 0) {
+        for (unsigned i=0;i<num;++i) {
+            uint64_t tick = ctx.unitTick + (pktIdx + i) * ctx.gapTicks;
+            *RTE_MBUF_DYNFIELD(mbufs[i], ctx.tsOffset, uint64_t *) = ctx.nicClock->ToNic(tick);
+            mbufs[i]->ol_flags |= ctx.tsFlag;
+        }
+    } else if (ctx.gapTicks > 0 && ctx.pacer != nullptr) {
+        for (unsigned i=0;i<num;++i) {
+            ctx.pacer->Push(ctx.unitTick + (pktIdx + i) * ctx.gapTicks, mbufs[i]);
+        }
+        return num;
+    }
+    return rte_eth_tx_burst(ctx.portID, ctx.queueID, mbufs, num);
+}
+
+/**
+ * @brief PRP: LAN B copies of the packets which are about to be sent
+ * @return The number of copies, failed ones are send errors
+ */
+inline unsigned prp_duplicate(PrpTagger &prp, rte_mbuf **mbufs, unsigned num, rte_mbuf **copies,
+                              GenAppStat &stat)
+{
+    if (!prp.IsEnabled() || num == 0) {
+        return 0;
+    }
+    unsigned copyNum = prp.Duplicate(mbufs, num, copies);
+    stat.errSendCnt += num - copyNum;
+    return copyNum;
+}
+
+/**
+ * @brief PRP: LAN B copies follow the packets of LAN A at the same moments
+ */
+inline void prp_transmit(const TxContext &ctx, rte_mbuf **copies, unsigned num, uint64_t pktIdx,
+                         GenAppStat &stat)
+{
+    if (num == 0) {
+        return;
+    }
+    uint16_t nb_tx = tx_transmit(ctx, copies, num, pktIdx);
+    if (nb_tx < num) {
+        rte_pktmbuf_free_bulk(copies + nb_tx, num - nb_tx);
+        stat.errSendCnt += num - nb_tx;
+    }
+}
+
+/**
+ * @class TxGenSourceBase
+ * @brief Timing of GooseTrafficGen/SVTrafficGen units, mbufs are taken from
+ * the pool which is filled by the generator's skeleton.
+ */
+template< typename GenClass >
+class TxGenSourceBase : public TxSource
+{
+public:
+    TxGenSourceBase(std::unique_ptr< GenClass > gen, rte_mempool *pool, const char *name)
+        : m_gen(std::move(gen)), m_pool(pool), m_name(name)
+    {
+        auto &units = m_gen->GetTxUnits();
+        if (units.empty()) {
+            throw std::runtime_error("TX unit array is empty! Nothing to send!");
+        }
+
+        // Exact offsets in ticks: ns -> ticks once, not on every unit
+        const uint64_t hz = DPDK::Clocks::get_ticks_per_sec();
+        m_offsetTicks.reserve(units.size());
+        m_packetNum.reserve(units.size());
+        for (const auto &unit : units) {
+            m_offsetTicks.push_back(unit.offsetNS * hz / 1'000'000'000ULL);
+            m_packetNum.push_back(unit.GetPacketNum());
+        }
+    }
+
+    const char* GetName() const override { return m_name; }
+
+    size_t GetUnitNum() const override {
+        return m_offsetTicks.size();
+    }
+    uint64_t GetUnitOffsetTicks(size_t idx) const override {
+        return m_offsetTicks[idx];
+    }
+    size_t GetUnitPacketNum(size_t idx) const override {
+        return m_packetNum[idx];
+    }
+
+protected:
+    std::unique_ptr< GenClass > m_gen;
+    rte_mempool*                m_pool = nullptr;
+    const char*                 m_name = "";
+
+    std::vector< uint64_t >     m_offsetTicks;
+    std::vector< size_t >       m_packetNum;
+};
+
+/**
+ * @class TxGenSource
+ * @brief Each packet is a new mbuf amended by the generator
+ */
+template<
+    typename GenClass,
+    size_t (GenClass::*Amend)(uint8_t *packet, const typename GenClass::Desc &desc)
+        = &GenClass::AmendPacket
+>
+class TxGenSource : public TxGenSourceBase< GenClass >
+{
+    using Base = TxGenSourceBase< GenClass >;
+    using Base::m_gen;
+    using Base::m_pool;
+    using Base::m_prp;
+
+public:
+    using Base::Base;
+
+    void SendUnit(size_t idx, const TxContext &ctx, GenAppStat &stat) override {
+        rte_mbuf* mbufs[TX_BURST_SIZE] = { 0 };
+        rte_mbuf* copies[TX_BURST_SIZE] = { 0 };
+        uint64_t pktIdx = 0; // Packet index inside the unit
+        const auto unit = m_gen->GetTxUnits()[idx];
+        for (const auto &blk : unit.blocks) {
+            unsigned count = blk.packets.size(), sendNum = 0;
+            while (sendNum < count) {
+                unsigned num = ((count - sendNum) >= TX_BURST_SIZE) ? TX_BURST_SIZE
+                                                                    : (count - sendNum);
+                if (rte_pktmbuf_alloc_bulk(m_pool, mbufs, num) == 0) {
+                    for (size_t i=0;i<num;++i) {
+                        uint8_t *packet = rte_pktmbuf_mtod(mbufs[i], uint8_t *);
+
+                        mbufs[i]->pkt_len = ((*m_gen).*Amend)(packet, blk.packets[sendNum + i]);
+                        mbufs[i]->data_len = mbufs[i]->pkt_len;
+                        if (m_prp.IsEnabled()) {
+                            m_prp.Tag(mbufs[i], blk.packets[sendNum + i].idx);
+                        }
+                        m_gen->GetTxOffload().Apply(mbufs[i]);
+                    }
+                    unsigned copyNum = prp_duplicate(m_prp, mbufs, num, copies, stat);
+
+                    uint16_t nb_tx = tx_transmit(ctx, mbufs, num, pktIdx);
+                    if (nb_tx < num) {
+                        for (uint16_t i=nb_tx;i<num;i++) {
+                            rte_pktmbuf_free(mbufs[i]);
+                        }
+                        stat.errSendCnt += num - nb_tx;
+                    }
+                    prp_transmit(ctx, copies, copyNum, pktIdx, stat);
+                    // Unsent packets don't take pacing slots
+                    pktIdx += nb_tx;
+                } else {
+                    rte_eth_tx_done_cleanup(ctx.portID, ctx.queueID, 0);
+                    continue;
+                }
+
+                sendNum += num;
+            }
+        }
+    }
+};
+
+/**
+ * @class TxPrebuiltSource
+ * @brief Each IED owns a few mbufs stamped by its identity once, so the hot
+ * path writes only the counters. The source keeps a reference to its mbufs:
+ * refcnt == 1 means the driver has released the mbuf and it can be reused.
+ * If all mbufs of the IED are still in the TX ring, a new one is allocated.
+ */
+template<
+    typename GenClass,
+    void (GenClass::*Stamp)(uint8_t *packet, unsigned idx),
+    size_t (GenClass::*Counters)(uint8_t *packet, const typename GenClass::Desc &desc)
+>
+class TxPrebuiltSource : public TxGenSourceBase< GenClass >
+{
+    using Base = TxGenSourceBase< GenClass >;
+    using Base::m_gen;
+    using Base::m_pool;
+    using Base::m_prp;
+
+public:
+    static constexpr unsigned MAX_DEPTH = 16;
+
+    TxPrebuiltSource(std::unique_ptr< GenClass > gen, rte_mempool *pool, const char *name,
+                     unsigned depth)
+        : Base(std::move(gen), pool, name), m_depth(depth)
+    {
+        if (m_depth == 0 || m_depth > MAX_DEPTH) {
+            throw std::invalid_argument("Prebuilt mbufs per IED must be in 1.." + std::to_string(MAX_DEPTH));
+        }
+
+        const size_t iedNum = m_gen->GetIEDNum();
+        m_mbufs.resize(iedNum * m_depth);
+        m_slots.resize(iedNum, 0);
+        if (rte_pktmbuf_alloc_bulk(m_pool, m_mbufs.data(), m_mbufs.size()) != 0) {
+            m_mbufs.clear();
+            throw std::runtime_error("Can't allocate prebuilt mbufs: " + std::to_string(iedNum * m_depth));
+        }
+        for (size_t i=0;i<m_mbufs.size();++i) {
+            ((*m_gen).*Stamp)(rte_pktmbuf_mtod(m_mbufs[i], uint8_t *), i / m_depth);
+        }
+    }
+
+    ~TxPrebuiltSource() override {
+        // mbufs which are still in the TX ring are freed by the driver
+        if (!m_mbufs.empty()) {
+            rte_pktmbuf_free_bulk(m_mbufs.data(), m_mbufs.size());
+        }
+    }
+
+    void SendUnit(size_t idx, const TxContext &ctx, GenAppStat &stat) override {
+        rte_mbuf* mbufs[TX_BURST_SIZE] = { 0 };
+        rte_mbuf* copies[TX_BURST_SIZE] = { 0 };
+        bool prebuilt[TX_BURST_SIZE] = { false };
+        uint64_t pktIdx = 0; // Packet index inside the unit
+        const auto unit = m_gen->GetTxUnits()[idx];
+        for (const auto &blk : unit.blocks) {
+            unsigned count = blk.packets.size(), sendNum = 0;
+            while (sendNum < count) {
+                unsigned num = ((count - sendNum) >= TX_BURST_SIZE) ? TX_BURST_SIZE
+                                                                    : (count - sendNum);
+                unsigned txNum = 0;
+                for (unsigned i=0;i<num;++i) {
+                    const typename GenClass::Desc &desc = blk.packets[sendNum + i];
+
+                    rte_mbuf *m = TakePrebuilt(desc.idx);
+                    prebuilt[txNum] = (m != nullptr);
+                    if (m == nullptr) {
+                        ++stat.prebuiltMissCnt;
+                        m = rte_pktmbuf_alloc(m_pool);
+                        if (m == nullptr) {
+                            ++stat.errSendCnt;
+                            continue;
+                        }
+                        ((*m_gen).*Stamp)(rte_pktmbuf_mtod(m, uint8_t *), desc.idx);
+                    }
+
+                    m->pkt_len = ((*m_gen).*Counters)(rte_pktmbuf_mtod(m, uint8_t *), desc);
+                    m->data_len = m->pkt_len;
+                    if (m_prp.IsEnabled()) {
+                        m_prp.Tag(m, desc.idx);
+                    }
+                    m_gen->GetTxOffload().Apply(m);
+                    mbufs[txNum++] = m;
+                }
+                unsigned copyNum = prp_duplicate(m_prp, mbufs, txNum, copies, stat);
+
+                uint16_t nb_tx = tx_transmit(ctx, mbufs, txNum, pktIdx);
+                if (nb_tx < txNum) {
+                    for (uint16_t i=nb_tx;i<txNum;i++) {
+                        if (prebuilt[i]) {
+                            rte_mbuf_refcnt_update(mbufs[i], -1);
+                        } else {
+                            rte_pktmbuf_free(mbufs[i]);
+                        }
+                    }
+                    stat.errSendCnt += txNum - nb_tx;
+                }
+                prp_transmit(ctx, copies, copyNum, pktIdx, stat);
+
+                sendNum += num;
+                // Unsent packets don't take pacing slots
+                pktIdx += nb_tx;
+            }
+        }
+    }
+
+private:
+    inline rte_mbuf* TakePrebuilt(unsigned ied) {
+        rte_mbuf **own = &m_mbufs[(size_t)ied * m_depth];
+        for (unsigned k=0;k<m_depth;++k) {
+            unsigned slot = m_slots[ied] + k;
+            slot = (slot >= m_depth) ? (slot - m_depth) : slot;
+
+            if (rte_mbuf_refcnt_read(own[slot]) == 1) {
+                m_slots[ied] = (slot + 1 < m_depth) ? (slot + 1) : 0;
+
+                // The driver drops this reference after TX
+                rte_mbuf_refcnt_update(own[slot], 1);
+                return own[slot];
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    unsigned                    m_depth = 1;
+    std::vector< rte_mbuf* >    m_mbufs; // m_depth mbufs of each IED
+    std::vector< uint8_t >      m_slots; // The next mbuf of each IED
+};
@@ -23,6 +23,8 @@ public:
     bool empty() const { return m_values.empty(); }
     auto begin() { return m_values.begin(); }
     auto end() { return m_values.end(); }
+    auto begin() const { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
 
     auto find(const TKey& key) {
         size_t idx = m_register[key.appid];
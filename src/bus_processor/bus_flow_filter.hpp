@@ -0,0 +1,180 @@
+#pragma once
+
+#include "common/mac_addr.hpp"
+#include "dpdk_cpp/dpdk_port_class.hpp"
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/**
+ * @class BusFlowFilter
+ * @brief NIC drops GOOSE/SV of publishers which aren't subscribed: each subscription
+ * is an allow rule(dst MAC, EtherType, APPID) with and without VLAN tag, the rest of
+ * GOOSE/SV is dropped by rules of lower priority.
+ *
+ * If NIC can't match APPID(RAW item) the rules are by dst MAC and EtherType, if it
+ * can't offload them(or the drop rules) at all the filter falls back to software:
+ * all rules are removed and unknown publishers are counted by the stages as before.
+ */
+class BusFlowFilter
+{
+public:
+    enum Mode
+    {
+        EXACT = 0,  // dst MAC + EtherType + APPID
+        MAC_ONLY,   // dst MAC + EtherType
+        SOFTWARE    // No rules
+    };
+
+    static constexpr uint16_t GOOSE_ETHER_TYPE = 0x88B8;
+    static constexpr uint16_t SV_ETHER_TYPE = 0x88BA;
+
+    static constexpr uint32_t ALLOW_PRIORITY = 0;
+    static constexpr uint32_t DROP_PRIORITY = 1;
+
+    BusFlowFilter(DPDK::Port &port, uint16_t queueID)
+        : m_port(port), m_queueID(queueID)
+    {}
+
+    BusFlowFilter(const BusFlowFilter&) = delete;
+    BusFlowFilter& operator=(const BusFlowFilter&) = delete;
+
+    ~BusFlowFilter() {
+        RemoveAll();
+    }
+
+    /**
+     * @brief The publisher's frames pass NIC
+     * @return false if the filter fell back to software
+     */
+    bool Subscribe(const MAC &dmac, uint16_t ethType, uint16_t appid) {
+        while (m_mode != SOFTWARE) {
+            auto key = MakeKey(dmac, ethType, appid);
+            auto it = m_rules.find(key);
+            if (it != m_rules.end()) {
+                ++it->second.refs;
+                return true;
+            }
+
+            Rule rule;
+            if (AddRule(dmac, ethType, appid, rule)) {
+                m_rules.emplace(key, rule);
+                if (m_dropEnabled || EnableDefaultDrop()) {
+                    return true;
+                }
+                // Allow rules without the drop ones filter nothing
+                break;
+            }
+            if (!m_rules.empty()) {
+                // The NIC is out of rules: the filter isn't exact anymore
+                break;
+            }
+            m_mode = (m_mode == EXACT) ? MAC_ONLY : SOFTWARE;
+        }
+
+        RemoveAll();
+        m_mode = SOFTWARE;
+        return false;
+    }
+
+    /**
+     * @brief The publisher's frames are dropped by NIC again(by the default rules)
+     */
+    void Unsubscribe(const MAC &dmac, uint16_t ethType, uint16_t appid) {
+        auto it = m_rules.find(MakeKey(dmac, ethType, appid));
+        if (it == m_rules.end()) {
+            return;
+        }
+        if (--it->second.refs == 0) {
+            for (rte_flow *flow : it->second.flows) {
+                m_port.RemoveFlow(flow);
+            }
+            m_rules.erase(it);
+        }
+    }
+
+    Mode GetMode() const { return m_mode; }
+    size_t GetRuleNum() const { return m_rules.size(); }
+
+    static const char* GetModeName(Mode mode) {
+        constexpr const char* NAMES[] = { "APPID", "MAC", "Software" };
+        return NAMES[mode];
+    }
+
+private:
+    using Key = std::tuple< uint64_t, uint16_t, uint16_t >;
+
+    struct Rule
+    {
+        std::vector< rte_flow* > flows;
+        unsigned refs = 1;
+    };
+
+    inline Key MakeKey(const MAC &dmac, uint16_t ethType, uint16_t appid) const {
+        // Publishers of the same MAC share a rule if APPID isn't matched
+        return Key{ dmac.toU64(), ethType, (m_mode == EXACT) ? appid : 0 };
+    }
+
+    bool AddRule(const MAC &dmac, uint16_t ethType, uint16_t appid, Rule &rule) {
+        const uint16_t *appidPtr = (m_mode == EXACT) ? &appid : nullptr;
+        for (bool vlan : { false, true }) {
+            rte_flow *flow = m_port.AddBusFlow(dmac.data(), ethType, appidPtr, vlan,
+                                               m_queueID, ALLOW_PRIORITY);
+            if (flow == nullptr) {
+                for (rte_flow *f : rule.flows) {
+                    m_port.RemoveFlow(f);
+                }
+                rule.flows.clear();
+                return false;
+            }
+            rule.flows.push_back(flow);
+        }
+        return true;
+    }
+
+    /**
+     * @return false if NIC refused any of the drop rules, none of them is kept
+     */
+    bool EnableDefaultDrop() {
+        for (uint16_t ethType : { GOOSE_ETHER_TYPE, SV_ETHER_TYPE }) {
+            for (bool vlan : { false, true }) {
+                rte_flow *flow = m_port.AddDropFlow(ethType, vlan, DROP_PRIORITY);
+                if (flow == nullptr) {
+                    for (rte_flow *f : m_dropFlows) {
+                        m_port.RemoveFlow(f);
+                    }
+                    m_dropFlows.clear();
+                    return false;
+                }
+                m_dropFlows.push_back(flow);
+            }
+        }
+        m_dropEnabled = true;
+        return true;
+    }
+
+    void RemoveAll() {
+        for (auto &rule : m_rules) {
+            for (rte_flow *flow : rule.second.flows) {
+                m_port.RemoveFlow(flow);
+            }
+        }
+        m_rules.clear();
+        for (rte_flow *flow : m_dropFlows) {
+            m_port.RemoveFlow(flow);
+        }
+        m_dropFlows.clear();
+        m_dropEnabled = false;
+    }
+
+private:
+    DPDK::Port&                 m_port;
+    uint16_t                    m_queueID = 0;
+    Mode                        m_mode = EXACT;
+
+    std::map< Key, Rule >       m_rules;
+    std::vector< rte_flow* >    m_dropFlows;
+    bool                        m_dropEnabled = false;
+};
@@ -74,9 +74,6 @@ int main(int argc, char *argv[])
     argc -= retval;
     argv += retval;
 
-    if (rte_eth_dev_count_avail() == 0) {
-        rte_exit(EXIT_FAILURE, "No available ports. Please, check port binding.\n");
-    }
     if (rte_get_main_lcore() == 0) {
         rte_exit(EXIT_FAILURE, "You can't use core 0 to generate/process BUSes!\n");
     }
@@ -92,6 +89,9 @@ int main(int argc, char *argv[])
 
     try {
         app = std::make_shared< RX_Application >(argc, argv);
+        if (!app->IsReplayMode() && rte_eth_dev_count_avail() == 0) {
+            rte_exit(EXIT_FAILURE, "No available ports. Please, check port binding.\n");
+        }
 
         auxThread = std::thread(auxiliary_thread, app);
 
@@ -0,0 +1,72 @@
+#include "pcap_replay.hpp"
+
+#include <pcap/pcap.h>
+
+#include <cstring>
+#include <stdexcept>
+
+PcapReplay::PcapReplay(const std::string &file, unsigned loops)
+    : m_file(file), m_loops(loops)
+{
+    char errbuf[PCAP_ERRBUF_SIZE] = { 0 };
+    pcap_t *pcap = pcap_open_offline(file.c_str(), errbuf);
+    if (pcap == nullptr) {
+        throw std::runtime_error("Can't open capture: " + file + ": " + std::string(errbuf));
+    }
+    if (pcap_datalink(pcap) != DLT_EN10MB) {
+        pcap_close(pcap);
+        throw std::runtime_error("Capture is not Ethernet: " + file);
+    }
+
+    pcap_pkthdr *hdr = nullptr;
+    const u_char *data = nullptr;
+    while (pcap_next_ex(pcap, &hdr, &data) == 1) {
+        if (hdr->caplen != hdr->len) {
+            // Truncated by snaplen
+            ++m_skippedNum;
+            continue;
+        }
+        m_packets.emplace_back(data, data + hdr->caplen);
+        m_bytes += hdr->caplen;
+    }
+    pcap_close(pcap);
+
+    m_packetNum = m_packets.size();
+    if (m_packetNum == 0) {
+        throw std::runtime_error("Capture has no packets: " + file);
+    }
+}
+
+PcapReplay::~PcapReplay()
+{
+    if (!m_mbufs.empty()) {
+        rte_pktmbuf_free_bulk(m_mbufs.data(), m_mbufs.size());
+    }
+}
+
+void PcapReplay::Preload()
+{
+    // No cache: every mbuf of the pool is taken at once
+    m_pool = std::make_unique< DPDK::Mempool >("bus_replay_pool", m_packetNum, 0);
+
+    m_mbufs.resize(m_packetNum);
+    if (rte_pktmbuf_alloc_bulk(m_pool->Get(), m_mbufs.data(), m_mbufs.size()) != 0) {
+        m_mbufs.clear();
+        throw std::runtime_error("Can't allocate mbufs for capture: " + m_file);
+    }
+
+    for (size_t i=0;i<m_mbufs.size();++i) {
+        const std::vector< uint8_t > &pkt = m_packets[i];
+
+        char *data = rte_pktmbuf_append(m_mbufs[i], pkt.size());
+        if (data == nullptr) {
+            throw std::runtime_error("Packet doesn't fit mbuf: size = "
+                                     + std::to_string(pkt.size()));
+        }
+        std::memcpy(data, pkt.data(), pkt.size());
+    }
+
+    // Capture lives in mbufs from now on
+    m_packets.clear();
+    m_packets.shrink_to_fit();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "dpdk_cpp/dpdk_mempool_class.hpp"
+
+#include <rte_mbuf.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @class PcapReplay
+ * @brief Offline RX source: a capture preloaded into hugepage mbufs
+ *
+ * Interface is the same as RX from a NIC, so the pipeline can be driven
+ * without a link. The capture is replayed 'loops' times as fast as possible.
+ * Every mbuf keeps an extra reference, so rte_pktmbuf_free() in the pipeline
+ * only decrements refcnt and the packet can be sent again in the next loop.
+ */
+class PcapReplay
+{
+public:
+    PcapReplay(const PcapReplay&) = delete;
+    PcapReplay& operator=(const PcapReplay&) = delete;
+
+    PcapReplay(const std::string &file, unsigned loops);
+    ~PcapReplay();
+
+    /**
+     * @brief Copy the capture to mbufs of its own hugepage pool
+     */
+    void Preload();
+
+    inline uint16_t RxBurst(rte_mbuf **bufs, uint16_t num) {
+        if (m_loop >= m_loops) {
+            return 0;
+        }
+
+        // A short capture isn't repeated within a burst
+        if (num > m_mbufs.size()) {
+            num = m_mbufs.size();
+        }
+
+        uint16_t count = 0;
+        while (count < num) {
+            rte_mbuf *m = m_mbufs[m_pos];
+            rte_mbuf_refcnt_update(m, 1);
+            bufs[count++] = m;
+
+            if (++m_pos == m_mbufs.size()) {
+                m_pos = 0;
+                if (++m_loop >= m_loops) {
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+    inline bool IsFinished() const { return m_loop >= m_loops; }
+
+    size_t      GetPacketNum() const { return m_packetNum; }
+    uint64_t    GetBytes() const { return m_bytes; }
+    unsigned    GetLoops() const { return m_loops; }
+    unsigned    GetSkippedNum() const { return m_skippedNum; }
+
+private:
+    std::string                     m_file;
+    unsigned                        m_loops = 1;
+    unsigned                        m_skippedNum = 0;
+    size_t                          m_packetNum = 0;
+    uint64_t                        m_bytes = 0;
+
+    // Capture before preloading
+    std::vector< std::vector< uint8_t > > m_packets;
+
+    // Runtime
+    std::unique_ptr< DPDK::Mempool > m_pool;
+    std::vector< rte_mbuf* >        m_mbufs;
+    size_t                          m_pos = 0;
+    unsigned                        m_loop = 0;
+};
@@ -1,27 +1,85 @@
 #pragma once
 
+#include <cstdint>
+#include <utility>
+
 namespace Pipeline
 {
     template< typename MBUF, unsigned MAX_NUM = 32 >
     struct Frame
     {
-        MBUF*       buf[MAX_NUM] = {};
+        static constexpr unsigned CAPACITY = MAX_NUM;
+
+        // Isn't zeroed by default: a local frame is free, Matrix zeroes its frames
+        MBUF*       buf[MAX_NUM];
         unsigned    num = 0;
 
-        inline void PutBuffer(MBUF *ptr) {
+        /**
+         * @brief Put mbuf to the frame
+         * @return false if the frame is full, mbuf isn't put
+         */
+        inline bool PutBuffer(MBUF *ptr) {
+            if (num >= MAX_NUM) [[unlikely]] {
+                return false;
+            }
             buf[num] = ptr;
             ++num;
+            return true;
+        }
+
+        inline bool IsFull() const { return num >= MAX_NUM; }
+    };
+
+    /**
+     * @brief Stage statistic policy: nothing is measured, compiles to nothing
+     */
+    struct NoStageStat
+    {
+        static constexpr bool ENABLED = false;
+    };
+
+    /**
+     * @brief Stage statistic policy: clock cycles and packets of each stage
+     *
+     * One instance per Matrix, so it's per lcore and is written without atomics.
+     */
+    template< unsigned TStageNum, uint64_t (*TClock)() >
+    struct StageCycleStat
+    {
+        static constexpr bool ENABLED = true;
+        static constexpr unsigned STAGE_NUM = TStageNum;
+
+        uint64_t    cycles[TStageNum] = {};
+        uint64_t    maxCycles[TStageNum] = {};
+        uint64_t    packets[TStageNum] = {};
+        uint64_t    calls[TStageNum] = {};
+
+        static inline uint64_t Now() {
+            return TClock();
+        }
+
+        inline void Add(unsigned stage, unsigned num, uint64_t delta) {
+            cycles[stage] += delta;
+            packets[stage] += num;
+            ++calls[stage];
+            if (delta > maxCycles[stage]) {
+                maxCycles[stage] = delta;
+            }
         }
     };
 
-    template< typename TNodeEnum, typename TFrame, typename TApp = void >
+    template< typename TNodeEnum, typename TFrame, typename TApp = void,
+              typename TStat = NoStageStat >
     struct Matrix
     {
         using Frame = TFrame;
+        using Stat = TStat;
         Matrix(TApp *ptr) : app(ptr) {}
 
         Frame stages[TNodeEnum::STAGE_NUM] = {};
         TApp *app = nullptr;
+
+        [[no_unique_address]] Stat stat = {};
     };
 
     template< typename TMatrix, void (*Op)(TMatrix &) >
@@ -32,6 +90,31 @@ namespace Pipeline
         }
     };
 
+    /**
+     * @brief Stage wrapper which accounts cycles and packets of the stage
+     * according to Matrix::Stat. Empty frames are not accounted.
+     */
+    template< unsigned TFrameIdx, typename TStage >
+    struct Measured
+    {
+        template< typename TMatrix >
+        static void ApplyTo(TMatrix &matrix) {
+            if constexpr (TMatrix::Stat::ENABLED) {
+                const unsigned num = matrix.stages[TFrameIdx].num;
+                if (num == 0) {
+                    TStage::ApplyTo(matrix);
+                    return;
+                }
+
+                uint64_t begin = TMatrix::Stat::Now();
+                TStage::ApplyTo(matrix);
+                matrix.stat.Add(TFrameIdx, num, TMatrix::Stat::Now() - begin);
+            } else {
+                TStage::ApplyTo(matrix);
+            }
+        }
+    };
+
     template< typename... TStages >
     struct StaticChain
     {
@@ -42,4 +125,3 @@ namespace Pipeline
         }
     };
 };
-
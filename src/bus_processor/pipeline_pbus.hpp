@@ -2,17 +2,36 @@
 
 #include "pipeline.hpp"
 #include "process_bus_parser.hpp"
+#include "common/dup_discard.hpp"
+#include "common/reorder_window.hpp"
+#include "dpdk_cpp/dpdk_clocks_class.hpp"
 
 #include <rte_mbuf.h>
 #include <rte_prefetch.h>
+#include <rte_ring.h>
 
 constexpr unsigned  RX_BURST_SIZE = 32;
+// Under load several bursts are accumulated into one pipeline pass
+constexpr unsigned  RX_FRAME_SIZE = 8 * RX_BURST_SIZE;
+// Bus frames chained by NIC scatter are parsed from a copy of this size
+constexpr unsigned  RX_CHAINED_MAX = 2048;
+
+class RX_Application;
 
 namespace PBus
 {
     /*
         Frame processing:
-        {mbuf} -> RouterStage -> GooseStage -> SampledValuesStage -> IPStage
+        {mbuf} -> RouterStage -> GooseStage -> SampledValuesStage -> PtpStage -> IPStage
+
+        RouterStage sends R-GOOSE/R-SV(IPv4/UDP 102) to GooseStage/SampledValuesStage,
+        the rest of IP traffic goes to IPStage. PRP/HSR duplicates are dropped by it
+        (by the dispatcher in software RSS mode)
+
+        Stage per lcore (RingStage hands the frame over to another lcore):
+        lcore A: {mbuf} -> RouterStage -> RingStage(GOOSE) -> RingStage(SV) -> PtpStage -> IPStage
+        lcore B: {ring} -> GooseStage
+        lcore C: {ring} -> SampledValuesStage
     */
 
     enum EnumStages
@@ -22,37 +41,125 @@ namespace PBus
         ROUTER = 0,
         GOOSE,
         SV,
+        PTP,
         IP,
 
         STAGE_NUM
     };
 
+    constexpr const char* STAGE_NAMES[STAGE_NUM] = {
+        "Router", "GOOSE", "SV", "PTP", "IP"
+    };
+
+    /**
+     * @brief Per-stage cycle accounting, is enabled by PBUS_STAGE_STAT
+     */
+#ifdef PBUS_STAGE_STAT
+    using StageStat = Pipeline::StageCycleStat< STAGE_NUM, &DPDK::Clocks::get_current_ticks >;
+#else
+    using StageStat = Pipeline::NoStageStat;
+#endif
+
+    /**
+     * @brief Consumers of a stage's frame on other lcores: SPSC ring per consumer
+     */
+    struct StageLink
+    {
+        static constexpr unsigned MAX_RINGS = 8;
+
+        rte_ring*   rings[MAX_RINGS] = {};
+        unsigned    num = 0;
+        uint64_t    dropCnt = 0;
+    };
+
+    /**
+     * @brief Streams of the lcore with states in their reorder windows
+     */
+    struct PendingReorder
+    {
+        ReorderPending< GooseSource >       goose;
+        ReorderPending< SVStreamSource >    sv;
+
+        inline bool IsEmpty() const {
+            return goose.IsEmpty() && sv.IsEmpty();
+        }
+        inline void Expire(uint64_t now) {
+            goose.Expire(now);
+            sv.Expire(now);
+        }
+    };
+
+    /**
+     * @brief PRP/HSR: the second copy of a frame is dropped before parsing
+     */
+    inline bool is_duplicate(DuplicateDiscard *dupDiscard, const uint8_t *packet, unsigned size)
+    {
+        RedundancyTag tag;
+        return dupDiscard != nullptr
+               && ProcessBusParser::get_redundancy_tag(packet, size, tag)
+               && dupDiscard->IsDuplicate(ProcessBusParser::get_src_mac(packet), tag.seq, tag.lan);
+    }
+
+    /**
+     * @brief Contiguous bytes of the frame: the first segment, or a copy of the
+     * segments in buf when NIC scattered the frame over the data room of mbufs
+     */
+    inline const uint8_t* frame_bytes(const rte_mbuf *mbuf, uint8_t (&buf)[RX_CHAINED_MAX], unsigned &size)
+    {
+        size = rte_pktmbuf_pkt_len(mbuf);
+        if (mbuf->nb_segs == 1) [[likely]] {
+            return rte_pktmbuf_mtod(mbuf, const uint8_t *);
+        }
+        return (const uint8_t *)rte_pktmbuf_read(mbuf, 0, size, buf);
+    }
+
     template< typename TMatrix, unsigned TFrameIdx >
     struct RouterStage
     {
         static void ApplyTo(TMatrix& matrix) {
             typename TMatrix::Frame &frame = matrix.stages[TFrameIdx];
 
+            DuplicateDiscard *dupDiscard = matrix.app->GetDupDiscard();
             for (unsigned i=0;i<frame.num;++i) {
                 /* rte_prefetch0(frame.buf[i]); */
                 const uint8_t *packet = rte_pktmbuf_mtod(frame.buf[i], const uint8_t *);
+                const unsigned size = rte_pktmbuf_data_len(frame.buf[i]);
+                if (is_duplicate(dupDiscard, packet, size)) {
+                    continue;
+                }
 
-                unsigned appid = 0;
-                BUS_PROTO type = ProcessBusParser::get_proto_type(packet, &appid);
+                // R-GOOSE/R-SV go to the same stages, they are parsed in place
+                BusPduLocation loc;
+                unsigned dst = IP;
+                BUS_PROTO type = ProcessBusParser::locate_pdu(packet, size, loc);
+                matrix.app->m_rxRoutablePktCnt += loc.routable;
                 switch (type) {
                 case BUS_PROTO_SV: {
-                    matrix.stages[SV].PutBuffer(frame.buf[i]);
+                    dst = SV;
                     break;
                 }
                 case BUS_PROTO_GOOSE: {
-                    matrix.stages[GOOSE].PutBuffer(frame.buf[i]);
+                    dst = GOOSE;
+                    break;
+                }
+                case BUS_PROTO_PTP: {
+                    dst = PTP;
                     break;
                 }
                 default: {
-                    matrix.stages[IP].PutBuffer(frame.buf[i]);
                     break;
                 }
                 }
+                // Chained bus frames are copied by the stages, a longer one than the copy is lost
+                if (dst != IP && rte_pktmbuf_pkt_len(frame.buf[i]) > RX_CHAINED_MAX) [[unlikely]] {
+                    ++matrix.app->m_rxChainedCnt;
+                    continue;
+                }
+
+                // mbuf which isn't put is freed with START frame
+                if (!matrix.stages[dst].PutBuffer(frame.buf[i])) {
+                    ++matrix.app->m_frameOverflowCnt;
+                }
             }
 
             //! Clean frame for the next cycle
@@ -66,10 +173,14 @@ namespace PBus
         static void ApplyTo(TMatrix &matrix) {
             typename TMatrix::Frame &frame = matrix.stages[TFrameIdx];
 
-            RX_Application &app = *matrix.app;
+            auto &app = *matrix.app;
+            // One TSC read per burst: the reorder wait is much longer than a burst
+            const uint64_t now = (app.m_reorderWaitUS > 0) ? DPDK::Clocks::get_current_ticks() : 0;
+            PendingReorder *pending = app.GetReorderPending();
+            uint8_t chained[RX_CHAINED_MAX];
             for (unsigned i=0;i<frame.num;++i) {
-                const uint8_t *packet = rte_pktmbuf_mtod(frame.buf[i], const uint8_t *);
-                const unsigned size = rte_pktmbuf_pkt_len(frame.buf[i]);
+                unsigned size = 0;
+                const uint8_t *packet = frame_bytes(frame.buf[i], chained, size);
                 
                 GoosePassport pass;
                 GooseState state;
@@ -77,7 +188,10 @@ namespace PBus
                 if (retval == 0) {
                     auto src = app.m_gooseMap.find(pass);
                     if (src != app.m_gooseMap.end()) {
-                        src->second->ProcessState(pass, state);
+                        src->second->ProcessState(pass, state, now);
+                        if (pending != nullptr && src->second->GetReorder().GetPendingNum() > 0) {
+                            pending->goose.Track(src->second.get());
+                        }
 
                         ++app.m_rxGoosePktCnt;
                     } else {
@@ -100,10 +214,13 @@ namespace PBus
         static void ApplyTo(TMatrix &matrix) {
             typename TMatrix::Frame &frame = matrix.stages[TFrameIdx];
 
-            RX_Application &app = *matrix.app;
+            auto &app = *matrix.app;
+            const uint64_t now = (app.m_reorderWaitUS > 0) ? DPDK::Clocks::get_current_ticks() : 0;
+            PendingReorder *pending = app.GetReorderPending();
+            uint8_t chained[RX_CHAINED_MAX];
             for (unsigned i=0;i<frame.num;++i) {
-                const uint8_t *packet = rte_pktmbuf_mtod(frame.buf[i], const uint8_t *);
-                const unsigned size = rte_pktmbuf_pkt_len(frame.buf[i]);
+                unsigned size = 0;
+                const uint8_t *packet = frame_bytes(frame.buf[i], chained, size);
 
                 SVStreamPassport pass;
                 SVStreamState state;
@@ -111,7 +228,10 @@ namespace PBus
                 if (retval == 0) {
                     auto src = app.m_svMap.find(pass);
                     if (src != app.m_svMap.end()) {
-                        src->second->ProcessState(pass, state);
+                        src->second->ProcessState(pass, state, now);
+                        if (pending != nullptr && src->second->GetReorder().GetPendingNum() > 0) {
+                            pending->sv.Track(src->second.get());
+                        }
 
                         ++app.m_rxSVPktCnt;
                     } else {
@@ -127,6 +247,37 @@ namespace PBus
         }
     };
 
+    /**
+     * @brief PTP event messages are timestamped by NIC, Sync and Follow_Up
+     * discipline the TSC -> PTP mapping of the application. Runs on the RX lcore,
+     * so the NIC's timestamp register is read out in the order of reception.
+     */
+    template< typename TMatrix, unsigned TFrameIdx >
+    struct PtpStage
+    {
+        static void ApplyTo(TMatrix &matrix) {
+            typename TMatrix::Frame &frame = matrix.stages[TFrameIdx];
+
+            auto &app = *matrix.app;
+            uint8_t chained[RX_CHAINED_MAX];
+            for (unsigned i=0;i<frame.num;++i) {
+                unsigned size = 0;
+                const uint8_t *packet = frame_bytes(frame.buf[i], chained, size);
+
+                PtpMessage msg;
+                if (ProcessBusParser::parse_ptp_packet(packet, size, msg) == 0) {
+                    app.m_ptpSync.Process(msg, frame.buf[i]);
+                    ++app.m_rxPtpPktCnt;
+                } else {
+                    ++app.m_errPtpParserCnt;
+                }
+            }
+
+            //! Clean frame for the next cycle
+            frame.num = 0;
+        }
+    };
+
     template< typename TMatrix, unsigned TFrameIdx >
     struct IPStage 
     {
@@ -140,17 +291,89 @@ namespace PBus
         }
     };
 
+    /**
+     * @brief Hands the frame over to the lcores of StageLink. Several consumers
+     * share the frame by APPID, so a stream always stays on the same lcore.
+     *
+     * The producer frees its START frame after the chain, so each passed mbuf
+     * gets an extra reference which is released by the consumer.
+     */
+    template< typename TMatrix, unsigned TFrameIdx >
+    struct RingStage
+    {
+        static void ApplyTo(TMatrix &matrix) {
+            typename TMatrix::Frame &frame = matrix.stages[TFrameIdx];
+            if (frame.num == 0) {
+                return;
+            }
+
+            StageLink &link = matrix.app->m_stageLink[TFrameIdx];
+            for (unsigned i=0;i<frame.num;++i) {
+                rte_mbuf_refcnt_update(frame.buf[i], 1);
+            }
+
+            if (link.num == 1) {
+                Enqueue(link, 0, frame.buf, frame.num);
+            } else {
+                typename TMatrix::Frame parts[StageLink::MAX_RINGS];
+                for (unsigned i=0;i<frame.num;++i) {
+                    const uint8_t *packet = rte_pktmbuf_mtod(frame.buf[i], const uint8_t *);
+                    const unsigned size = rte_pktmbuf_data_len(frame.buf[i]);
+                    unsigned idx = ProcessBusParser::get_appid(packet, size) & (link.num - 1);
+                    parts[idx].PutBuffer(frame.buf[i]);
+                }
+                for (unsigned r=0;r<link.num;++r) {
+                    if (parts[r].num > 0) {
+                        Enqueue(link, r, parts[r].buf, parts[r].num);
+                    }
+                }
+            }
+
+            //! Clean frame for the next cycle
+            frame.num = 0;
+        }
+
+    private:
+        static inline void Enqueue(StageLink &link, unsigned idx, rte_mbuf **bufs, unsigned num) {
+            unsigned sent = rte_ring_sp_enqueue_burst(link.rings[idx], (void * const *)bufs, num, nullptr);
+            if (sent < num) {
+                // Ring is full: drop the consumer's references
+                rte_pktmbuf_free_bulk(bufs + sent, num - sent);
+                link.dropCnt += num - sent;
+            }
+        }
+    };
+
     /**
      * @brief DataMatrix represents a pipeline's table:
      * { mbuf } x { stages } where each stage has its own frame which is an array of mbufs
      */
     using DataMatrix = Pipeline::Matrix< EnumStages,
-                                         Pipeline::Frame< rte_mbuf, RX_BURST_SIZE >,
-                                         RX_Application >;
+                                         Pipeline::Frame< rte_mbuf, RX_FRAME_SIZE >,
+                                         RX_Application,
+                                         StageStat >;
 
-    using FramePipeline = Pipeline::StaticChain< RouterStage< DataMatrix, ROUTER >,
-                                                 GooseStage< DataMatrix, GOOSE >,
-                                                 SampledValuesStage< DataMatrix, SV >,
-                                                 IPStage< DataMatrix, IP > >;
-}
+    using FramePipeline = Pipeline::StaticChain<
+                              Pipeline::Measured< ROUTER, RouterStage< DataMatrix, ROUTER > >,
+                              Pipeline::Measured< GOOSE, GooseStage< DataMatrix, GOOSE > >,
+                              Pipeline::Measured< SV, SampledValuesStage< DataMatrix, SV > >,
+                              Pipeline::Measured< PTP, PtpStage< DataMatrix, PTP > >,
+                              Pipeline::Measured< IP, IPStage< DataMatrix, IP > > >;
 
+    /**
+     * @brief Stage per lcore: RX lcore routes and hands GOOSE and SV frames
+     * over to their lcores, which run the rest of the chain
+     */
+    using RouterPipeline = Pipeline::StaticChain<
+                               Pipeline::Measured< ROUTER, RouterStage< DataMatrix, ROUTER > >,
+                               Pipeline::Measured< GOOSE, RingStage< DataMatrix, GOOSE > >,
+                               Pipeline::Measured< SV, RingStage< DataMatrix, SV > >,
+                               Pipeline::Measured< PTP, PtpStage< DataMatrix, PTP > >,
+                               Pipeline::Measured< IP, IPStage< DataMatrix, IP > > >;
+
+    using GoosePipeline = Pipeline::StaticChain<
+                              Pipeline::Measured< GOOSE, GooseStage< DataMatrix, GOOSE > > >;
+
+    using SVPipeline = Pipeline::StaticChain<
+                           Pipeline::Measured< SV, SampledValuesStage< DataMatrix, SV > > >;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class PoolSizing
+ * @brief mbufs, descriptors and worker rings from the configured streams: the
+ * NIC ring and each worker ring absorb the traffic of a stall(bufferUS), the
+ * pool holds what the rings, lcore frames and lcore caches can keep at once.
+ * GOOSE/SV frames are small, so is the data room of their mbufs; a larger
+ * frame is chained by NIC scatter.
+ */
+class PoolSizing
+{
+public:
+    // Frames per second of a stream
+    static constexpr unsigned GOOSE_PPS = 1000;     // Retransmissions after a change, T0 = 1 ms
+    static constexpr unsigned SV80_PPS = 4000;
+    static constexpr unsigned SV256_PPS = 1600;     // 8 ASDU per frame
+    static constexpr unsigned OTHER_PPS = 10000;    // PTP, ARP and the rest of IP
+
+    static constexpr unsigned MIN_DESC = 512, MAX_DESC = 32 * 1024;
+    static constexpr unsigned MIN_RING = 1024, MAX_RING = 16 * 1024;
+    static constexpr unsigned SMALL_DATA = 512;     // GOOSE, SV80, their R-GOOSE/R-SV
+    static constexpr unsigned LARGE_DATA = 1024;    // SV256
+    static constexpr unsigned XDP_DATA = 2048;      // af_xdp PMD: a frame of umem must fit mbuf
+    static constexpr unsigned MBUF_OVERHEAD = 192;  // rte_mbuf and the header of the mempool object
+
+    struct Config
+    {
+        unsigned gooseNum = 0,
+                 sv80Num = 0,
+                 sv256Num = 0;
+        unsigned portNum = 1;       // Each port carries all streams(LAN A/B)
+        unsigned lcoreNum = 1;
+        unsigned ringNum = 0;       // Worker rings or the event device
+        unsigned bufferUS = 10000;
+        unsigned frameSize = 256;   // mbufs held by the frames of an lcore
+        unsigned cacheNum = 256;
+        unsigned txDescNum = 128;
+        unsigned headroom = 128;
+        unsigned dataRoom = 0;      // Without headroom, 0 - by the traffic
+        bool     xdp = false;       // AF_XDP ports
+    };
+
+    explicit PoolSizing(const Config &conf)
+        : m_cacheNum(conf.cacheNum)
+    {
+        m_pps = (uint64_t)conf.gooseNum * GOOSE_PPS + (uint64_t)conf.sv80Num * SV80_PPS
+                + (uint64_t)conf.sv256Num * SV256_PPS + OTHER_PPS;
+        const uint64_t stallNum = m_pps * conf.bufferUS / 1'000'000;
+
+        m_rxDescNum = std::clamp< uint64_t >(align_pow2(stallNum), MIN_DESC, MAX_DESC);
+        m_ringSize = std::clamp< uint64_t >(align_pow2(stallNum), MIN_RING, MAX_RING);
+
+        // Caches are flushed above 1.5 of their size
+        const uint64_t needNum = (uint64_t)conf.portNum * (m_rxDescNum + conf.txDescNum)
+                                 + (uint64_t)conf.ringNum * m_ringSize
+                                 + (uint64_t)conf.lcoreNum * (conf.frameSize + conf.cacheNum * 3 / 2);
+        // 2^N - 1 is the optimum of rte_mempool
+        m_mbufNum = align_pow2(needNum + 1) - 1;
+
+        if (conf.dataRoom > 0) {
+            m_dataRoom = conf.dataRoom;
+        } else {
+            m_dataRoom = (conf.sv256Num > 0) ? LARGE_DATA : SMALL_DATA;
+        }
+        if (conf.xdp) {
+            m_dataRoom = std::max(m_dataRoom, XDP_DATA);
+        }
+        m_mbufSize = conf.headroom + m_dataRoom;
+    }
+
+    uint64_t GetPPS() const { return m_pps; }
+    unsigned GetRxDescNum() const { return m_rxDescNum; }
+    unsigned GetRingSize() const { return m_ringSize; }
+    unsigned GetMbufNum() const { return m_mbufNum; }
+    unsigned GetCacheNum() const { return m_cacheNum; }
+    /**
+     * @brief Data room of mbuf: the max frame in a single segment
+     */
+    unsigned GetDataRoom() const { return m_dataRoom; }
+    /**
+     * @brief Data room with headroom, the size for rte_pktmbuf_pool_create
+     */
+    unsigned GetMbufSize() const { return m_mbufSize; }
+    uint64_t GetBytes() const { return (uint64_t)m_mbufNum * (m_mbufSize + MBUF_OVERHEAD); }
+
+private:
+    static uint64_t align_pow2(uint64_t num) {
+        return (num <= 1) ? 1 : (1ULL << (64 - __builtin_clzll(num - 1)));
+    }
+
+private:
+    uint64_t    m_pps = 0;
+    unsigned    m_rxDescNum = MIN_DESC;
+    unsigned    m_ringSize = MIN_RING;
+    unsigned    m_mbufNum = 0;
+    unsigned    m_cacheNum = 0;
+    unsigned    m_dataRoom = SMALL_DATA;
+    unsigned    m_mbufSize = 0;
+};
@@ -61,19 +61,14 @@ int ProcessBusParser::parse_goose_packet(const uint8_t *buffer, int size,
 
     passport.dmac = MAC(buffer);
 
-    size_t pos = 14;
-    if (buffer[12] == 0x81 && buffer[13] == 0x00 &&
-        buffer[16] == 0x88 && buffer[17] == 0xB8) {
-        // VLAN -> GOOSE
-        pos += 4;
-    } else if (buffer[12] == 0x88 && buffer[13] == 0xB8) {
-        // GOOSE without VLAN
-    } else {
+    // L2 GOOSE (with or without VLAN) or R-GOOSE
+    BusPduLocation loc;
+    if (locate_pdu(buffer, size, loc) != BUS_PROTO_GOOSE) {
         return -1;
     }
-
-    passport.appid = NET_TO_CPU_U16(buffer + pos);
-    pos += 8; // APPID, Length, Reserv1, Reserv2
+    passport.appid = NET_TO_CPU_U16(buffer + loc.appid);
+    size_t pos = loc.apdu;
+    size = loc.end; // R-GOOSE is followed by the signature
 
     // PDU
     if (buffer[pos++] != 0x61) {
@@ -157,19 +152,14 @@ int ProcessBusParser::parse_sv_packet(const uint8_t *buffer, int size,
 
     passport.dmac = MAC(buffer);
 
-    size_t pos = 14;
-    if (buffer[12] == 0x81 && buffer[13] == 0x00 &&
-        buffer[16] == 0x88 && buffer[17] == 0xBA) {
-        // VLAN -> SV
-        pos += 4;
-    } else if (buffer[12] == 0x88 && buffer[13] == 0xBA) {
-        // SV without VLAN
-    } else {
+    // L2 SV (with or without VLAN) or R-SV
+    BusPduLocation loc;
+    if (locate_pdu(buffer, size, loc) != BUS_PROTO_SV) {
         return -2;
     }
-
-    passport.appid = NET_TO_CPU_U16(buffer + pos);
-    pos += 8; // APPID, Length, Reserv1, Reserv2
+    passport.appid = NET_TO_CPU_U16(buffer + loc.appid);
+    size_t pos = loc.apdu;
+    size = loc.end; // R-SV is followed by the signature
 
     // SV PDU (tag 0x60)
     if (pos >= size || buffer[pos++] != 0x60) {
@@ -237,3 +227,39 @@ int ProcessBusParser::parse_sv_packet(const uint8_t *buffer, int size,
     return 0;
 }
 
+int ProcessBusParser::parse_ptp_packet(const uint8_t *buffer, int size, PtpMessage &msg)
+{
+    const unsigned PTP_HEADER_SIZE = 34, PTP_TIMESTAMP_SIZE = 10;
+
+    BusPduLocation loc;
+    if (locate_pdu(buffer, size, loc) != BUS_PROTO_PTP || loc.apdu + PTP_HEADER_SIZE > (unsigned)size) {
+        return -1;
+    }
+    const uint8_t *ptp = buffer + loc.apdu;
+    if ((ptp[1] & 0x0F) != 2) {
+        // PTPv2 only
+        return -2;
+    }
+    const unsigned msgLen = NET_TO_CPU_U16(ptp + 2);
+    if (msgLen < PTP_HEADER_SIZE || loc.apdu + msgLen > (unsigned)size) {
+        return -3;
+    }
+
+    msg.type = ptp[0] & 0x0F;
+    msg.domain = ptp[4];
+    msg.twoStep = (ptp[6] & 0x02) != 0;
+    // correctionField is ns * 2^16
+    msg.correctionNS = (int64_t)NET_TO_CPU_U64(ptp + 8) >> 16;
+    msg.clockID = NET_TO_CPU_U64(ptp + 20);
+    msg.portNum = NET_TO_CPU_U16(ptp + 28);
+    msg.seqID = NET_TO_CPU_U16(ptp + 30);
+
+    msg.timestampNS = 0;
+    if (msg.type != PTP_ANNOUNCE && msgLen >= PTP_HEADER_SIZE + PTP_TIMESTAMP_SIZE) {
+        // 48 bits of seconds, 32 bits of nanoseconds
+        const uint8_t *ts = ptp + PTP_HEADER_SIZE;
+        uint64_t sec = ((uint64_t)NET_TO_CPU_U16(ts) << 32) | NET_TO_CPU_U32(ts + 2);
+        msg.timestampNS = (int64_t)(sec * 1'000'000'000ULL + NET_TO_CPU_U32(ts + 6));
+    }
+    return 0;
+}
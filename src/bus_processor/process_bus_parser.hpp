@@ -2,58 +2,215 @@
 
 #include "common/goose_container.hpp"
 #include "common/sv_container.hpp"
+#include "common/routable_session.hpp"
 #include <rte_byteorder.h>
 
+#include <algorithm>
+
 enum BUS_PROTO
 {
     NON_BUS_PROTO = 0,
     BUS_PROTO_SV,
     BUS_PROTO_GOOSE,
-    /* BUS_PROTO_PTP */
+    BUS_PROTO_PTP
+};
+
+/**
+ * @brief messageType of IEEE 1588-2008, event messages are < 8
+ */
+enum PTP_MSG : uint8_t
+{
+    PTP_SYNC = 0x0,
+    PTP_DELAY_REQ = 0x1,
+    PTP_PDELAY_REQ = 0x2,
+    PTP_PDELAY_RESP = 0x3,
+    PTP_FOLLOW_UP = 0x8,
+    PTP_DELAY_RESP = 0x9,
+    PTP_PDELAY_RESP_FOLLOW_UP = 0xA,
+    PTP_ANNOUNCE = 0xB
+};
+
+/**
+ * @brief Common header of PTPv2 and the timestamp of the message body
+ */
+struct PtpMessage
+{
+    uint8_t     type = 0;
+    uint8_t     domain = 0;
+    bool        twoStep = false;
+    uint16_t    seqID = 0;
+    uint64_t    clockID = 0;        // sourcePortIdentity
+    uint16_t    portNum = 0;
+    int64_t     correctionNS = 0;
+    int64_t     timestampNS = 0;    // origin, preciseOrigin or receive timestamp
+
+    bool IsEvent() const { return type < 8; }
+};
+
+/**
+ * @brief Where GOOSE/SV PDU lies in the frame: L2 frames and R-GOOSE/R-SV
+ * differ only by headers, so both are parsed in place
+ */
+struct BusPduLocation
+{
+    unsigned appid = 0;     // APPID offset
+    unsigned apdu = 0;      // APDU offset
+    unsigned end = 0;       // The end of APDU
+    bool     routable = false;
+};
+
+/**
+ * @brief IEC 62439-3 redundancy tag: PRP trailer(RCT) or HSR tag
+ */
+struct RedundancyTag
+{
+    uint16_t seq = 0;
+    uint8_t  lan = 0;   // 0 - LAN A(HSR port A), 1 - LAN B
+    bool     hsr = false;
 };
 
 class ProcessBusParser
 {
 public:
+    static const uint16_t HSR_ETHER_TYPE = 0x892F;
+    static const uint16_t PRP_SUFFIX = 0x88FB;
+    static const unsigned PRP_TRAILER_SIZE = 6;
+
     static inline
-    unsigned get_appid(const uint8_t* buffer)
+    uint16_t read_be16(const uint8_t* buffer)
     {
-        return RTE_STATIC_BSWAP16(*(uint16_t *)(buffer + 18));
+        return (buffer[0] << 8) | buffer[1];
     }
 
     /**
-     * @function get_proto_type
-     * @brief Is used to get APPID and dispatch GOOSE/SV mbuf to a particular CPU
+     * @function locate_pdu
+     * @brief GOOSE/SV PDU of L2 frames (with or without VLAN), R-GOOSE/R-SV and PTP.
+     * HSR tag is skipped and PRP trailer is cut off, the frame isn't modified.
      */
     static inline
-    BUS_PROTO get_proto_type(const uint8_t* buffer, unsigned *appid)
+    BUS_PROTO locate_pdu(const uint8_t* buffer, unsigned size, BusPduLocation &loc)
     {
-        if (buffer[12] == 0x81 && buffer[13] == 0x00) {
+        if (size < 26) {
+            return NON_BUS_PROTO;
+        }
+
+        unsigned pos = 12;
+        if (buffer[pos] == 0x81 && buffer[pos + 1] == 0x00) {
             // VLAN
-            if (buffer[16] == 0x88 && buffer[17] == 0xBA) {
-                // SV
-                *appid = get_appid(buffer + 18);
-                return BUS_PROTO_SV;
-            }
-            if (buffer[16] == 0x88 && buffer[17] == 0xB8) {
-                // GOOSE
-                *appid = get_appid(buffer + 18);
-                return BUS_PROTO_GOOSE;
-            }
-        }
-        if (buffer[12] == 0x88 && buffer[13] == 0xBA) {
-            // SV without VLAN
-            *appid = get_appid(buffer + 14);
-            return BUS_PROTO_SV;
-        }
-        if (buffer[12] == 0x88 && buffer[13] == 0xB8) {
-            // GOOSE without VLAN
-            *appid = get_appid(buffer + 14);
-            return BUS_PROTO_GOOSE;
+            pos += 4;
+        }
+        uint16_t etherType = read_be16(buffer + pos);
+        pos += 2;
+        if (etherType == HSR_ETHER_TYPE) {
+            // HSR tag: path and LSDU size, sequence number, then the frame's EtherType
+            etherType = read_be16(buffer + pos + 4);
+            pos += 6;
+        }
+
+        if (etherType == 0x88BA || etherType == 0x88B8) {
+            loc.appid = pos;
+            loc.apdu = pos + 8; // APPID, Length, Reserv1, Reserv2
+            loc.end = size - prp_trailer_size(buffer, size);
+            loc.routable = false;
+            return (etherType == 0x88BA) ? BUS_PROTO_SV : BUS_PROTO_GOOSE;
+        }
+        if (etherType == 0x0800) {
+            return locate_routable_pdu(buffer, size, pos, loc);
+        }
+        if (etherType == 0x88F7) {
+            // PTP over Ethernet: no APPID
+            loc.appid = 0;
+            loc.apdu = pos;
+            loc.end = size;
+            loc.routable = false;
+            return BUS_PROTO_PTP;
         }
         return NON_BUS_PROTO;
     }
 
+    /**
+     * @function prp_trailer_size
+     * @brief PRP redundancy control trailer at the end of the frame: sequence
+     * number(2), LAN(4 bits) and LSDU size(12 bits), suffix 0x88FB.
+     * LSDU size is checked with and without VLAN tag, both are met in the field.
+     */
+    static inline
+    unsigned prp_trailer_size(const uint8_t* buffer, unsigned size)
+    {
+        if (size < 60 || read_be16(buffer + size - 2) != PRP_SUFFIX) {
+            return 0;
+        }
+        const uint8_t lan = buffer[size - 4] >> 4;
+        const unsigned lsdu = read_be16(buffer + size - 4) & 0x0FFF;
+        if ((lan != 0xA && lan != 0xB) || (lsdu != size - 12 && lsdu != size - 16)) {
+            return 0;
+        }
+        return PRP_TRAILER_SIZE;
+    }
+
+    /**
+     * @function get_redundancy_tag
+     * @brief HSR tag after the source MAC(or VLAN) or PRP trailer
+     */
+    static inline
+    bool get_redundancy_tag(const uint8_t* buffer, unsigned size, RedundancyTag &tag)
+    {
+        if (size < 26) {
+            return false;
+        }
+        unsigned pos = 12;
+        if (buffer[pos] == 0x81 && buffer[pos + 1] == 0x00) {
+            pos += 4;
+        }
+        if (read_be16(buffer + pos) == HSR_ETHER_TYPE) {
+            tag.seq = read_be16(buffer + pos + 4);
+            tag.lan = (buffer[pos + 2] >> 4) & 0x01;
+            tag.hsr = true;
+            return true;
+        }
+        if (prp_trailer_size(buffer, size) != 0) {
+            tag.seq = read_be16(buffer + size - PRP_TRAILER_SIZE);
+            tag.lan = ((buffer[size - 4] >> 4) == 0xA) ? 0 : 1;
+            tag.hsr = false;
+            return true;
+        }
+        return false;
+    }
+
+    static inline
+    uint64_t get_src_mac(const uint8_t* buffer)
+    {
+        return ((uint64_t)read_be16(buffer + 6) << 32) | ((uint64_t)read_be16(buffer + 8) << 16)
+                                                        | read_be16(buffer + 10);
+    }
+
+    /**
+     * @function get_proto_type
+     * @brief Is used to get APPID and dispatch GOOSE/SV mbuf to a particular CPU
+     */
+    static inline
+    BUS_PROTO get_proto_type(const uint8_t* buffer, unsigned size, unsigned *appid)
+    {
+        BusPduLocation loc;
+        BUS_PROTO type = locate_pdu(buffer, size, loc);
+        if (type == BUS_PROTO_GOOSE || type == BUS_PROTO_SV) {
+            *appid = read_be16(buffer + loc.appid);
+        }
+        return type;
+    }
+
+    /**
+     * @function get_appid
+     * @return APPID of GOOSE/SV or 0 for other frames
+     */
+    static inline
+    unsigned get_appid(const uint8_t* buffer, unsigned size)
+    {
+        unsigned appid = 0;
+        get_proto_type(buffer, size, &appid);
+        return appid;
+    }
+
     /**
      * @function parse_goose_packet
      */
@@ -67,5 +224,65 @@ public:
     static int
     parse_sv_packet(const uint8_t *buffer, int size,
                     SVStreamPassport &passport, SVStreamState &state);
-};
 
+    /**
+     * @function parse_ptp_packet
+     */
+    static int
+    parse_ptp_packet(const uint8_t *buffer, int size, PtpMessage &msg);
+
+private:
+    /**
+     * @brief IPv4/UDP(102) with the 90-5 session header, pos is the IPv4 header.
+     * Fragments and encrypted payloads aren't bus frames, they go to the IP stage.
+     * Only the first payload of SPDU is taken.
+     */
+    static inline
+    BUS_PROTO locate_routable_pdu(const uint8_t* buffer, unsigned size, unsigned pos,
+                                  BusPduLocation &loc)
+    {
+        const uint8_t *ip = buffer + pos;
+        if (size < pos + 20 || (ip[0] >> 4) != 4 || ip[9] != 17 /* UDP */) {
+            return NON_BUS_PROTO;
+        }
+        if (((ip[6] & 0x3F) | ip[7]) != 0) {
+            // More fragments or fragment offset
+            return NON_BUS_PROTO;
+        }
+
+        const unsigned udp = pos + (ip[0] & 0x0F) * 4;
+        const unsigned session = udp + 8;
+        if (size < session + 2 || read_be16(buffer + udp + 2) != RSession::UDP_PORT) {
+            return NON_BUS_PROTO;
+        }
+
+        // The whole session header and the payload's header are in the frame
+        const uint8_t *s = buffer + session;
+        const unsigned apdu = session + RSession::APDU_OFFSET;
+        if (size < apdu) {
+            return NON_BUS_PROTO;
+        }
+        const uint8_t si = s[RSession::SI_OFFSET];
+        if (si != RSession::SI_GOOSE && si != RSession::SI_SV) {
+            return NON_BUS_PROTO;
+        }
+
+        // Payload follows the session header: length(4), type(1), simulation(1), APPID(2), APDU length(2)
+        if (s[1] != RSession::SESSION_LI || s[RSession::COMMON_PI_OFFSET] != RSession::COMMON_PI
+                                         || s[RSession::ENCRYPTION_OFFSET] != 0) {
+            return NON_BUS_PROTO;
+        }
+
+        const uint8_t payloadType = s[RSession::PAYLOAD_TYPE_OFFSET];
+        const BUS_PROTO type = (si == RSession::SI_GOOSE) ? BUS_PROTO_GOOSE : BUS_PROTO_SV;
+        if (payloadType != ((type == BUS_PROTO_GOOSE) ? RSession::PAYLOAD_GOOSE : RSession::PAYLOAD_SV)) {
+            return NON_BUS_PROTO;
+        }
+
+        loc.appid = apdu - 4;
+        loc.apdu = apdu;
+        loc.end = std::min(size, apdu + read_be16(buffer + apdu - 2));
+        loc.routable = true;
+        return type;
+    }
+};
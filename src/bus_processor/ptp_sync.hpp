@@ -0,0 +1,145 @@
+#pragma once
+
+#include "process_bus_parser.hpp"
+#include "common/ptp_clock.hpp"
+#include "dpdk_cpp/dpdk_clocks_class.hpp"
+
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+
+#include <ctime>
+
+/**
+ * @class PtpSync
+ * @brief Slave side of PTP over Ethernet: Sync(+Follow_Up) of the master gives
+ * t1, RX hardware timestamp of Sync gives t2, so PTP time of the TSC moment
+ * is a sample for PtpClock.
+ *
+ * t2 is in NIC's clock, it's turned into TSC by reading NIC's clock between two
+ * TSC reads when Sync is processed. Without hardware timestamps(replay, NIC without
+ * IEEE1588) the processing moment is taken, so the RX latency adds to the offset.
+ * Delay_Req isn't sent, the mean path delay is configured.
+ */
+class PtpSync
+{
+public:
+    struct Config
+    {
+        bool        hwTimestamp = false;
+        uint8_t     domain = 0;
+        int64_t     pathDelayNS = 0;
+    };
+
+    explicit PtpSync(PtpClock &clock) : m_clock(clock) {}
+
+    void Configure(const Config &conf) { m_conf = conf; }
+
+    inline void Process(const PtpMessage &msg, rte_mbuf *mbuf) {
+        // The timestamp is latched by NIC for each event message, it must be read out
+        int64_t rxAgeNS = -1;
+        uint64_t tsc = 0;
+        if (msg.IsEvent()) {
+            rxAgeNS = ReadRxAge(mbuf, tsc);
+        }
+
+        if (msg.domain != m_conf.domain) {
+            ++m_otherCnt;
+            return;
+        }
+        if (m_masterID == 0 && msg.type == PTP_SYNC) {
+            m_masterID = msg.clockID;
+        }
+        if (msg.clockID != m_masterID) {
+            ++m_otherCnt;
+            return;
+        }
+
+        switch (msg.type) {
+        case PTP_SYNC: {
+            ++m_syncCnt;
+            if (!msg.twoStep) {
+                AddSample(tsc, rxAgeNS, msg.timestampNS + msg.correctionNS);
+                break;
+            }
+            if (m_pending.valid) {
+                ++m_lostFollowUpCnt;
+            }
+            m_pending = Pending{ true, msg.seqID, tsc, rxAgeNS, msg.correctionNS };
+            break;
+        }
+        case PTP_FOLLOW_UP: {
+            if (m_pending.valid && m_pending.seqID == msg.seqID) {
+                AddSample(m_pending.tsc, m_pending.rxAgeNS,
+                          msg.timestampNS + msg.correctionNS + m_pending.correctionNS);
+                m_pending.valid = false;
+            }
+            break;
+        }
+        default: {
+            ++m_otherCnt;
+            break;
+        }
+        }
+    }
+
+    const PtpClock& GetClock() const { return m_clock; }
+    uint64_t GetMasterID() const { return m_masterID; }
+    uint64_t GetSyncNum() const { return m_syncCnt; }
+    uint64_t GetHwTimestampNum() const { return m_hwTsCnt; }
+    uint64_t GetLostFollowUpNum() const { return m_lostFollowUpCnt; }
+    uint64_t GetOtherNum() const { return m_otherCnt; }
+
+private:
+    /**
+     * @brief Time since the frame's reception and the TSC moment of it
+     */
+    inline int64_t ReadRxAge(rte_mbuf *mbuf, uint64_t &tsc) {
+        if (m_conf.hwTimestamp && (mbuf->ol_flags & RTE_MBUF_F_RX_IEEE1588_TMST)) {
+            timespec rxTime = {}, nicNow = {};
+            // The clock of the port which received the frame
+            if (rte_eth_timesync_read_rx_timestamp(mbuf->port, &rxTime, mbuf->timesync) == 0) {
+                uint64_t before = DPDK::Clocks::get_current_ticks();
+                int retval = rte_eth_timesync_read_time(mbuf->port, &nicNow);
+                uint64_t after = DPDK::Clocks::get_current_ticks();
+                if (retval == 0) {
+                    ++m_hwTsCnt;
+                    tsc = before + (after - before) / 2;
+                    return ToNS(nicNow) - ToNS(rxTime);
+                }
+            }
+        }
+        tsc = DPDK::Clocks::get_current_ticks();
+        return 0;
+    }
+
+    inline void AddSample(uint64_t tsc, int64_t rxAgeNS, int64_t masterNS) {
+        if (rxAgeNS < 0 || masterNS <= 0) {
+            return;
+        }
+        m_clock.Update(tsc, masterNS + m_conf.pathDelayNS + rxAgeNS);
+    }
+
+    static inline int64_t ToNS(const timespec &ts) {
+        return (int64_t)ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+    }
+
+private:
+    struct Pending
+    {
+        bool        valid = false;
+        uint16_t    seqID = 0;
+        uint64_t    tsc = 0;
+        int64_t     rxAgeNS = 0;
+        int64_t     correctionNS = 0;
+    };
+
+    PtpClock&   m_clock;
+    Config      m_conf;
+    Pending     m_pending;
+    uint64_t    m_masterID = 0;
+
+    uint64_t    m_syncCnt = 0,
+                m_hwTsCnt = 0,
+                m_lostFollowUpCnt = 0,
+                m_otherCnt = 0;
+};
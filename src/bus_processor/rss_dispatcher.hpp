@@ -0,0 +1,156 @@
+#pragma once
+
+#include "pipeline_pbus.hpp"
+#include "process_bus_parser.hpp"
+
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class RssDispatcher
+ * @brief Main lcore of RSS mode: frames go to the worker rings by APPID, so
+ * a stream always stays on the same worker. A full ring doesn't leak mbufs,
+ * the leftovers of a partial enqueue are handled by the overload policy and
+ * counted. Ring occupancy high-water marks show how close a worker is to it.
+ *
+ * Stream state lives on its worker, so GOOSE/SV/PTP are never moved to
+ * another one. Only frames without state(IP and the rest) may spill over.
+ */
+class RssDispatcher
+{
+public:
+    enum Policy
+    {
+        DROP_NEWEST = 0,    // Leftovers are freed
+        DROP_SV_FIRST,      // GOOSE, PTP and the rest are enqueued before SV
+        SPILL               // Frames without state go to the next worker
+    };
+
+    struct WorkerStat
+    {
+        uint64_t    enqueued = 0;
+        uint64_t    dropped = 0;
+        uint64_t    spilled = 0;    // Taken by the next worker
+        unsigned    highWater = 0;  // Max ring occupancy after an enqueue
+        unsigned    capacity = 0;
+    };
+
+    using Frame = Pipeline::Frame< rte_mbuf, RX_FRAME_SIZE >;
+
+    RssDispatcher(const std::vector< rte_ring* > &rings, Policy policy)
+        : m_policy(policy)
+    {
+        if (rings.empty() || (rings.size() & (rings.size() - 1)) != 0) {
+            throw std::invalid_argument("RSS workers must be 2^N: " + std::to_string(rings.size()));
+        }
+        m_workers.resize(rings.size());
+        for (size_t i=0;i<rings.size();++i) {
+            m_workers[i].ring = rings[i];
+            m_workers[i].stat.capacity = rte_ring_get_capacity(rings[i]);
+        }
+        m_mask = rings.size() - 1;
+    }
+
+    /**
+     * @brief The frame waits for Flush in the queue of its worker
+     */
+    inline void Put(rte_mbuf *m, const uint8_t *packet, unsigned size) {
+        unsigned appid = 0;
+        const BUS_PROTO type = ProcessBusParser::get_proto_type(packet, size, &appid);
+        Worker &w = m_workers[appid & m_mask];
+
+        const bool tail = (m_policy == DROP_SV_FIRST && type == BUS_PROTO_SV)
+                          || (m_policy == SPILL && type == NON_BUS_PROTO);
+        (tail ? w.tail : w.head).PutBuffer(m);
+    }
+
+    /**
+     * @brief Queues go to the rings, the tail of each queue is the first to be
+     * dropped(or spilled) when the ring is full. Every worker takes its own
+     * frames before leftovers spill, so they never push out its GOOSE/SV.
+     */
+    inline void Flush() {
+        for (Worker &w : m_workers) {
+            if (w.head.num > 0) {
+                unsigned sent = Enqueue(w, w.head.buf, w.head.num);
+                Drop(w, w.head.buf + sent, w.head.num - sent);
+                w.head.num = 0;
+            }
+            w.tailSent = 0;
+            if (w.tail.num > 0) {
+                w.tailSent = Enqueue(w, w.tail.buf, w.tail.num);
+            }
+        }
+
+        for (unsigned i=0;i<m_workers.size();++i) {
+            Worker &w = m_workers[i];
+            if (w.tail.num == 0) {
+                continue;
+            }
+            unsigned sent = w.tailSent;
+            if (m_policy == SPILL && sent < w.tail.num) {
+                Worker &sibling = m_workers[(i + 1) & m_mask];
+                unsigned spilled = Enqueue(sibling, w.tail.buf + sent, w.tail.num - sent);
+                w.stat.spilled += spilled;
+                sent += spilled;
+            }
+            Drop(w, w.tail.buf + sent, w.tail.num - sent);
+            w.tail.num = 0;
+        }
+    }
+
+    Policy GetPolicy() const { return m_policy; }
+    unsigned GetWorkerNum() const { return m_workers.size(); }
+    const WorkerStat& GetStat(unsigned idx) const { return m_workers[idx].stat; }
+
+    static const char* GetPolicyName(Policy policy) {
+        constexpr const char* NAMES[] = { "drop-newest", "drop-sv", "spill" };
+        return NAMES[policy];
+    }
+
+    static Policy ParsePolicy(const std::string &name) {
+        for (Policy policy : { DROP_NEWEST, DROP_SV_FIRST, SPILL }) {
+            if (name == GetPolicyName(policy)) {
+                return policy;
+            }
+        }
+        throw std::invalid_argument("Unknown RSS overload policy: " + name);
+    }
+
+private:
+    struct Worker
+    {
+        rte_ring*   ring = nullptr;
+        Frame       head, tail;
+        unsigned    tailSent = 0;   // Of the current flush
+        WorkerStat  stat;
+    };
+
+    static inline unsigned Enqueue(Worker &w, rte_mbuf **bufs, unsigned num) {
+        unsigned freeSpace = 0;
+        unsigned sent = rte_ring_sp_enqueue_burst(w.ring, (void * const *)bufs, num, &freeSpace);
+        const unsigned used = w.stat.capacity - freeSpace;
+        if (used > w.stat.highWater) {
+            w.stat.highWater = used;
+        }
+        w.stat.enqueued += sent;
+        return sent;
+    }
+
+    static inline void Drop(Worker &w, rte_mbuf **bufs, unsigned num) {
+        if (num > 0) {
+            rte_pktmbuf_free_bulk(bufs, num);
+            w.stat.dropped += num;
+        }
+    }
+
+private:
+    Policy                  m_policy = DROP_NEWEST;
+    std::vector< Worker >   m_workers;
+    size_t                  m_mask = 0;
+};
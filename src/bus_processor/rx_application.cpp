@@ -4,15 +4,223 @@
 #include "dpdk_cpp/dpdk_poolsetter_class.hpp"
 #include "dpdk_cpp/dpdk_mempool_class.hpp"
 #include "dpdk_cpp/dpdk_info_class.hpp"
+#include "dpdk_cpp/dpdk_eventdev_class.hpp"
 
 #include "cxxopts.hpp"
-#include "pipeline_pbus.hpp"
+#include "pcap_replay.hpp"
+#include "bus_flow_filter.hpp"
+
+#include <rte_bus_vdev.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
 
 // TODO: Remove g_doWork
 extern volatile bool g_doWork;
 
 namespace 
 {
+    /**
+     * @brief RX from a queue of NIC's ports: a burst polls them round-robin,
+     * the next burst starts from the next port
+     */
+    struct EthRxSource
+    {
+        std::vector< uint16_t > port_ids;
+        uint16_t queue_id = 0;
+        unsigned next = 0;
+
+        inline uint16_t RxBurst(rte_mbuf **bufs, uint16_t num) {
+            const unsigned portNum = port_ids.size();
+            uint16_t rxNum = 0;
+            for (unsigned k=0;k<portNum && rxNum < num;++k) {
+                rxNum += rte_eth_rx_burst(port_ids[next], queue_id, bufs + rxNum, num - rxNum);
+                next = (next + 1 < portNum) ? (next + 1) : 0;
+            }
+            return rxNum;
+        }
+        inline bool IsFinished() const { return false; }
+    };
+
+    void start_port(DPDK::Port &eth)
+    {
+        eth.SetAllMulticast();
+        eth.Start();
+        if (!eth.WaitLink(10)) {
+            g_doWork = false;
+
+            throw std::runtime_error("Link is still down after 10 sec...");
+        }
+    }
+
+    void add_port_stats(rte_eth_stats &sum, const rte_eth_stats &port)
+    {
+        sum.ipackets += port.ipackets;
+        sum.opackets += port.opackets;
+        sum.ibytes += port.ibytes;
+        sum.obytes += port.obytes;
+        sum.imissed += port.imissed;
+        sum.ierrors += port.ierrors;
+        sum.oerrors += port.oerrors;
+        sum.rx_nombuf += port.rx_nombuf;
+    }
+
+    /**
+     * @brief AF_XDP port of the interface: the XDP program redirects ProcessBus
+     * frames of the queue to the socket, the rest of traffic stays in the kernel
+     */
+    uint16_t create_xdp_port(unsigned idx, const std::string &iface, unsigned queue,
+                             const std::string &prog)
+    {
+        std::string name = std::format("net_af_xdp{}", idx);
+        std::string args = std::format("iface={},start_queue={},queue_count=1,xdp_prog={}",
+                                       iface, queue, prog);
+        if (rte_vdev_init(name.c_str(), args.c_str()) != 0) {
+            throw std::runtime_error("Can't create AF_XDP port: " + name + " " + args);
+        }
+
+        uint16_t portID = 0;
+        if (rte_eth_dev_get_port_by_name(name.c_str(), &portID) != 0) {
+            throw std::runtime_error("AF_XDP port isn't found: " + name);
+        }
+        return portID;
+    }
+
+    /**
+     * @brief Allow rules for configured GOOSE/SV, the rest is dropped by NIC
+     */
+    void subscribe_streams(BusFlowFilter &filter, const GooseContainer &gooseMap, const SVContainer &svMap)
+    {
+        for (const auto &src : gooseMap) {
+            if (!filter.Subscribe(src.second->GetDMAC(), BusFlowFilter::GOOSE_ETHER_TYPE,
+                                  src.second->GetAppID())) {
+                return;
+            }
+        }
+        for (const auto &src : svMap) {
+            if (!filter.Subscribe(src.second->GetDMAC(), BusFlowFilter::SV_ETHER_TYPE,
+                                  src.second->GetAppID())) {
+                return;
+            }
+        }
+    }
+
+    void print_lcore_row(const std::string &label, const DPDK::CyclicStat &st, uint64_t pktNum)
+    {
+        double cyclesPerPkt = (pktNum > 0) ? (double)st.GetProcessTicks() / pktNum : 0.0;
+        Console::CyclicStat::PrintTableRow(label, st)
+                                << std::format(" {:<10} | {:<10.1f} |\n", pktNum, cyclesPerPkt);
+    }
+
+    void print_rx_summary(const EthRxSource &src, const DPDK::CyclicStat &st, uint64_t pktNum)
+    {
+        double sec = (double)st.GetCyclingTicks() / DPDK::Clocks::get_ticks_per_sec();
+        double mpps = (sec > 0.0) ? pktNum / sec / 1'000'000.0 : 0.0;
+
+        rte_eth_stats sum = {};
+        for (uint16_t port_id : src.port_ids) {
+            rte_eth_stats stats = {};
+            if (rte_eth_stats_get(port_id, &stats) == 0) {
+                add_port_stats(sum, stats);
+            }
+        }
+        std::cout << std::format("\nRX: Ports = {}, Packets = {}, Time = {:.3f} sec, Rate = {:.3f} Mpps, "
+                                 "Missed = {}, NoMbuf = {}\n",
+                                 src.port_ids.size(), pktNum, sec, mpps, sum.imissed, sum.rx_nombuf)
+                  << std::endl;
+    }
+
+    void print_rx_summary(const PcapReplay &src, const DPDK::CyclicStat &st, uint64_t pktNum)
+    {
+        double sec = (double)st.GetCyclingTicks() / DPDK::Clocks::get_ticks_per_sec();
+        double mpps = (sec > 0.0) ? pktNum / sec / 1'000'000.0 : 0.0;
+
+        std::cout << std::format("\nReplay: Loops = {}, Packets = {}, Time = {:.3f} sec, Rate = {:.3f} Mpps\n",
+                                 src.GetLoops(), pktNum, sec, mpps)
+                  << std::endl;
+    }
+
+    void print_dispatcher_stat(const RssDispatcher &dispatcher, const std::vector< LCoreProcessor > &lcoreWorker)
+    {
+        std::cout << std::format("\n {:<10} | {:<12} | {:<12} | {:<12} | {:<16} |\n",
+                                 "Ring", "Enqueued", "Dropped", "Spilled", "High-water")
+                  << std::string(77, '-')
+                  << std::endl;
+        for (unsigned i=0;i<dispatcher.GetWorkerNum();++i) {
+            const RssDispatcher::WorkerStat &st = dispatcher.GetStat(i);
+            std::cout << std::format(" {:<10} | {:<12} | {:<12} | {:<12} | {:<16} |\n",
+                                     "LCore" + std::to_string(lcoreWorker[i].m_lcore),
+                                     st.enqueued, st.dropped, st.spilled,
+                                     std::format("{}/{}", st.highWater, st.capacity));
+        }
+    }
+
+    void print_finish_delimiter()
+    {
+        std::cout << std::format("\n\n{:*<80}\n{:*^80}\n{:*<80}\n\n",
+                                 "", " FINISH ", "");
+    }
+
+    rte_ring* create_worker_ring(unsigned lcore, unsigned size)
+    {
+        std::string ringName = "lcore_" + std::to_string(lcore);
+        rte_ring *ring = rte_ring_create(ringName.c_str(),
+                                         size,
+                                         rte_socket_id(),
+                                         RING_F_SP_ENQ | RING_F_SC_DEQ);
+        if (ring == nullptr) {
+            throw std::runtime_error("Can't create ring for lcoreWorker: " + ringName);
+        }
+        return ring;
+    }
+
+    /**
+     * @brief Source is over: let workers drain their rings
+     */
+    void wait_workers_drained(const std::vector< LCoreProcessor > &lcoreWorker)
+    {
+        for (const auto &w : lcoreWorker) {
+            while (g_doWork && !rte_ring_empty(w.m_ring)) {
+                rte_pause();
+            }
+        }
+    }
+
+    /**
+     * @brief Fill the frame by bursts: while the previous burst was full the
+     * next one goes to the same pipeline pass, idle RX is a single burst.
+     * Each burst's size goes to the lcore's distribution.
+     * @return The number of received packets
+     */
+    template< typename TRxSource >
+    inline unsigned rx_frame(TRxSource &src, rte_mbuf **bufs, unsigned capacity, BurstStat &burst)
+    {
+        unsigned num = src.RxBurst(bufs, RX_BURST_SIZE);
+        unsigned last = num;
+        burst.Record(last);
+        while (last == RX_BURST_SIZE && num + RX_BURST_SIZE <= capacity) {
+            last = src.RxBurst(bufs + num, RX_BURST_SIZE);
+            num += last;
+            burst.Record(last);
+        }
+        return num;
+    }
+
+    /**
+     * @brief States of the lcore's quiet streams which waited for the limit are processed
+     */
+    inline void expire_reorder(PBus::PendingReorder *pending)
+    {
+        if (pending != nullptr && !pending->IsEmpty()) {
+            pending->Expire(DPDK::Clocks::get_current_ticks());
+        }
+    }
+
+    /**
+     * @brief Worker: frames from its ring go to TStageIdx frame and through TChain
+     */
+    template< unsigned TStageIdx, typename TChain >
     int lcore_processor(void *arg)
     {
         LCoreProcessor *conf = reinterpret_cast< LCoreProcessor* >(arg);
@@ -27,23 +235,37 @@ namespace
         ASM_MARKER(lcore_processing);
 
         // Pipeline definition
-        PBus::DataMatrix matrix(conf->m_app);
+        PBus::DataMatrix &matrix = *conf->m_app->m_matrix[conf->m_lcore];
+
+        JitterDetector *jitter = conf->m_app->GetJitter();
+        BurstStat &burst = conf->m_app->GetRxBurst();
+        burst.SetMaxBurst(RX_FRAME_SIZE);
+        PBus::PendingReorder *pending = conf->m_app->GetReorderPending();
 
         conf->m_procStat.MarkStartCycling();
         while (g_doWork) {
+            if (jitter != nullptr) {
+                jitter->Poll(DPDK::Clocks::get_current_ticks());
+            }
+            expire_reorder(pending);
             uint16_t rxNum = rte_ring_sc_dequeue_burst(conf->m_ring,
-                                                       (void **)matrix.stages[PBus::START_STAGE].buf,
-                                                       RX_BURST_SIZE,
+                                                       (void **)matrix.stages[TStageIdx].buf,
+                                                       RX_FRAME_SIZE,
                                                        nullptr);
+            burst.Record(rxNum);
             if (rxNum > 0) {
                 conf->m_procStat.MarkProcBegin();
 
                 // Processing pipeline
-                matrix.stages[PBus::START_STAGE].num = rxNum;
-                PBus::FramePipeline::run(matrix);
-                rte_pktmbuf_free_bulk(matrix.stages[PBus::START_STAGE].buf, rxNum);
+                matrix.stages[TStageIdx].num = rxNum;
+                TChain::run(matrix);
+                rte_pktmbuf_free_bulk(matrix.stages[TStageIdx].buf, rxNum);
 
-                conf->m_procStat.MarkProcEnd();
+                const uint64_t procTicks = conf->m_procStat.MarkProcEnd();
+                if (jitter != nullptr) {
+                    jitter->RecordWork(procTicks);
+                }
+                conf->m_rxPktCnt += rxNum;
             }
         }
         conf->m_procStat.MarkFinishCycling();
@@ -51,144 +273,411 @@ namespace
         return 0;
     }
 
-    void single_core(RX_Application &app, DPDK::Port &eth, uint16_t queue_id)
+    /**
+     * @brief Eventdev worker: events of its port go to TStageIdx frame and through
+     * TChain. The flows of a burst are held by the worker until its next dequeue.
+     */
+    template< unsigned TStageIdx, typename TChain >
+    int lcore_event_processor(void *arg)
     {
-        // Start NIC port
-        eth.SetAllMulticast();
-        eth.Start();
-        if (!eth.WaitLink(10)) {
+        LCoreProcessor *conf = reinterpret_cast< LCoreProcessor* >(arg);
+        if (conf == nullptr) {
             g_doWork = false;
-
-            throw std::runtime_error("Link is still down after 10 sec...");
+            std::cerr << "LCore: Config is NULL!" << std::endl;
+            return -1;
         }
 
-        std::cout << "\n\tStart main loop" << std::endl;
-        /* set_thread_priority(DEF_PROCESS_PRIORITY); */
-        ASM_MARKER(signle_core_processing);
+        PBus::DataMatrix &matrix = *conf->m_app->m_matrix[conf->m_lcore];
+        rte_event events[RX_FRAME_SIZE];
 
-        // Pipeline definition
-        PBus::DataMatrix matrix(&app);
+        JitterDetector *jitter = conf->m_app->GetJitter();
+        // Bursts are limited by the port's dequeue depth
+        BurstStat &burst = conf->m_app->GetRxBurst();
+        burst.SetMaxBurst(RX_BURST_SIZE);
 
-        // Main cycle
-        DPDK::CyclicStat procStat;
-        procStat.MarkStartCycling();
+        conf->m_procStat.MarkStartCycling();
         while (g_doWork) {
-            uint16_t rxNum = rte_eth_rx_burst(eth.GetID(), queue_id,
-                                              matrix.stages[PBus::START_STAGE].buf,
-                                              RX_BURST_SIZE);
+            if (jitter != nullptr) {
+                jitter->Poll(DPDK::Clocks::get_current_ticks());
+            }
+            uint16_t rxNum = rte_event_dequeue_burst(conf->m_eventDev, conf->m_eventPort,
+                                                     events, RX_FRAME_SIZE, 0);
+            burst.Record(rxNum);
+            if (rxNum > 0) {
+                conf->m_procStat.MarkProcBegin();
+
+                // Processing pipeline
+                typename PBus::DataMatrix::Frame &frame = matrix.stages[TStageIdx];
+                for (unsigned i=0;i<rxNum;++i) {
+                    frame.buf[i] = events[i].mbuf;
+                }
+                frame.num = rxNum;
+                TChain::run(matrix);
+                rte_pktmbuf_free_bulk(frame.buf, rxNum);
+
+                const uint64_t procTicks = conf->m_procStat.MarkProcEnd();
+                if (jitter != nullptr) {
+                    jitter->RecordWork(procTicks);
+                }
+                __atomic_store_n(&conf->m_rxPktCnt, conf->m_rxPktCnt + rxNum, __ATOMIC_RELEASE);
+            }
+        }
+        conf->m_procStat.MarkFinishCycling();
+
+        return 0;
+    }
+
+    /**
+     * @brief RX lcore: bursts from the source through TChain until the source is over
+     * @return The number of received packets
+     */
+    template< typename TChain, typename TRxSource >
+    uint64_t rx_cycle(PBus::DataMatrix &matrix, TRxSource &src, DPDK::CyclicStat &procStat)
+    {
+        uint64_t rxPktCnt = 0;
+        JitterDetector *jitter = matrix.app->GetJitter();
+        BurstStat &burst = matrix.app->GetRxBurst();
+        burst.SetMaxBurst(RX_BURST_SIZE);
+        PBus::PendingReorder *pending = matrix.app->GetReorderPending();
+        procStat.MarkStartCycling();
+        while (g_doWork && !src.IsFinished()) {
+            if (jitter != nullptr) {
+                jitter->Poll(DPDK::Clocks::get_current_ticks());
+            }
+            expire_reorder(pending);
+            unsigned rxNum = rx_frame(src, matrix.stages[PBus::START_STAGE].buf, RX_FRAME_SIZE, burst);
             if (rxNum > 0) {
                 procStat.MarkProcBegin();
 
                 // Processing pipeline
                 matrix.stages[PBus::START_STAGE].num = rxNum;
-                PBus::FramePipeline::run(matrix);
+                TChain::run(matrix);
                 rte_pktmbuf_free_bulk(matrix.stages[PBus::START_STAGE].buf, rxNum);
 
-                procStat.MarkProcEnd();
+                const uint64_t procTicks = procStat.MarkProcEnd();
+                if (jitter != nullptr) {
+                    jitter->RecordWork(procTicks);
+                }
+                rxPktCnt += rxNum;
             }
         }
+        return rxPktCnt;
+    }
+
+    template< typename TRxSource >
+    void single_core(RX_Application &app, TRxSource &src)
+    {
+        std::cout << "\n\tStart main loop" << std::endl;
+        /* set_thread_priority(DEF_PROCESS_PRIORITY); */
+        ASM_MARKER(signle_core_processing);
+
+        // Main cycle
+        DPDK::CyclicStat procStat;
+        uint64_t rxPktCnt = rx_cycle< PBus::FramePipeline >(*app.m_matrix[rte_lcore_id()], src, procStat);
         procStat.MarkFinishCycling();
 
-        // Finish delimiter
-        std::cout << std::format("\n\n{:*<80}\n{:*^80}\n{:*<80}\n\n",
-                                 "", " FINISH ", "");
+        print_finish_delimiter();
 
         // Processing time
-        Console::CyclicStat::PrintTableHeader();
-        Console::CyclicStat::PrintTableRow("Main", procStat) << "\n";
+        Console::CyclicStat::PrintTableHeader({"Packets", "Cycles/pkt"});
+        print_lcore_row("Main", procStat, rxPktCnt);
+        print_rx_summary(src, procStat, rxPktCnt);
+
+        app.DisplayStageStat();
+        app.DisplayRxBurst(false);
+        app.DisplayJitter(true);
     }
 
-    void multi_core_rss(RX_Application &app, DPDK::Port &eth, uint16_t queue_id)
+    /**
+     * @brief Stage per lcore: Router on the main lcore, GOOSE on the first
+     * worker, SV on the rest of workers (shared by APPID)
+     */
+    template< typename TRxSource >
+    void multi_stage(RX_Application &app, TRxSource &src)
     {
-        const unsigned WORKER_RING_SIZE = 16 * 1024;
+        const unsigned svWorkerNum = rte_lcore_count() - 2;
+        if (rte_lcore_count() < 3 || (svWorkerNum & (svWorkerNum - 1)) != 0
+                                  || svWorkerNum > PBus::StageLink::MAX_RINGS) {
+            throw std::runtime_error("Pipelined mode requires 2 + 2^N lcores (N <= 3), lcores: "
+                                     + std::to_string(rte_lcore_count()));
+        }
 
-        // Pipeline workers
+        // Stage workers
         std::vector< LCoreProcessor > lcoreWorker;
         lcoreWorker.reserve(rte_lcore_count());
 
-        unsigned lcore = 0, wIndex = 0;
+        unsigned lcore = 0;
         RTE_LCORE_FOREACH_WORKER(lcore) {
-            std::string ringName = "lcore_" + std::to_string(lcore);
-            rte_ring *ring = rte_ring_create(ringName.c_str(),
-                                             WORKER_RING_SIZE,
-                                             rte_socket_id(),
-                                             RING_F_SP_ENQ | RING_F_SC_DEQ);
-            if (ring == nullptr) {
-                throw std::runtime_error("Can't create ring for lcoreWorker: " + ringName);
-            }
+            rte_ring *ring = create_worker_ring(lcore, app.m_workerRingSize);
+            PBus::StageLink &link = app.m_stageLink[lcoreWorker.empty() ? PBus::GOOSE : PBus::SV];
+            link.rings[link.num] = ring;
+            ++link.num;
 
             lcoreWorker.push_back(LCoreProcessor(ring, &app, lcore));
-            rte_eal_remote_launch(lcore_processor, &lcoreWorker[wIndex], lcore);
-            ++wIndex;
         }
-        const unsigned workerNum = lcoreWorker.size();
+        for (unsigned i=0;i<lcoreWorker.size();++i) {
+            lcore_function_t *fn = (i == 0) ? lcore_processor< PBus::GOOSE, PBus::GoosePipeline >
+                                            : lcore_processor< PBus::SV, PBus::SVPipeline >;
+            rte_eal_remote_launch(fn, &lcoreWorker[i], lcoreWorker[i].m_lcore);
+        }
 
-        // Start NIC port
-        eth.SetAllMulticast();
-        eth.Start();
-        if (!eth.WaitLink(10)) {
-            g_doWork = false;
+        std::cout << std::format("\n\tStart main loop with stage workers: GOOSE = 1, SV = {}\n",
+                                 svWorkerNum)
+                  << std::endl;
+        /* set_thread_priority(DEF_PROCESS_PRIORITY); */
+        ASM_MARKER(multi_stage_processing);
 
-            throw std::runtime_error("Link is still down after 10 sec...");
+        // Main cycle
+        DPDK::CyclicStat procStat;
+        uint64_t rxPktCnt = rx_cycle< PBus::RouterPipeline >(*app.m_matrix[rte_lcore_id()], src, procStat);
+
+        wait_workers_drained(lcoreWorker);
+        procStat.MarkFinishCycling();
+
+        g_doWork = false;
+        rte_eal_mp_wait_lcore();
+
+        print_finish_delimiter();
+
+        // Display processing time
+        Console::CyclicStat::PrintTableHeader({"Packets", "Cycles/pkt"});
+        print_lcore_row("Main Router", procStat, rxPktCnt);
+        for (unsigned i=0;i<lcoreWorker.size();++i) {
+            const LCoreProcessor &w = lcoreWorker[i];
+            std::string label = std::format("LCore{} {}", w.m_lcore, (i == 0) ? "GOOSE" : "SV");
+            print_lcore_row(label, w.m_procStat, w.m_rxPktCnt);
         }
+        std::cout << std::format("\nStage ring drops: GOOSE = {}, SV = {}\n",
+                                 app.m_stageLink[PBus::GOOSE].dropCnt,
+                                 app.m_stageLink[PBus::SV].dropCnt);
+        print_rx_summary(src, procStat, rxPktCnt);
+
+        app.DisplayStageStat();
+        app.DisplayRxBurst(false);
+        app.DisplayJitter(true);
+    }
 
-        std::cout << "\n\tStart main loop with workers: " << workerNum << std::endl;
-        /* set_thread_priority(DEF_PROCESS_PRIORITY); */
+    /**
+     * @brief RSS by the event device: a frame is an atomic event of the flow = APPID,
+     * so a stream is processed by one worker at a time, but any worker takes it.
+     * The main lcore receives, enqueues and runs the scheduler.
+     */
+    template< typename TRxSource >
+    void multi_core_eventdev(RX_Application &app, TRxSource &src)
+    {
+        const unsigned workerNum = rte_lcore_count() - 1;
+        if (workerNum == 0) {
+            throw std::runtime_error("Eventdev mode requires at least 2 lcores");
+        }
+        DPDK::EventDev eventDev("event_sw0", workerNum, RX_BURST_SIZE, app.m_workerRingSize);
 
-        // Workers' queues
-        struct {
-            rte_mbuf* buff[RX_BURST_SIZE] = {};
-            unsigned  num = 0;
+        // Pipeline workers
+        std::vector< LCoreProcessor > lcoreWorker;
+        lcoreWorker.reserve(workerNum);
 
-            inline void Put(rte_mbuf *buf) {
-                buff[num] = buf;
-                ++num;
-            }
-        } workerQueue[RTE_MAX_LCORE] = {};
+        unsigned lcore = 0;
+        RTE_LCORE_FOREACH_WORKER(lcore) {
+            LCoreProcessor w(nullptr, &app, lcore);
+            w.m_eventDev = eventDev.GetID();
+            w.m_eventPort = eventDev.GetWorkerPort(lcoreWorker.size());
+            lcoreWorker.push_back(w);
+        }
+        for (auto &w : lcoreWorker) {
+            rte_eal_remote_launch(lcore_event_processor< PBus::START_STAGE, PBus::FramePipeline >,
+                                  &w, w.m_lcore);
+        }
+
+        std::cout << std::format("\n\tStart main loop with eventdev workers: {}\n", workerNum)
+                  << std::endl;
 
         // Main cycle
+        uint64_t rxPktCnt = 0, enqueuedCnt = 0, droppedCnt = 0;
         DPDK::CyclicStat procStat;
         procStat.MarkStartCycling();
-        rte_mbuf* bufs[RX_BURST_SIZE] = { 0 };
-        while (g_doWork) {
-            uint16_t rxNum = rte_eth_rx_burst(eth.GetID(), queue_id, bufs, RX_BURST_SIZE);
+        rte_mbuf* bufs[RX_FRAME_SIZE] = { 0 };
+        rte_event events[RX_FRAME_SIZE];
+        const uint8_t devID = eventDev.GetID(), port = eventDev.GetProducerPort();
+        const uint16_t burstSize = eventDev.GetBurstSize();
+        DuplicateDiscard *dupDiscard = app.GetDupDiscard();
+        JitterDetector *jitter = app.GetJitter();
+        BurstStat &burst = app.GetRxBurst();
+        burst.SetMaxBurst(RX_BURST_SIZE);
+        while (g_doWork && !src.IsFinished()) {
+            if (jitter != nullptr) {
+                jitter->Poll(DPDK::Clocks::get_current_ticks());
+            }
+            unsigned rxNum = rx_frame(src, bufs, RX_FRAME_SIZE, burst);
             if (rxNum > 0) {
                 procStat.MarkProcBegin();
 
+                unsigned evNum = 0;
                 for (unsigned i=0;i<rxNum;++i) {
-                    /* rte_prefetch0(bufs[i]); */
                     const uint8_t *packet = rte_pktmbuf_mtod(bufs[i], const uint8_t *);
+                    const unsigned size = rte_pktmbuf_data_len(bufs[i]);
+                    if (PBus::is_duplicate(dupDiscard, packet, size)) {
+                        rte_pktmbuf_free(bufs[i]);
+                        continue;
+                    }
 
-                    unsigned appid = ProcessBusParser::get_appid(packet);
-                    unsigned idx = appid & (workerNum - 1);
+                    rte_event &ev = events[evNum++];
+                    ev.event = 0;
+                    ev.flow_id = ProcessBusParser::get_appid(packet, size);
+                    ev.op = RTE_EVENT_OP_NEW;
+                    ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+                    ev.queue_id = DPDK::EventDev::QUEUE_ID;
+                    ev.event_type = RTE_EVENT_TYPE_CPU;
+                    ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+                    ev.mbuf = bufs[i];
+                }
 
-                    workerQueue[idx].Put(bufs[i]);
+                // The port takes a burst at once, a refused one gets a scheduler pass to retry
+                unsigned sent = 0;
+                bool retried = false;
+                while (sent < evNum) {
+                    const uint16_t num = std::min< unsigned >(burstSize, evNum - sent);
+                    const uint16_t n = rte_event_enqueue_new_burst(devID, port, events + sent, num);
+                    sent += n;
+                    if (n < num) {
+                        if (retried) {
+                            break;
+                        }
+                        eventDev.Schedule();
+                        retried = true;
+                    }
+                }
+                for (unsigned i=sent;i<evNum;++i) {
+                    rte_pktmbuf_free(events[i].mbuf);
                 }
-                for (unsigned i=0;i<workerNum;++i) {
-                    if (workerQueue[i].num > 0) {
-                        rte_ring_sp_enqueue_burst(lcoreWorker[i].m_ring,
-                                                  (void * const *)workerQueue[i].buff,
-                                                  workerQueue[i].num,
-                                                  NULL);
-                        workerQueue[i].num = 0;
+                enqueuedCnt += sent;
+                droppedCnt += evNum - sent;
+
+                const uint64_t procTicks = procStat.MarkProcEnd();
+                if (jitter != nullptr) {
+                    jitter->RecordWork(procTicks);
+                }
+                rxPktCnt += rxNum;
+            }
+            eventDev.Schedule();
+        }
+
+        // Source is over: the scheduler runs until workers took all events
+        auto processed = [&lcoreWorker]() {
+            uint64_t num = 0;
+            for (const auto &w : lcoreWorker) {
+                num += __atomic_load_n(&w.m_rxPktCnt, __ATOMIC_ACQUIRE);
+            }
+            return num;
+        };
+        while (g_doWork && processed() < enqueuedCnt) {
+            eventDev.Schedule();
+        }
+        procStat.MarkFinishCycling();
+
+        g_doWork = false;
+        rte_eal_mp_wait_lcore();
+
+        print_finish_delimiter();
+
+        // Display processing time
+        Console::CyclicStat::PrintTableHeader({"Packets", "Cycles/pkt"});
+        print_lcore_row("Main", procStat, rxPktCnt);
+        for (const auto &w : lcoreWorker) {
+            print_lcore_row("LCore" + std::to_string(w.m_lcore), w.m_procStat, w.m_rxPktCnt);
+        }
+        std::cout << std::format("\nEventdev: Enqueued = {}, Dropped = {}\n", enqueuedCnt, droppedCnt);
+        print_rx_summary(src, procStat, rxPktCnt);
+
+        app.DisplayStageStat();
+        app.DisplayRxBurst(false);
+        app.DisplayJitter(true);
+    }
+
+    template< typename TRxSource >
+    void multi_core_rss(RX_Application &app, TRxSource &src)
+    {
+        // Pipeline workers
+        std::vector< LCoreProcessor > lcoreWorker;
+        lcoreWorker.reserve(rte_lcore_count());
+        std::vector< rte_ring* > rings;
+
+        unsigned lcore = 0;
+        RTE_LCORE_FOREACH_WORKER(lcore) {
+            rte_ring *ring = create_worker_ring(lcore, app.m_workerRingSize);
+
+            lcoreWorker.push_back(LCoreProcessor(ring, &app, lcore));
+            rings.push_back(ring);
+        }
+        // Checks the number of workers before they are launched
+        RssDispatcher dispatcher(rings, app.m_rssPolicy);
+        for (auto &w : lcoreWorker) {
+            rte_eal_remote_launch(lcore_processor< PBus::START_STAGE, PBus::FramePipeline >,
+                                  &w, w.m_lcore);
+        }
+        const unsigned workerNum = lcoreWorker.size();
+
+        std::cout << std::format("\n\tStart main loop with workers: {}, overload policy: {}\n",
+                                 workerNum, RssDispatcher::GetPolicyName(dispatcher.GetPolicy()))
+                  << std::endl;
+        /* set_thread_priority(DEF_PROCESS_PRIORITY); */
+
+        // Main cycle
+        uint64_t rxPktCnt = 0;
+        DPDK::CyclicStat procStat;
+        procStat.MarkStartCycling();
+        rte_mbuf* bufs[RX_FRAME_SIZE] = { 0 };
+        // Duplicates are dropped before dispatch, both copies of a frame may go to different workers
+        DuplicateDiscard *dupDiscard = app.GetDupDiscard();
+        JitterDetector *jitter = app.GetJitter();
+        BurstStat &burst = app.GetRxBurst();
+        burst.SetMaxBurst(RX_BURST_SIZE);
+        while (g_doWork && !src.IsFinished()) {
+            if (jitter != nullptr) {
+                jitter->Poll(DPDK::Clocks::get_current_ticks());
+            }
+            unsigned rxNum = rx_frame(src, bufs, RX_FRAME_SIZE, burst);
+            if (rxNum > 0) {
+                procStat.MarkProcBegin();
+
+                for (unsigned i=0;i<rxNum;++i) {
+                    /* rte_prefetch0(bufs[i]); */
+                    const uint8_t *packet = rte_pktmbuf_mtod(bufs[i], const uint8_t *);
+                    const unsigned size = rte_pktmbuf_data_len(bufs[i]);
+                    if (PBus::is_duplicate(dupDiscard, packet, size)) {
+                        rte_pktmbuf_free(bufs[i]);
+                        continue;
                     }
+                    dispatcher.Put(bufs[i], packet, size);
                 }
+                dispatcher.Flush();
 
-                procStat.MarkProcEnd();
+                const uint64_t procTicks = procStat.MarkProcEnd();
+                if (jitter != nullptr) {
+                    jitter->RecordWork(procTicks);
+                }
+                rxPktCnt += rxNum;
             }
         }
+
+        wait_workers_drained(lcoreWorker);
         procStat.MarkFinishCycling();
 
-        // Finish delimiter
-        std::cout << std::format("\n\n{:*<80}\n{:*^80}\n{:*<80}\n\n",
-                                 "", " FINISH ", "");
+        g_doWork = false;
+        rte_eal_mp_wait_lcore();
+
+        print_finish_delimiter();
 
         // Display processing time
-        Console::CyclicStat::PrintTableHeader();
-        Console::CyclicStat::PrintTableRow("Main", procStat) << "\n";
+        Console::CyclicStat::PrintTableHeader({"Packets", "Cycles/pkt"});
+        print_lcore_row("Main", procStat, rxPktCnt);
         for (const auto &w : lcoreWorker) {
-            Console::CyclicStat::PrintTableRow("LCore" + std::to_string(w.m_lcore), w.m_procStat) << "\n";
+            print_lcore_row("LCore" + std::to_string(w.m_lcore), w.m_procStat, w.m_rxPktCnt);
         }
+        print_dispatcher_stat(dispatcher, lcoreWorker);
+        print_rx_summary(src, procStat, rxPktCnt);
+
+        app.DisplayStageStat();
+        app.DisplayRxBurst(false);
+        app.DisplayJitter(true);
     }
 }
 
@@ -207,7 +696,35 @@ void RX_Application::ParseCmdOptions(int argc, char* argv[])
             ("h,help", "Print usage")
             ("goose", "The number of unique GOOSE is being reserved", cxxopts::value< int >())
             ("sv80", "The number of unique SV with 80 points", cxxopts::value< int >())
-            ("sv256", "The number of unique SV with 256 points", cxxopts::value< int >());
+            ("sv256", "The number of unique SV with 256 points", cxxopts::value< int >())
+            ("replay", "Process packets from a pcap file instead of NIC", cxxopts::value< std::string >())
+            ("loops", "The number of replay loops", cxxopts::value< int >())
+            ("ports", "NIC ports to receive from, their streams are merged: 0,1", cxxopts::value< std::vector< int > >())
+            ("pipelined", "Stage per lcore: Router on main, GOOSE and SV on workers")
+            ("eventdev", "Workers take frames from the software event device: atomic flow per APPID")
+            ("hw-filter", "NIC drops GOOSE/SV which aren't configured(rte_flow)")
+            ("xdp", "AF_XDP on the interfaces instead of NIC ports, IP stays in the kernel: eth0,eth1",
+                    cxxopts::value< std::vector< std::string > >())
+            ("xdp-queue", "AF_XDP: the RX queue of the interfaces", cxxopts::value< int >())
+            ("xdp-prog", "AF_XDP: the XDP program, pbus_xdp.o next to the binary by default",
+                    cxxopts::value< std::string >())
+            ("routable", "Expect R-GOOSE/R-SV instead of L2 frames")
+            ("r-dst", "R-GOOSE/R-SV: the multicast group", cxxopts::value< std::string >())
+            ("ptp", "IEEE1588 RX timestamps of NIC for PTP time(software timestamps without it)")
+            ("ptp-domain", "PTP domain of the master", cxxopts::value< int >())
+            ("ptp-delay", "PTP: the mean path delay to the master in ns", cxxopts::value< int >())
+            ("prp", "Discard PRP/HSR duplicates of LAN A/B, the number of sources(power of 2)",
+                    cxxopts::value< int >())
+            ("reorder", "Reorder frames of each GOOSE/SV: the max wait of a missing frame in us",
+                    cxxopts::value< int >())
+            ("rss-overload", "RSS mode: leftovers of a full worker ring, drop-newest | drop-sv | spill",
+                    cxxopts::value< std::string >())
+            ("jitter", "Record gaps between polls of each lcore longer than N us(stalls)",
+                    cxxopts::value< int >())
+            ("rx-buffer", "Size NIC and worker rings and the mempool for N us of the configured traffic",
+                    cxxopts::value< int >())
+            ("mbuf-data", "Data room of mbuf in bytes, by the configured traffic by default",
+                    cxxopts::value< int >());
 
         auto result = options.parse(argc, argv);
         if (result.count("help")) {
@@ -224,6 +741,130 @@ void RX_Application::ParseCmdOptions(int argc, char* argv[])
         if (result.count("sv256")) {
             m_confSV256Num = result["sv256"].as< int >();
         }
+        if (result.count("replay")) {
+            m_replayFile = result["replay"].as< std::string >();
+        }
+        if (result.count("loops")) {
+            int loops = result["loops"].as< int >();
+            if (loops <= 0) {
+                throw std::invalid_argument("The loops option must be positive");
+            }
+            m_replayLoops = loops;
+        }
+        if (result.count("ports")) {
+            m_portIDs.clear();
+            for (int port : result["ports"].as< std::vector< int > >()) {
+                if (port < 0 || port >= RTE_MAX_ETHPORTS) {
+                    throw std::invalid_argument("The ports option is out of range: " + std::to_string(port));
+                }
+                if (std::find(m_portIDs.begin(), m_portIDs.end(), port) != m_portIDs.end()) {
+                    throw std::invalid_argument("The ports option has a duplicate: " + std::to_string(port));
+                }
+                m_portIDs.push_back(port);
+            }
+            if (m_portIDs.empty()) {
+                throw std::invalid_argument("The ports option is empty");
+            }
+        }
+        m_lastPortStat.resize(m_portIDs.size());
+        if (result.count("pipelined")) {
+            m_pipelined = true;
+        }
+        if (result.count("eventdev")) {
+            if (m_pipelined) {
+                throw std::invalid_argument("The eventdev option can't be pipelined");
+            }
+            m_eventdev = true;
+        }
+        if (result.count("hw-filter")) {
+            m_hwFilter = true;
+        }
+        if (result.count("xdp")) {
+            m_xdpIfaces = result["xdp"].as< std::vector< std::string > >();
+            if (result.count("ports")) {
+                throw std::invalid_argument("The xdp option replaces the ports option");
+            }
+        }
+        if (result.count("xdp-queue")) {
+            int queue = result["xdp-queue"].as< int >();
+            if (queue < 0) {
+                throw std::invalid_argument("The xdp-queue option can't be negative");
+            }
+            m_xdpQueue = queue;
+        }
+        if (result.count("xdp-prog")) {
+            m_xdpProg = result["xdp-prog"].as< std::string >();
+        } else if (!m_xdpIfaces.empty()) {
+            m_xdpProg = (std::filesystem::read_symlink("/proc/self/exe").parent_path() / "pbus_xdp.o").string();
+        }
+        if (result.count("routable")) {
+            uint32_t group = RSession::DEF_GROUP;
+            if (result.count("r-dst")) {
+                group = parse_ipv4(result["r-dst"].as< std::string >());
+                if ((group >> 28) != 0xE) {
+                    throw std::invalid_argument("The r-dst option must be a multicast address");
+                }
+            }
+            // R-GOOSE and R-SV share the group's MAC
+            uint8_t mac[6];
+            RSession::multicast_mac(group, mac);
+            m_gooseMAC = m_svMAC = MAC(mac);
+        }
+        if (result.count("ptp")) {
+            m_ptpHwTimestamp = true;
+        }
+        if (result.count("ptp-domain")) {
+            int domain = result["ptp-domain"].as< int >();
+            if (domain < 0 || domain > 255) {
+                throw std::invalid_argument("The ptp-domain option must be in [0, 255]");
+            }
+            m_ptpConf.domain = domain;
+        }
+        if (result.count("ptp-delay")) {
+            int delay = result["ptp-delay"].as< int >();
+            if (delay < 0) {
+                throw std::invalid_argument("The ptp-delay option can't be negative");
+            }
+            m_ptpConf.pathDelayNS = delay;
+        }
+        if (result.count("prp")) {
+            int sources = result["prp"].as< int >();
+            if (sources <= 0 || (sources & (sources - 1)) != 0) {
+                throw std::invalid_argument("The prp option must be a power of 2");
+            }
+            m_prpTableSize = sources;
+        }
+        if (result.count("rss-overload")) {
+            m_rssPolicy = RssDispatcher::ParsePolicy(result["rss-overload"].as< std::string >());
+        }
+        if (result.count("jitter")) {
+            int threshold = result["jitter"].as< int >();
+            if (threshold <= 0) {
+                throw std::invalid_argument("The jitter option must be positive");
+            }
+            m_jitterUS = threshold;
+        }
+        if (result.count("rx-buffer")) {
+            int buffer = result["rx-buffer"].as< int >();
+            if (buffer <= 0) {
+                throw std::invalid_argument("The rx-buffer option must be positive");
+            }
+            m_rxBufferUS = buffer;
+        }
+        if (result.count("mbuf-data")) {
+            int dataRoom = result["mbuf-data"].as< int >();
+            if (dataRoom < RTE_ETHER_MIN_LEN || dataRoom > UINT16_MAX - RTE_PKTMBUF_HEADROOM) {
+                throw std::invalid_argument("The mbuf-data option is out of range: " + std::to_string(dataRoom));
+            }
+            m_mbufDataRoom = dataRoom;
+        }
+        if (result.count("reorder")) {
+            int wait = result["reorder"].as< int >();
+            if (wait <= 0) {
+                throw std::invalid_argument("The reorder option must be positive");
+            }
+            m_reorderWaitUS = wait;
+        }
     } catch (const std::exception &e) {
         std::cerr << "cxxopts: Error parsing options: " << e.what() << std::endl;
         throw;
@@ -234,6 +875,36 @@ void RX_Application::Init(int argc, char* argv[])
 {
     ParseCmdOptions(argc, argv);
 
+    // AF_XDP mode: a port per interface, they are created before the check of ports
+    if (!m_xdpIfaces.empty()) {
+        if (!std::filesystem::exists(m_xdpProg)) {
+            throw std::runtime_error("XDP program isn't found: " + m_xdpProg);
+        }
+        m_portIDs.clear();
+        for (size_t i=0;i<m_xdpIfaces.size();++i) {
+            m_portIDs.push_back(create_xdp_port(i, m_xdpIfaces[i], m_xdpQueue, m_xdpProg));
+        }
+        m_lastPortStat.resize(m_portIDs.size());
+    }
+
+    unsigned lcore = 0;
+    RTE_LCORE_FOREACH(lcore) {
+        m_matrix[lcore] = std::make_unique< PBus::DataMatrix >(this);
+        if (m_jitterUS > 0) {
+            m_jitter[lcore] = std::make_unique< JitterDetector >(lcore, DPDK::Clocks::us_to_ticks(m_jitterUS),
+                                                                 DPDK::Clocks::us_to_ticks(1));
+        }
+        // Eventdev moves flows between workers, their windows are flushed at the end only
+        if (m_reorderWaitUS > 0 && !m_eventdev) {
+            m_reorderPending[lcore] = std::make_unique< PBus::PendingReorder >();
+        }
+    }
+    if (m_prpTableSize > 0) {
+        m_dupDiscard = std::make_unique< DuplicateDiscard >(m_prpTableSize);
+    }
+
+    const uint64_t reorderWait = DPDK::Clocks::us_to_ticks(m_reorderWaitUS);
+
     std::cout << "\n\tRX from ProcessBus configuration\n\n";
 
     if (m_confGooseNum > 0) {
@@ -242,13 +913,14 @@ void RX_Application::Init(int argc, char* argv[])
 
         for (unsigned i=0;i<m_confGooseNum;++i) {
             GooseSource::ptr src = std::make_shared< GooseSource >();
-            src->SetMAC(MAC("01:0C:CD:04:00:01"))
+            src->SetMAC(m_gooseMAC)
                 .SetAppID(0x0001 + i)
                 .SetGOID(std::format("GOID{:08}", i + 1))
                 .SetDataSetRef(std::format("IED{:08}LDName/LLN0$DataSet", i + 1))
                 .SetGOCBRef(std::format("IED{:08}LDName/LLN0$GO$GOCB", i + 1))
                 .SetCRev(1)
-                .SetNumEntries(16);
+                .SetNumEntries(16)
+                .SetReorderWait(reorderWait);
             m_gooseMap[src->GetPassport()] = src;
 
             // Table row
@@ -262,11 +934,12 @@ void RX_Application::Init(int argc, char* argv[])
 
         for (unsigned i=0;i<m_confSV80Num;++i) {
             SVStreamSource::ptr src = std::make_shared< SVStreamSource >();
-            src->SetMAC(MAC("01:0C:CD:01:00:01"))
+            src->SetMAC(m_svMAC)
                 .SetAppID(0x0001 + i)
                 .SetSVID(std::format("SVID{:04}", i + 1))
                 .SetCRev(1)
-                .SetNumASDU(1);
+                .SetNumASDU(1)
+                .SetReorderWait(reorderWait);
             m_svMap[src->GetPassport()] = src;
 
             // Table row
@@ -280,11 +953,12 @@ void RX_Application::Init(int argc, char* argv[])
 
         for (unsigned i=0;i<m_confSV256Num;++i) {
             SVStreamSource::ptr src = std::make_shared< SVStreamSource >();
-            src->SetMAC(MAC("01:0C:CD:01:00:01"))
+            src->SetMAC(m_svMAC)
                 .SetAppID(0x0001 + i)
                 .SetSVID(std::format("SVID{:04}", i + 1))
                 .SetCRev(1)
-                .SetNumASDU(8);
+                .SetNumASDU(8)
+                .SetReorderWait(reorderWait);
             m_svMap[src->GetPassport()] = src;
 
             // Table row
@@ -298,21 +972,32 @@ void RX_Application::DisplayStatistic(unsigned interval_sec)
     #define BYTES_TO_MEGABITS(b)  ((b) * 8 / 1000000.0)
     #define BYTES_TO_MEGABYTES(b) ((b) / 1000000.0)
 
-    rte_eth_stats start = m_lastPortStat;
-    unsigned port_id = 0;
-    rte_eth_stats_get(port_id, &m_lastPortStat);
     m_statDisplaySec += interval_sec;
 
+    // Stats of all ports are summed up, they feed the same streams
+    rte_eth_stats start = {}, stats = {};
+    std::vector< rte_eth_stats > portStart(m_lastPortStat);
+    unsigned readNum = 0;
+    for (size_t i=0;i<m_portIDs.size();++i) {
+        rte_eth_stats cur = {};
+        if (rte_eth_stats_get(m_portIDs[i], &cur) != 0) {
+            continue;
+        }
+        ++readNum;
+        add_port_stats(start, m_lastPortStat[i]);
+        add_port_stats(stats, cur);
+        m_lastPortStat[i] = cur;
+    }
+
     // Calculate RX and TX PPS/BPS
-    uint64_t rx_pps = (m_lastPortStat.ipackets - start.ipackets) / interval_sec;
-    uint64_t tx_pps = (m_lastPortStat.opackets - start.opackets) / interval_sec;
-    uint64_t rx_bps = (m_lastPortStat.ibytes - start.ibytes) / interval_sec;
-    uint64_t tx_bps = (m_lastPortStat.obytes - start.obytes) / interval_sec;
+    uint64_t rx_pps = (stats.ipackets - start.ipackets) / interval_sec;
+    uint64_t tx_pps = (stats.opackets - start.opackets) / interval_sec;
+    uint64_t rx_bps = (stats.ibytes - start.ibytes) / interval_sec;
+    uint64_t tx_bps = (stats.obytes - start.obytes) / interval_sec;
 
     std::cout << std::format("\nTime {} sec\n\n", m_statDisplaySec);
 
-    rte_eth_stats stats;
-    if (rte_eth_stats_get(port_id, &stats) == 0) {
+    if (readNum > 0) {
         std::cout << std::format(
                         "            | RX         | TX         |\n"
                         "---------------------------------------\n"
@@ -332,6 +1017,19 @@ void RX_Application::DisplayStatistic(unsigned interval_sec)
                         stats.rx_nombuf
                     )
                   << std::endl;
+
+        if (m_portIDs.size() > 1) {
+            std::cout << " Port       | PPS        | Packets    | Missed     |\n"
+                         "----------------------------------------------------\n";
+            for (size_t i=0;i<m_portIDs.size();++i) {
+                const rte_eth_stats &cur = m_lastPortStat[i];
+                std::cout << std::format("{:<10}  | {:<10} | {:<10} | {:<10} |\n",
+                                         m_portIDs[i],
+                                         (cur.ipackets - portStart[i].ipackets) / interval_sec,
+                                         cur.ipackets, cur.imissed);
+            }
+            std::cout << std::endl;
+        }
     }
 
     // Proto information
@@ -348,12 +1046,113 @@ void RX_Application::DisplayStatistic(unsigned interval_sec)
                         "Kernel",  "-", m_pktToKernelCnt
                  )
               << std::endl;
+
+    if (m_rxRoutablePktCnt > 0) {
+        std::cout << std::format("R-GOOSE/R-SV: {}\n", m_rxRoutablePktCnt) << std::endl;
+    }
+    if (m_dupDiscard) {
+        std::cout << std::format("PRP/HSR: Sources = {}, Passed = {}, Duplicates = {}, "
+                                 "Missing A = {}, Missing B = {}, Out of window = {}, Table full = {}\n",
+                                 m_dupDiscard->GetSourceNum(), m_dupDiscard->GetPassedNum(),
+                                 m_dupDiscard->GetDuplicateNum(),
+                                 m_dupDiscard->GetMissingNum(0), m_dupDiscard->GetMissingNum(1),
+                                 m_dupDiscard->GetOutOfWindowNum(), m_dupDiscard->GetOverflowNum())
+                  << std::endl;
+    }
+    if (m_frameOverflowCnt > 0) {
+        std::cout << std::format("Frame overflow: {}\n", m_frameOverflowCnt) << std::endl;
+    }
+    if (m_rxChainedCnt > 0) {
+        std::cout << std::format("GOOSE/SV/PTP over {} B(dropped): {}\n", RX_CHAINED_MAX, m_rxChainedCnt)
+                  << std::endl;
+    }
+    if (m_rxPtpPktCnt + m_errPtpParserCnt > 0) {
+        std::cout << std::format("PTP: Packets = {}, Errors = {}, Sync = {}, HW timestamps = {}, "
+                                 "Master = {:016X}\n"
+                                 "     Offset = {} ns, Freq = {:.1f} ppb, Steps = {}, {}\n",
+                                 m_rxPtpPktCnt, m_errPtpParserCnt, m_ptpSync.GetSyncNum(),
+                                 m_ptpSync.GetHwTimestampNum(), m_ptpSync.GetMasterID(),
+                                 m_ptpClock.GetLastOffset(), m_ptpClock.GetFreqPPB(),
+                                 m_ptpClock.GetStepNum(), m_ptpClock.IsLocked() ? "Locked" : "Unlocked")
+                  << std::endl;
+    }
+
+    DisplayStageStat();
+    DisplayRxBurst(true);
+    DisplayJitter(false);
+}
+
+void RX_Application::DisplayRxBurst(bool interval)
+{
+    Console::BurstStat::PrintTableHeader();
+    unsigned lcore = 0;
+    RTE_LCORE_FOREACH(lcore) {
+        const BurstStat::Counters &cur = m_rxBurst[lcore].GetCounters();
+        const BurstStat::Counters counters = interval ? (cur - m_lastRxBurst[lcore]) : cur;
+        m_lastRxBurst[lcore] = cur;
+        if (counters.GetPollNum() == 0) {
+            continue;
+        }
+        std::string label = (lcore == rte_get_main_lcore()) ? "Main" : "LCore" + std::to_string(lcore);
+        Console::BurstStat::PrintTableRow(label, counters, m_rxBurst[lcore].GetMaxBurst());
+    }
+    std::cout << std::endl;
+}
+
+void RX_Application::DisplayJitter(bool withStalls)
+{
+    if (m_jitterUS == 0) {
+        return;
+    }
+
+    Console::JitterStat::PrintTableHeader();
+    unsigned lcore = 0;
+    RTE_LCORE_FOREACH(lcore) {
+        std::string label = (lcore == rte_get_main_lcore()) ? "Main" : "LCore" + std::to_string(lcore);
+        Console::JitterStat::PrintTableRow(label, *m_jitter[lcore]);
+    }
+    std::cout << std::endl;
+
+    if (withStalls) {
+        const size_t MAX_STALLS = 16;
+        std::cout << std::format("Last stalls longer than {} us:\n", m_jitterUS);
+        RTE_LCORE_FOREACH(lcore) {
+            Console::JitterStat::PrintStalls(*m_jitter[lcore], MAX_STALLS);
+        }
+        std::cout << std::endl;
+    }
+}
+
+void RX_Application::DisplayStageStat()
+{
+    if constexpr (PBus::StageStat::ENABLED) {
+        std::cout << "\n";
+        Console::StageStat::PrintTableHeader();
+
+        unsigned lcore = 0;
+        RTE_LCORE_FOREACH(lcore) {
+            std::string label = (lcore == rte_get_main_lcore()) ? "Main"
+                                                                : "LCore" + std::to_string(lcore);
+            Console::StageStat::PrintTableRows(label, m_matrix[lcore]->stat, PBus::STAGE_NAMES);
+        }
+        std::cout << std::endl;
+    }
 }
 
 void RX_Application::DisplayResults()
 {
     std::cout << std::endl;
 
+    // RX is over: frames waiting for the missing ones are processed
+    if (m_reorderWaitUS > 0) {
+        for (auto &src : m_gooseMap) {
+            src.second->FlushReorder();
+        }
+        for (auto &src : m_svMap) {
+            src.second->FlushReorder();
+        }
+    }
+
     if (!m_gooseMap.empty()) {
         Console::GooseSource::PrintTableHeader();
 
@@ -371,39 +1170,34 @@ void RX_Application::DisplayResults()
             Console::SVStreamSource::PrintTableRow(s);
         }
     }
+
+    if (m_reorderWaitUS > 0) {
+        Console::ReorderStat::PrintTableHeader();
+        Console::ReorderStat::PrintTableRow("GOOSE", m_gooseMap);
+        Console::ReorderStat::PrintTableRow("SV", m_svMap);
+        std::cout << std::endl;
+    }
 }
 
-void RX_Application::Run(StopVarType &doWork)
+template< typename TRxSource >
+void RX_Application::Process(TRxSource &src)
 {
-    // DPDK settings
-    const unsigned MBUF_NUM = 4 * 512 * 1024,
-                   CACHE_NUM = 64,
-                   RX_DESC_NUM = 63 * 1024,
-                   TX_DESC_NUM = 128;
-
-    // Create memory pool
-    DPDK::Mempool pool("bus_proc_pool", MBUF_NUM, CACHE_NUM);
-
-    // Create Ethernet port
-    uint16_t port_id = 0, queue_id = 0;
-    DPDK::Port eth = DPDK::PortBuilder(port_id)
-                            .SetMemPool(pool.Get())
-                            .AdjustQueues(1, 1)
-                            .SetDescriptors(RX_DESC_NUM, TX_DESC_NUM)
-                            .Build();
+    ASM_MARKER(rx_processing_start);
+    if (m_pipelined) {
+        multi_stage(*this, src);
+        ASM_MARKER(rx_processing_finish);
+        return;
+    }
 
-    // Common information
-    /*
-    DPDK::Info::display_lcore_info();
-    DPDK::Info::display_eth_info();
-    DPDK::Info::display_pools_info();
-    */
+    if (m_eventdev) {
+        multi_core_eventdev(*this, src);
+        ASM_MARKER(rx_processing_finish);
+        return;
+    }
 
-    // Processing style
-    ASM_MARKER(rx_processing_start);
     switch (rte_lcore_count()) {
     case 1: {
-        single_core(*this, eth, queue_id);
+        single_core(*this, src);
         break;
     }
     case 2: {
@@ -412,17 +1206,151 @@ void RX_Application::Run(StopVarType &doWork)
     }
     default: {
         // Software RSS
-        multi_core_rss(*this, eth, queue_id);
+        multi_core_rss(*this, src);
         break;
     }
     }
     ASM_MARKER(rx_processing_finish);
+}
+
+void RX_Application::Run(StopVarType &doWork)
+{
+    if (IsReplayMode()) {
+        RunReplay(doWork);
+        return;
+    }
+
+    // DPDK settings
+    const unsigned CACHE_NUM = RX_FRAME_SIZE,
+                   TX_DESC_NUM = 128;
+
+    for (uint16_t port_id : m_portIDs) {
+        if (!rte_eth_dev_is_valid_port(port_id)) {
+            throw std::runtime_error("Port isn't available: " + std::to_string(port_id));
+        }
+    }
+
+    // Sizing by the configured streams: a pool per NUMA node of ports
+    PoolSizing::Config sizingConf;
+    sizingConf.gooseNum = m_confGooseNum;
+    sizingConf.sv80Num = m_confSV80Num;
+    sizingConf.sv256Num = m_confSV256Num;
+    sizingConf.lcoreNum = rte_lcore_count();
+    sizingConf.ringNum = m_eventdev ? 1 : (rte_lcore_count() - 1);
+    sizingConf.bufferUS = m_rxBufferUS;
+    sizingConf.frameSize = RX_FRAME_SIZE;
+    sizingConf.cacheNum = CACHE_NUM;
+    sizingConf.txDescNum = TX_DESC_NUM;
+    sizingConf.headroom = RTE_PKTMBUF_HEADROOM;
+    sizingConf.dataRoom = m_mbufDataRoom;
+    sizingConf.xdp = !m_xdpIfaces.empty();
+
+    std::map< int, unsigned > socketPorts;
+    for (uint16_t port_id : m_portIDs) {
+        ++socketPorts[DPDK::Port::GetSocket(port_id)];
+    }
+
+    // Descriptors and rings don't depend on the ports of a node
+    const PoolSizing sizing(sizingConf);
+    const bool rxScatter = (sizing.GetDataRoom() < RTE_ETHER_MAX_LEN);
+    m_workerRingSize = sizing.GetRingSize();
+    std::cout << std::format("\n\tRX sizing: {} us of {} pps, RX descriptors = {}, Worker ring = {}\n",
+                             m_rxBufferUS, sizing.GetPPS(), sizing.GetRxDescNum(), m_workerRingSize);
+
+    std::map< int, std::unique_ptr< DPDK::Mempool > > pools;
+    for (const auto &[socket, portNum] : socketPorts) {
+        sizingConf.portNum = portNum;
+        const PoolSizing poolSizing(sizingConf);
+        pools[socket] = std::make_unique< DPDK::Mempool >(std::format("bus_proc_pool_{}", socket),
+                                                          poolSizing.GetMbufNum(), poolSizing.GetCacheNum(),
+                                                          poolSizing.GetMbufSize(), socket);
+        std::cout << std::format("\tPool of socket {}: Mbufs = {}, Data room = {} B, Cache = {}, Memory = {:.1f} MB\n",
+                                 socket, poolSizing.GetMbufNum(), poolSizing.GetDataRoom(),
+                                 poolSizing.GetCacheNum(), poolSizing.GetBytes() / (1024.0 * 1024.0));
+    }
+    if (rxScatter) {
+        std::cout << std::format("\tFrames over {} B are chained(NIC scatter), bus frames are parsed from a copy\n", sizing.GetDataRoom());
+    }
+
+    // Create Ethernet ports: LAN A/B or bus segments, ports of a node share its pool
+    const uint16_t queue_id = 0;
+    std::vector< DPDK::Port > ports;
+    ports.reserve(m_portIDs.size());
+    for (uint16_t port_id : m_portIDs) {
+        ports.push_back(DPDK::PortBuilder(port_id)
+                                .SetMemPool(pools[DPDK::Port::GetSocket(port_id)]->Get())
+                                .AdjustQueues(1, 1)
+                                .SetDescriptors(sizing.GetRxDescNum(), TX_DESC_NUM)
+                                .SetRxScatter(rxScatter)
+                                .SetTimestamping(m_ptpHwTimestamp)
+                                .Build());
+    }
+
+    // NIC's timestamps are used only if each port has them
+    m_ptpConf.hwTimestamp = std::all_of(ports.begin(), ports.end(),
+                                        [](const DPDK::Port &p) { return p.IsTimesyncEnabled(); });
+    m_ptpSync.Configure(m_ptpConf);
+    if (m_ptpHwTimestamp) {
+        std::cout << "\n\tPTP timestamps: " << (m_ptpConf.hwTimestamp ? "NIC" : "CPU") << "\n";
+    }
+
+    // Common information
+    /*
+    DPDK::Info::display_lcore_info();
+    DPDK::Info::display_eth_info();
+    DPDK::Info::display_pools_info();
+    */
+
+    // Start NIC ports
+    for (DPDK::Port &eth : ports) {
+        start_port(eth);
+    }
+    if (ports.size() > 1) {
+        std::cout << std::format("\n\tRX ports: {}\n", ports.size());
+    }
+
+    // Unknown publishers are dropped by NIC instead of being parsed
+    std::vector< std::unique_ptr< BusFlowFilter > > filters;
+    if (m_hwFilter) {
+        for (DPDK::Port &eth : ports) {
+            auto filter = std::make_unique< BusFlowFilter >(eth, queue_id);
+            subscribe_streams(*filter, m_gooseMap, m_svMap);
+            std::cout << std::format("\n\tPort {} filter: {}, rules = {}\n", eth.GetID(),
+                                     BusFlowFilter::GetModeName(filter->GetMode()),
+                                     filter->GetRuleNum());
+            filters.push_back(std::move(filter));
+        }
+    }
+
+    // Processing style: ports are polled by the RX lcore, streams are shared
+    EthRxSource src{m_portIDs, queue_id};
+    Process(src);
 
     // Stop all
-    eth.Stop();
+    filters.clear();
+    for (DPDK::Port &eth : ports) {
+        eth.Stop();
+    }
     rte_eal_mp_wait_lcore();
 
-    /* std::cout << "Mempool: \n" << pool << std::endl; */
+    /* std::cout << "Mempool: \n" << *pools.begin()->second << std::endl; */
     DisplayResults();
 }
 
+void RX_Application::RunReplay(StopVarType &doWork)
+{
+    PcapReplay replay(m_replayFile, m_replayLoops);
+    replay.Preload();
+
+    std::cout << std::format("\n\tReplay {}: Packets = {}, Bytes = {}, Skipped = {}, Loops = {}\n",
+                             m_replayFile, replay.GetPacketNum(), replay.GetBytes(),
+                             replay.GetSkippedNum(), replay.GetLoops());
+
+    Process(replay);
+
+    // Replay is over: stop the auxiliary thread
+    doWork = false;
+    rte_eal_mp_wait_lcore();
+
+    DisplayResults();
+}
@@ -4,10 +4,22 @@
 #include "common/shared_defs.hpp"
 #include "common/goose_container.hpp"
 #include "common/sv_container.hpp"
+#include "common/dup_discard.hpp"
+#include "common/jitter_detector.hpp"
+#include "common/burst_stat.hpp"
 
 #include "dpdk_cpp/dpdk_cyclestat_class.hpp"
 #include "dpdk_cpp/dpdk_port_class.hpp"
 
+#include "pipeline_pbus.hpp"
+#include "ptp_sync.hpp"
+#include "pool_sizing.hpp"
+#include "rss_dispatcher.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
 using StopVarType = volatile bool;
 
 class RX_Application;
@@ -20,7 +32,11 @@ struct LCoreProcessor
     rte_ring*           m_ring = nullptr;
     RX_Application*     m_app = nullptr;
     unsigned            m_lcore = 0;
+    // Eventdev mode: the worker's port instead of the ring
+    uint8_t             m_eventDev = 0,
+                        m_eventPort = 0;
     uint64_t            m_noFreeDesc = 0;
+    uint64_t            m_rxPktCnt = 0;
     DPDK::CyclicStat    m_procStat;
 
     LCoreProcessor(rte_ring *ring, RX_Application *app, unsigned lcore)
@@ -38,31 +54,113 @@ public:
     RX_Application(int argc, char *argv[]);
 
     void DisplayStatistic(unsigned interval_sec);
+    void DisplayStageStat();
+    void DisplayJitter(bool withStalls);
+    void DisplayRxBurst(bool interval);
     void DisplayResults();
 
     void Run(StopVarType &doWork);
 
+    bool IsReplayMode() const { return !m_replayFile.empty(); }
+
+    /**
+     * @brief PRP/HSR duplicate discard runs on the main lcore only: the first one
+     * which sees all frames(Router or RSS dispatcher)
+     */
+    DuplicateDiscard* GetDupDiscard() const {
+        return (rte_lcore_id() == rte_get_main_lcore()) ? m_dupDiscard.get() : nullptr;
+    }
+
+    /**
+     * @brief RX burst sizes of the calling lcore
+     */
+    BurstStat& GetRxBurst() {
+        return m_rxBurst[rte_lcore_id()];
+    }
+
+    /**
+     * @brief Jitter detector of the calling lcore, nullptr if it's off
+     */
+    JitterDetector* GetJitter() const {
+        return m_jitter[rte_lcore_id()].get();
+    }
+
+    /**
+     * @brief Quiet streams of the calling lcore to expire, nullptr if there is
+     * no reorder window or streams don't stay on an lcore(eventdev)
+     */
+    PBus::PendingReorder* GetReorderPending() const {
+        return m_reorderPending[rte_lcore_id()].get();
+    }
+
 private:
     void ParseCmdOptions(int argc, char* argv[]);
     void Init(int argc, char* argv[]);
 
+    void RunReplay(StopVarType &doWork);
+
+    template< typename TRxSource >
+    void Process(TRxSource &src);
+
 public:
 /* private */
     // Settings
     unsigned        m_confGooseNum = 0,
                     m_confSV80Num = 0,
                     m_confSV256Num = 0;
+    std::string     m_replayFile;
+    unsigned        m_replayLoops = 1;
+    bool            m_pipelined = false;
+    bool            m_eventdev = false;
+    std::vector< uint16_t > m_portIDs = { 0 };
+    bool            m_hwFilter = false;
+    // AF_XDP: interfaces are shared with the kernel
+    std::vector< std::string > m_xdpIfaces;
+    unsigned        m_xdpQueue = 0;
+    std::string     m_xdpProg;
+    MAC             m_gooseMAC = MAC("01:0C:CD:04:00:01"),
+                    m_svMAC = MAC("01:0C:CD:01:00:01");
+    bool            m_ptpHwTimestamp = false;
+    PtpSync::Config m_ptpConf;
+    unsigned        m_prpTableSize = 0;
+    unsigned        m_reorderWaitUS = 0;    // 0 - no reorder window
+    RssDispatcher::Policy m_rssPolicy = RssDispatcher::DROP_NEWEST;
+    unsigned        m_jitterUS = 0;         // Stall threshold, 0 - no detector
+    unsigned        m_rxBufferUS = 10000;   // Traffic absorbed by the NIC and worker rings
+    unsigned        m_mbufDataRoom = 0;     // 0 - by the traffic
 
     // Runtime
     GooseContainer  m_gooseMap;
     SVContainer     m_svMap;
+    // Common time base of all lcores, disciplined by PtpStage
+    PtpClock        m_ptpClock{ DPDK::Clocks::get_ticks_per_sec() };
+    PtpSync         m_ptpSync{ m_ptpClock };
+    std::unique_ptr< DuplicateDiscard > m_dupDiscard;
+
+    // Pipeline's data of each lcore, lives as long as the app
+    std::array< std::unique_ptr< PBus::DataMatrix >, RTE_MAX_LCORE > m_matrix;
+    // Gaps between polls of each lcore
+    std::array< std::unique_ptr< JitterDetector >, RTE_MAX_LCORE > m_jitter;
+    // Streams with pending reordered states of each lcore
+    std::array< std::unique_ptr< PBus::PendingReorder >, RTE_MAX_LCORE > m_reorderPending;
+    // RX burst sizes of each lcore, the last ones are of the previous live statistic
+    std::array< BurstStat, RTE_MAX_LCORE > m_rxBurst;
+    std::array< BurstStat::Counters, RTE_MAX_LCORE > m_lastRxBurst;
+    // Worker rings(or events of the event device), sized by Run
+    unsigned        m_workerRingSize = 16 * 1024;
+    // Stage frames handed over to other lcores (pipelined mode)
+    PBus::StageLink m_stageLink[PBus::STAGE_NUM] = {};
 
     // Statistic
     uint64_t        m_rxGoosePktCnt = 0, m_rxSVPktCnt = 0,
                     m_errGooseParserCnt = 0, m_errSVParserCnt = 0,
                     m_rxUnknownGooseCnt = 0, m_rxUnknownSVCnt = 0,
-                    m_pktToKernelCnt = 0;
-    rte_eth_stats   m_lastPortStat = {};
+                    m_rxRoutablePktCnt = 0,
+                    m_rxPtpPktCnt = 0, m_errPtpParserCnt = 0,
+                    m_pktToKernelCnt = 0,
+                    m_frameOverflowCnt = 0,
+                    m_rxChainedCnt = 0;     // GOOSE/SV/PTP over RX_CHAINED_MAX
+    std::vector< rte_eth_stats > m_lastPortStat;   // Of each port
     unsigned        m_statDisplaySec = 0;
 };
 
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @class BurstStat
+ * @brief Distribution of RX burst sizes of an lcore: empty polls mean the core
+ * has spare time, full bursts mean the ring(NIC's or worker's) is backing up.
+ * A dequeue of a bigger burst than 32 is scaled to 32 parts of it(rounded up,
+ * so only empty polls go to the first bucket). Single writer.
+ */
+class alignas(64) BurstStat
+{
+public:
+    static constexpr unsigned MAX_BUCKET = 32;
+
+    struct Counters
+    {
+        uint64_t hist[MAX_BUCKET + 1] = {};
+
+        uint64_t GetPollNum() const {
+            uint64_t num = 0;
+            for (uint64_t cnt : hist) {
+                num += cnt;
+            }
+            return num;
+        }
+        double GetEmptyPerc() const {
+            const uint64_t polls = GetPollNum();
+            return (polls > 0) ? hist[0] * 100.0 / polls : 0.0;
+        }
+        double GetFullPerc() const {
+            const uint64_t polls = GetPollNum();
+            return (polls > 0) ? hist[MAX_BUCKET] * 100.0 / polls : 0.0;
+        }
+        /**
+         * @brief The mean size of non-empty bursts in buckets
+         */
+        double GetMeanBurst() const {
+            uint64_t sum = 0, num = 0;
+            for (unsigned i=1;i<=MAX_BUCKET;++i) {
+                sum += hist[i] * i;
+                num += hist[i];
+            }
+            return (num > 0) ? (double)sum / num : 0.0;
+        }
+
+        Counters operator-(const Counters &r) const {
+            Counters diff;
+            for (unsigned i=0;i<=MAX_BUCKET;++i) {
+                diff.hist[i] = hist[i] - r.hist[i];
+            }
+            return diff;
+        }
+    };
+
+    /**
+     * @param maxBurst The max size of a burst, a power of 2 from 32
+     */
+    void SetMaxBurst(unsigned maxBurst) {
+        if (maxBurst < MAX_BUCKET || (maxBurst & (maxBurst - 1)) != 0) {
+            throw std::invalid_argument("Max burst must be a power of 2 from 32: " + std::to_string(maxBurst));
+        }
+        m_shift = __builtin_ctz(maxBurst) - __builtin_ctz(MAX_BUCKET);
+        m_maxBurst = maxBurst;
+    }
+    unsigned GetMaxBurst() const { return m_maxBurst; }
+
+    inline void Record(unsigned num) {
+        const unsigned bucket = (num == 0) ? 0 : ((num - 1) >> m_shift) + 1;
+        ++m_counters.hist[std::min(bucket, MAX_BUCKET)];
+    }
+
+    const Counters& GetCounters() const { return m_counters; }
+
+private:
+    Counters    m_counters;
+    unsigned    m_shift = 0;
+    unsigned    m_maxBurst = MAX_BUCKET;
+};
@@ -2,6 +2,8 @@
 
 #include "goose_container.hpp"
 #include "sv_container.hpp"
+#include "jitter_detector.hpp"
+#include "burst_stat.hpp"
 #include "dpdk_cpp/dpdk_cyclestat_class.hpp"
 
 #include <iostream>
@@ -108,5 +110,134 @@ namespace Console
             return std::cout;
         }
     };
+
+    class StageStat
+    {
+    public:
+        static void PrintTableHeader() {
+            std::cout << std::format("{:<16} | {:<10} | {:<12} | {:<10} | {:<10} | {:<10} | {:<10} |",
+                                     "", "Stage", "Packets", "Pkt/call", "Cycles/pkt", "Share %", "Max(us)")
+                      << std::endl
+                      << std::string(101, '-')
+                      << std::endl;
+        }
+
+        template< typename TStat >
+        static void PrintTableRows(const std::string &label, const TStat &st,
+                                   const char* const names[]) {
+            uint64_t totalCycles = 0;
+            for (unsigned i=0;i<TStat::STAGE_NUM;++i) {
+                totalCycles += st.cycles[i];
+            }
+            if (totalCycles == 0) {
+                return;
+            }
+
+            for (unsigned i=0;i<TStat::STAGE_NUM;++i) {
+                uint64_t packets = st.packets[i], calls = st.calls[i];
+                std::cout << std::format("{:<16} | {:<10} | {:<12} | {:<10.1f} | {:<10.1f} | {:<10.3f} | {:<10} |\n",
+                                         label,
+                                         names[i],
+                                         packets,
+                                         (calls > 0) ? (double)packets / calls : 0.0,
+                                         (packets > 0) ? (double)st.cycles[i] / packets : 0.0,
+                                         (double)st.cycles[i] / totalCycles * 100.0,
+                                         DPDK::Clocks::ticks_to_us(st.maxCycles[i]));
+            }
+        }
+    };
+
+    class BurstStat
+    {
+    public:
+        static void PrintTableHeader() {
+            std::cout << std::format("{:<16} | {:<12} | {:<8} | {:<8} | {:<8} | {}",
+                                     "RX bursts", "Polls", "Empty %", "Full %", "Mean", "Histogram(size: %)")
+                      << std::endl
+                      << std::string(100, '-')
+                      << std::endl;
+        }
+
+        /**
+         * @brief Sizes are in 1/32 of the max burst if it's bigger than 32
+         */
+        static void PrintTableRow(const std::string &label, const ::BurstStat::Counters &c, unsigned maxBurst) {
+            const uint64_t polls = c.GetPollNum();
+            const unsigned scale = maxBurst / ::BurstStat::MAX_BUCKET;
+            std::string hist;
+            for (unsigned i=1;i<=::BurstStat::MAX_BUCKET;++i) {
+                if (c.hist[i] * 1000 >= polls) {
+                    hist += std::format("{}: {:.1f}  ", i * scale, c.hist[i] * 100.0 / polls);
+                }
+            }
+            std::cout << std::format("{:<16} | {:<12} | {:<8.2f} | {:<8.2f} | {:<8.1f} | {}\n",
+                                     label, polls, c.GetEmptyPerc(), c.GetFullPerc(),
+                                     c.GetMeanBurst() * scale, hist);
+        }
+    };
+
+    class JitterStat
+    {
+    public:
+        static void PrintTableHeader() {
+            std::cout << std::format("{:<16} | {:<12} | {:<10} | {:<10} | {:<10} | {:<12} | {}",
+                                     "Jitter", "Samples", "Stalls", "Max(us)", "Overruns", "Max work(us)",
+                                     "Histogram(from us: count)")
+                      << std::endl
+                      << std::string(100, '-')
+                      << std::endl;
+        }
+
+        static void PrintTableRow(const std::string &label, const ::JitterDetector &jd) {
+            std::string hist;
+            for (unsigned i=0;i<::JitterDetector::BUCKET_NUM;++i) {
+                if (jd.GetBucketNum(i) > 0) {
+                    hist += std::format("{}: {}  ", ::JitterDetector::GetBucketStartUS(i), jd.GetBucketNum(i));
+                }
+            }
+            std::cout << std::format("{:<16} | {:<12} | {:<10} | {:<10} | {:<10} | {:<12} | {}\n",
+                                     label, jd.GetSampleNum(), jd.GetStallNum(), jd.GetMaxUS(),
+                                     jd.GetOverrunNum(), jd.GetMaxWorkUS(), hist);
+        }
+
+        /**
+         * @brief The last stalls of the lcore, the oldest first
+         */
+        static void PrintStalls(const ::JitterDetector &jd, size_t maxNum) {
+            for (const ::JitterDetector::Stall &st : jd.ReadStalls(maxNum)) {
+                std::cout << std::format("  LCore{}: TSC = {}, {} us\n",
+                                         st.lcore, st.tsc, DPDK::Clocks::ticks_to_us(st.ticks));
+            }
+        }
+    };
+
+    class ReorderStat
+    {
+    public:
+        static void PrintTableHeader() {
+            std::cout << std::format("{:<10} | {:<12} | {:<12} | {:<12} | {:<12} |",
+                                     "Reorder", "Reordered", "Late", "Duplicates", "Skipped")
+                      << std::endl
+                      << std::string(73, '-')
+                      << std::endl;
+        }
+
+        /**
+         * @brief Sums of the reorder windows of all sources in the container
+         */
+        template< typename TContainer >
+        static void PrintTableRow(const std::string &label, const TContainer &sources) {
+            uint64_t reordered = 0, late = 0, duplicates = 0, skipped = 0;
+            for (const auto &src : sources) {
+                const auto &window = src.second->GetReorder();
+                reordered += window.GetReorderedNum();
+                late += window.GetLateNum();
+                duplicates += window.GetDuplicateNum();
+                skipped += window.GetSkippedNum();
+            }
+            std::cout << std::format("{:<10} | {:<12} | {:<12} | {:<12} | {:<12} |\n",
+                                     label, reordered, late, duplicates, skipped);
+        }
+    };
 }
 
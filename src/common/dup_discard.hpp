@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class DuplicateDiscard
+ * @brief IEC 62439-3 duplicate discard of PRP/HSR: the sequence numbers of each
+ * source(MAC) are tracked in a sliding window, the second copy of a frame(from
+ * the other LAN) is dropped.
+ *
+ * Sources are in an open addressing table, one cache line per source, so a
+ * lookup of thousands of sources is usually one miss. Frame gaps of each LAN
+ * are counted as frames missing on that LAN. Single writer.
+ */
+class DuplicateDiscard
+{
+public:
+    static constexpr unsigned WINDOW = 256;     // Sequence numbers per source
+    static constexpr unsigned MAX_PROBE = 16;
+    static constexpr unsigned LAN_NUM = 2;
+
+    explicit DuplicateDiscard(unsigned capacity = 4096)
+    {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Duplicate discard table size must be a power of 2: " + std::to_string(capacity));
+        }
+        m_table.resize(capacity);
+        m_mask = capacity - 1;
+    }
+
+    /**
+     * @brief The frame of the source with the sequence number from the LAN
+     * @return true if it's a duplicate and must be dropped
+     */
+    inline bool IsDuplicate(uint64_t srcMAC, uint16_t seq, uint8_t lan) {
+        Entry *entry = Find(srcMAC);
+        if (entry == nullptr) {
+            ++m_overflowCnt;
+            return false;
+        }
+
+        lan &= 0x01;
+        const uint8_t lanBit = 1 << lan;
+        if (entry->seen == 0) {
+            entry->seen = lanBit;
+            entry->lastSeq[lan] = seq;
+            entry->maxSeq = seq;
+            Set(*entry, seq);
+            ++m_passedCnt;
+            return false;
+        }
+        if (entry->seen & lanBit) {
+            // Frames lost on the LAN are seen as a gap of its own sequence
+            const uint16_t gap = seq - entry->lastSeq[lan];
+            if (gap > 1 && gap < WINDOW) {
+                m_missingCnt[lan] += gap - 1;
+            }
+        }
+        entry->lastSeq[lan] = seq;
+        entry->seen |= lanBit;
+
+        const int16_t diff = (int16_t)(seq - entry->maxSeq);
+        if (diff > 0) {
+            // The window slides: sequence numbers skipped on both LANs are cleared
+            if ((unsigned)diff >= WINDOW) {
+                for (uint64_t &word : entry->window) {
+                    word = 0;
+                }
+            } else {
+                for (uint16_t s=entry->maxSeq + 1;s!=seq;++s) {
+                    Clear(*entry, s);
+                }
+            }
+            entry->maxSeq = seq;
+            Set(*entry, seq);
+            ++m_passedCnt;
+            return false;
+        }
+        if (-diff >= (int)WINDOW) {
+            // Too old to be checked: the source restarted or a LAN is far behind
+            ++m_outOfWindowCnt;
+            ++m_passedCnt;
+            return false;
+        }
+        if (Test(*entry, seq)) {
+            ++m_duplicateCnt;
+            return true;
+        }
+        Set(*entry, seq);
+        ++m_passedCnt;
+        return false;
+    }
+
+    size_t   GetSourceNum() const { return m_sourceNum; }
+    uint64_t GetPassedNum() const { return m_passedCnt; }
+    uint64_t GetDuplicateNum() const { return m_duplicateCnt; }
+    uint64_t GetMissingNum(uint8_t lan) const { return m_missingCnt[lan & 0x01]; }
+    uint64_t GetOutOfWindowNum() const { return m_outOfWindowCnt; }
+    uint64_t GetOverflowNum() const { return m_overflowCnt; }
+
+private:
+    struct alignas(64) Entry
+    {
+        uint64_t key = 0;                   // MAC with USED_BIT, 0 - empty
+        uint16_t maxSeq = 0;
+        uint16_t lastSeq[LAN_NUM] = {};
+        uint8_t  seen = 0;                  // LAN bits
+        uint64_t window[WINDOW / 64] = {};
+    };
+
+    static constexpr uint64_t USED_BIT = 1ULL << 63;
+
+    inline Entry* Find(uint64_t srcMAC) {
+        const uint64_t key = srcMAC | USED_BIT;
+        size_t pos = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+        for (unsigned i=0;i<MAX_PROBE;++i) {
+            Entry &entry = m_table[pos];
+            if (entry.key == key) {
+                return &entry;
+            }
+            if (entry.key == 0) {
+                entry.key = key;
+                ++m_sourceNum;
+                return &entry;
+            }
+            pos = (pos + 1) & m_mask;
+        }
+        return nullptr;
+    }
+
+    static inline void Set(Entry &entry, uint16_t seq) {
+        const uint8_t bit = seq % WINDOW;
+        entry.window[bit / 64] |= 1ULL << (bit % 64);
+    }
+    static inline void Clear(Entry &entry, uint16_t seq) {
+        const uint8_t bit = seq % WINDOW;
+        entry.window[bit / 64] &= ~(1ULL << (bit % 64));
+    }
+    static inline bool Test(const Entry &entry, uint16_t seq) {
+        const uint8_t bit = seq % WINDOW;
+        return (entry.window[bit / 64] & (1ULL << (bit % 64))) != 0;
+    }
+
+private:
+    std::vector< Entry >    m_table;
+    size_t                  m_mask = 0;
+
+    size_t      m_sourceNum = 0;
+    uint64_t    m_passedCnt = 0,
+                m_duplicateCnt = 0,
+                m_outOfWindowCnt = 0,
+                m_overflowCnt = 0;
+    uint64_t    m_missingCnt[LAN_NUM] = {};
+};
@@ -2,6 +2,7 @@
 
 #include "mac_addr.hpp"
 #include "appid_container.hpp"
+#include "reorder_window.hpp"
 
 #include <unordered_map>
 #include <memory>
@@ -71,6 +72,26 @@ struct GooseState
     }
 };
 
+/**
+ * @brief Sequence of GOOSE for the reorder window: by stNum, then by sqNum,
+ * a new stNum starts with sqNum 0 or 1
+ */
+struct GooseOrder
+{
+    static bool Before(const GooseState &a, const GooseState &b) {
+        if (a.stNum != b.stNum) {
+            return (int32_t)(b.stNum - a.stNum) > 0;
+        }
+        return (int32_t)(b.sqNum - a.sqNum) > 0;
+    }
+    static bool IsNext(const GooseState &last, const GooseState &s) {
+        if (s.stNum == last.stNum) {
+            return s.sqNum == last.sqNum + 1;
+        }
+        return (s.stNum == last.stNum + 1) && (s.sqNum <= 1);
+    }
+};
+
 /**
  * @struct GooseSource
  * @brief
@@ -109,6 +130,14 @@ public:
         m_numEntries = num;
         return *this;
     }
+    /**
+     * @brief Out of order frames wait for the missing ones up to maxWait ticks,
+     * 0 - the states are processed as they come
+     */
+    GooseSource&    SetReorderWait(uint64_t maxWait) {
+        m_reorder.SetMaxWait(maxWait);
+        return *this;
+    }
 
     MAC             GetDMAC() const {
         return m_dmac;
@@ -131,6 +160,9 @@ public:
     uint32_t        GetErrSeqNum() const {
         return m_errSeqCnt;
     }
+    const ReorderWindow< GooseState, GooseOrder >& GetReorder() const {
+        return m_reorder;
+    }
 
     GoosePassport   GetPassport() const {
         GoosePassport pass;
@@ -162,6 +194,36 @@ public:
         m_sqNum = state.sqNum;
     }
 
+    /**
+     * @brief The state of a frame received at the TSC moment goes through
+     * the reorder window if it's enabled
+     */
+    inline void     ProcessState(const GoosePassport &pass,
+                                 const GooseState &state, uint64_t tsc) {
+        if (!m_reorder.IsEnabled()) {
+            ProcessState(pass, state);
+            return;
+        }
+        m_reorder.Push(state, tsc, [&](const GooseState &s) { ProcessState(pass, s); });
+    }
+
+    void            FlushReorder() {
+        const GoosePassport pass = GetPassport();
+        m_reorder.Flush([&](const GooseState &s) { ProcessState(pass, s); });
+    }
+
+    /**
+     * @brief States which waited for the limit are processed
+     * @return true if states are still pending
+     */
+    bool            ExpireReorder(uint64_t now) {
+        if (m_reorder.GetPendingNum() > 0) {
+            const GoosePassport pass = GetPassport();
+            m_reorder.Expire(now, [&](const GooseState &s) { ProcessState(pass, s); });
+        }
+        return m_reorder.GetPendingNum() > 0;
+    }
+
     friend std::ostream& operator<<(std::ostream &out, const GooseSource &obj) {
         out << obj.GetPassport()
             << "\nState:\n"
@@ -184,6 +246,7 @@ private:
     // State
     uint32_t    m_stNum = 0, m_sqNum = 0;
     uint32_t    m_errSeqCnt = 0;
+    ReorderWindow< GooseState, GooseOrder > m_reorder;
 };
 
 using GooseContainer = AppIdContainer< GoosePassport, GooseSource::ptr >;
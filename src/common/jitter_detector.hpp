@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class JitterDetector
+ * @brief cyclictest inside a polling loop: the gap between consecutive polls
+ * (or the lateness of a planned moment) goes to a histogram, gaps above the
+ * threshold(SMI, kernel interference, TLB shootdown...) are kept with TSC time
+ * and lcore in a ring. A gap includes the loop's work, so the threshold must be
+ * above the normal processing of a full frame: work intervals above it are
+ * counted apart as overruns to tell a long pass from interference. One per lcore: the lcore writes, any thread reads
+ * without locks, the oldest stalls are overwritten.
+ */
+class JitterDetector
+{
+public:
+    static constexpr unsigned RING_SIZE = 256;
+    static constexpr unsigned BUCKET_NUM = 16;   // <1 us, [1, 2) us, [2, 4) us... >= 16 ms
+
+    struct Stall
+    {
+        uint64_t tsc = 0;       // The end of the gap
+        uint64_t ticks = 0;
+        uint16_t lcore = 0;
+    };
+
+    JitterDetector(uint16_t lcore, uint64_t thresholdTicks, uint64_t ticksPerUS)
+        : m_lcore(lcore), m_threshold(thresholdTicks), m_ticksPerUS(std::max< uint64_t >(ticksPerUS, 1))
+    {}
+
+    /**
+     * @brief An iteration of the polling loop at the TSC moment
+     */
+    inline void Poll(uint64_t now) {
+        if (m_last != 0) {
+            Record(now - m_last, now);
+        }
+        m_last = now;
+    }
+
+    /**
+     * @brief The loop's work(processing of a frame) took ticks
+     */
+    inline void RecordWork(uint64_t ticks) {
+        if (ticks > m_maxWorkTicks) {
+            m_maxWorkTicks = ticks;
+        }
+        if (ticks >= m_threshold) {
+            ++m_overrunCnt;
+        }
+    }
+
+    /**
+     * @brief The moment is later than planned by ticks(TX loops)
+     */
+    inline void Record(uint64_t ticks, uint64_t now) {
+        ++m_sampleCnt;
+        if (ticks < m_ticksPerUS) {
+            ++m_hist[0];
+            return;
+        }
+        ++m_hist[GetBucket(ticks / m_ticksPerUS)];
+        if (ticks > m_maxTicks) {
+            m_maxTicks = ticks;
+        }
+        if (ticks >= m_threshold) {
+            const uint64_t head = m_head;
+            m_ring[head % RING_SIZE] = Stall{ now, ticks, m_lcore };
+            __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    uint16_t GetLCore() const { return m_lcore; }
+    uint64_t GetSampleNum() const { return m_sampleCnt; }
+    uint64_t GetStallNum() const { return __atomic_load_n(&m_head, __ATOMIC_ACQUIRE); }
+    uint64_t GetMaxUS() const { return m_maxTicks / m_ticksPerUS; }
+    uint64_t GetOverrunNum() const { return m_overrunCnt; }
+    uint64_t GetMaxWorkUS() const { return m_maxWorkTicks / m_ticksPerUS; }
+    uint64_t GetBucketNum(unsigned idx) const { return m_hist[idx]; }
+
+    /**
+     * @brief The lower bound of the bucket in us
+     */
+    static uint64_t GetBucketStartUS(unsigned idx) {
+        return (idx == 0) ? 0 : (1ULL << (idx - 1));
+    }
+
+    /**
+     * @brief The last stalls, the oldest first. Stalls overwritten while
+     * they were copied are skipped.
+     */
+    std::vector< Stall > ReadStalls(size_t maxNum = RING_SIZE) const {
+        const uint64_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+        const uint64_t num = std::min< uint64_t >({ head, maxNum, RING_SIZE });
+
+        std::vector< Stall > stalls;
+        stalls.reserve(num);
+        for (uint64_t i=head - num;i<head;++i) {
+            stalls.push_back(m_ring[i % RING_SIZE]);
+        }
+
+        const uint64_t after = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+        if (after - (head - num) > RING_SIZE) {
+            const uint64_t lost = std::min< uint64_t >(after - (head - num) - RING_SIZE, num);
+            stalls.erase(stalls.begin(), stalls.begin() + lost);
+        }
+        return stalls;
+    }
+
+private:
+    static inline unsigned GetBucket(uint64_t us) {
+        const unsigned bucket = 64 - __builtin_clzll(us);
+        return std::min(bucket, BUCKET_NUM - 1);
+    }
+
+private:
+    uint16_t    m_lcore = 0;
+    uint64_t    m_threshold = 0;
+    uint64_t    m_ticksPerUS = 1;
+    uint64_t    m_last = 0;
+
+    uint64_t    m_sampleCnt = 0;
+    uint64_t    m_maxTicks = 0;
+    uint64_t    m_hist[BUCKET_NUM] = {};
+
+    uint64_t    m_overrunCnt = 0;   // Work intervals above the threshold
+    uint64_t    m_maxWorkTicks = 0;
+
+    Stall       m_ring[RING_SIZE];
+    uint64_t    m_head = 0;     // Stalls ever written
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * @class PtpClock
+ * @brief TSC -> PTP time(ns) for datapath cores.
+ *
+ * The PTP stage feeds (TSC, PTP time) samples into a PI servo, the mapping is
+ * published under a seqlock: readers on other lcores take it with a few loads
+ * and a multiplication, without locks or syscalls. Samples come from a single writer.
+ */
+class PtpClock
+{
+public:
+    enum State
+    {
+        UNLOCKED = 0,   // No samples
+        FREQ_EST,       // The first sample, frequency is estimated by the second one
+        LOCKED
+    };
+
+    // Linuxptp's defaults of PI servo for hardware timestamps
+    static constexpr double KP = 0.7;
+    static constexpr double KI = 0.3;
+    // Offset is stepped instead of slewed
+    static constexpr int64_t STEP_THRESHOLD_NS = 1'000'000;
+    static constexpr double MAX_FREQ_PPB = 500'000.0;
+
+    explicit PtpClock(uint64_t ticksPerSec)
+        : m_ticksPerSec(ticksPerSec), m_nominalNsPerTick(1e9 / ticksPerSec)
+    {
+        m_nsPerTick.store(m_nominalNsPerTick, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief PTP time of the TSC moment, 0 while the clock isn't synchronized
+     */
+    inline int64_t ToPtp(uint64_t tsc) const {
+        uint32_t seq0 = 0;
+        uint64_t baseTsc = 0;
+        int64_t basePtp = 0;
+        double nsPerTick = 0.0;
+        do {
+            seq0 = m_seq.load(std::memory_order_acquire);
+            baseTsc = m_baseTsc.load(std::memory_order_relaxed);
+            basePtp = m_basePtp.load(std::memory_order_relaxed);
+            nsPerTick = m_nsPerTick.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq0 & 1) != 0 || seq0 != m_seq.load(std::memory_order_relaxed));
+
+        if (basePtp == 0) {
+            return 0;
+        }
+        return basePtp + (int64_t)((double)(int64_t)(tsc - baseTsc) * nsPerTick);
+    }
+
+    /**
+     * @brief A new sample: PTP time of the TSC moment
+     * @return The offset of the sample from the current mapping, ns
+     */
+    int64_t Update(uint64_t tsc, int64_t ptpNS) {
+        int64_t offset = 0;
+        switch (m_state) {
+        case UNLOCKED: {
+            Publish(tsc, ptpNS, m_nominalNsPerTick);
+            m_state = FREQ_EST;
+            break;
+        }
+        case FREQ_EST: {
+            // Frequency of TSC against PTP by two samples, then the offset is stepped
+            if (tsc <= m_lastTsc || ptpNS <= m_lastPtp) {
+                Publish(tsc, ptpNS, m_nominalNsPerTick);
+                break;
+            }
+            double ratio = (double)(ptpNS - m_lastPtp) / ((double)(tsc - m_lastTsc) * m_nominalNsPerTick);
+            m_drift = Clamp((ratio - 1.0) * 1e9);
+            m_freqPPB = m_drift;
+            Publish(tsc, ptpNS, m_nominalNsPerTick * (1.0 + m_drift * 1e-9));
+            m_state = LOCKED;
+            break;
+        }
+        case LOCKED: {
+            offset = ptpNS - ToPtp(tsc);
+            if (std::llabs(offset) > STEP_THRESHOLD_NS) {
+                Publish(tsc, ptpNS, m_nsPerTick.load(std::memory_order_relaxed));
+                ++m_stepCnt;
+                break;
+            }
+
+            // PI: the offset is slewed until the next sample, the mapping stays continuous
+            double intervalSec = (double)(tsc - m_lastTsc) / m_ticksPerSec;
+            if (intervalSec <= 0.0) {
+                break;
+            }
+            double kiTerm = KI * offset / intervalSec;
+            double ppb = Clamp(KP * offset / intervalSec + m_drift + kiTerm);
+            m_drift = Clamp(m_drift + kiTerm);
+            m_freqPPB = ppb;
+
+            Publish(tsc, ToPtp(tsc), m_nominalNsPerTick * (1.0 + ppb * 1e-9));
+            break;
+        }
+        }
+
+        m_lastTsc = tsc;
+        m_lastPtp = ptpNS;
+        m_lastOffset = offset;
+        ++m_sampleCnt;
+        return offset;
+    }
+
+    State    GetState() const { return m_state; }
+    bool     IsLocked() const { return m_state == LOCKED; }
+    int64_t  GetLastOffset() const { return m_lastOffset; }
+    double   GetFreqPPB() const { return m_freqPPB; }
+    uint64_t GetSampleNum() const { return m_sampleCnt; }
+    uint64_t GetStepNum() const { return m_stepCnt; }
+
+private:
+    inline void Publish(uint64_t tsc, int64_t ptpNS, double nsPerTick) {
+        uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        m_baseTsc.store(tsc, std::memory_order_relaxed);
+        m_basePtp.store(ptpNS, std::memory_order_relaxed);
+        m_nsPerTick.store(nsPerTick, std::memory_order_relaxed);
+
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    static inline double Clamp(double ppb) {
+        return (ppb > MAX_FREQ_PPB) ? MAX_FREQ_PPB : ((ppb < -MAX_FREQ_PPB) ? -MAX_FREQ_PPB : ppb);
+    }
+
+private:
+    // Mapping: read by all lcores
+    alignas(64) std::atomic< uint32_t > m_seq = 0;
+    std::atomic< uint64_t > m_baseTsc = 0;
+    std::atomic< int64_t >  m_basePtp = 0;
+    std::atomic< double >   m_nsPerTick = 0.0;
+
+    // Servo: the writer only
+    alignas(64) uint64_t m_ticksPerSec = 1;
+    double      m_nominalNsPerTick = 1.0;
+    State       m_state = UNLOCKED;
+    uint64_t    m_lastTsc = 0;
+    int64_t     m_lastPtp = 0;
+    int64_t     m_lastOffset = 0;
+    double      m_drift = 0.0;
+    double      m_freqPPB = 0.0;
+    uint64_t    m_sampleCnt = 0,
+                m_stepCnt = 0;
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ReorderWindow
+ * @brief Frames of one stream may come out of order when they are spread over
+ * several RX queues, ports or workers. States wait in a small window sorted by
+ * sequence and are released in order; a missing frame is waited for up to the
+ * limit(TSC ticks) or until the window is full, then the window skips it.
+ *
+ * TOrder defines the sequence of states:
+ *  - static bool Before(const TState &a, const TState &b) - a goes before b
+ *  - static bool IsNext(const TState &last, const TState &s) - s follows last
+ *
+ * Frames behind the released ones are late, they are dropped and counted instead
+ * of a sequence error. Many late frames in a row mean the stream restarted,
+ * then the window follows it. Single writer.
+ */
+template< typename TState, typename TOrder, unsigned TSize = 8 >
+class ReorderWindow
+{
+public:
+    static_assert(TSize > 0, "Reorder window can't be empty");
+    static constexpr unsigned RESYNC_LATE_NUM = 2 * TSize;
+
+    void SetMaxWait(uint64_t ticks) { m_maxWait = ticks; }
+    bool IsEnabled() const { return m_maxWait > 0; }
+
+    /**
+     * @brief The state of a frame received at the TSC moment, released ones go
+     * to release(const TState&) in order
+     */
+    template< typename TRelease >
+    inline void Push(const TState &state, uint64_t now, TRelease &&release) {
+        if (!m_started) {
+            m_started = true;
+            Release(state, release);
+            return;
+        }
+        if (!TOrder::Before(m_last, state)) {
+            if (!TOrder::Before(state, m_last)) {
+                ++m_duplicateCnt;
+                return;
+            }
+            ++m_lateCnt;
+            if (++m_lateRun >= RESYNC_LATE_NUM) {
+                Flush(release);
+                Release(state, release);
+            }
+            return;
+        }
+        m_lateRun = 0;
+
+        // In order: the window isn't touched
+        if (m_num == 0 && TOrder::IsNext(m_last, state)) {
+            Release(state, release);
+            return;
+        }
+
+        unsigned pos = m_num;
+        while (pos > 0 && TOrder::Before(state, m_slots[pos - 1].state)) {
+            --pos;
+        }
+        if (pos > 0 && !TOrder::Before(m_slots[pos - 1].state, state)) {
+            ++m_duplicateCnt;
+            return;
+        }
+        if (pos < m_num) {
+            // Later frames of the stream came first
+            ++m_reorderedCnt;
+        }
+        for (unsigned i=m_num;i>pos;--i) {
+            m_slots[i] = m_slots[i - 1];
+        }
+        m_slots[pos] = Slot{ state, now };
+        ++m_num;
+
+        Drain(release);
+        while (m_num > 0 && (m_num == TSize || now - m_slots[0].tsc >= m_maxWait)) {
+            ++m_skippedCnt;
+            ReleaseHead(release);
+            Drain(release);
+        }
+    }
+
+    /**
+     * @brief States which waited for the limit are released even if no frame
+     * of the stream comes, e.g. the stream went quiet with a gap in it
+     */
+    template< typename TRelease >
+    inline void Expire(uint64_t now, TRelease &&release) {
+        while (m_num > 0 && now - m_slots[0].tsc >= m_maxWait) {
+            ++m_skippedCnt;
+            ReleaseHead(release);
+            Drain(release);
+        }
+    }
+
+    /**
+     * @brief All waiting states are released, e.g. when RX is over
+     */
+    template< typename TRelease >
+    void Flush(TRelease &&release) {
+        while (m_num > 0) {
+            ++m_skippedCnt;
+            ReleaseHead(release);
+            Drain(release);
+        }
+        m_lateRun = 0;
+    }
+
+    unsigned GetPendingNum() const { return m_num; }
+    uint64_t GetReorderedNum() const { return m_reorderedCnt; }
+    uint64_t GetLateNum() const { return m_lateCnt; }
+    uint64_t GetDuplicateNum() const { return m_duplicateCnt; }
+    uint64_t GetSkippedNum() const { return m_skippedCnt; }
+
+private:
+    struct Slot
+    {
+        TState      state;
+        uint64_t    tsc = 0;
+    };
+
+    template< typename TRelease >
+    inline void Release(const TState &state, TRelease &release) {
+        m_last = state;
+        release(state);
+    }
+
+    template< typename TRelease >
+    inline void ReleaseHead(TRelease &release) {
+        const TState state = m_slots[0].state;
+        for (unsigned i=1;i<m_num;++i) {
+            m_slots[i - 1] = m_slots[i];
+        }
+        --m_num;
+        Release(state, release);
+    }
+
+    // States which follow the released ones leave the window
+    template< typename TRelease >
+    inline void Drain(TRelease &release) {
+        while (m_num > 0 && TOrder::IsNext(m_last, m_slots[0].state)) {
+            ReleaseHead(release);
+        }
+    }
+
+private:
+    Slot        m_slots[TSize];
+    unsigned    m_num = 0;
+    TState      m_last;
+    bool        m_started = false;
+    unsigned    m_lateRun = 0;
+    uint64_t    m_maxWait = 0;
+
+    uint64_t    m_reorderedCnt = 0,
+                m_lateCnt = 0,
+                m_duplicateCnt = 0,
+                m_skippedCnt = 0;
+};
+
+/**
+ * @class ReorderPending
+ * @brief Streams of an lcore which hold states in their reorder windows. The
+ * lcore expires them from its polling loop, so a quiet stream doesn't keep its
+ * states until the next frame. TSource::ExpireReorder(now) returns true while
+ * the stream still has pending states. Single writer: the lcore owning the streams.
+ */
+template< typename TSource >
+class ReorderPending
+{
+public:
+    inline void Track(TSource *src) {
+        if (std::find(m_streams.begin(), m_streams.end(), src) == m_streams.end()) {
+            m_streams.push_back(src);
+        }
+    }
+
+    inline void Expire(uint64_t now) {
+        for (size_t i=0;i<m_streams.size();) {
+            if (m_streams[i]->ExpireReorder(now)) {
+                ++i;
+                continue;
+            }
+            m_streams[i] = m_streams.back();
+            m_streams.pop_back();
+        }
+    }
+
+    bool IsEmpty() const { return m_streams.empty(); }
+    size_t GetStreamNum() const { return m_streams.size(); }
+
+private:
+    std::vector< TSource* > m_streams;
+};
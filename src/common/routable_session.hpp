@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief IEC 61850-90-5 session protocol of R-GOOSE/R-SV over UDP.
+ * Offsets are from the start of UDP payload, multi-byte fields are big-endian.
+ *
+ *  0: SI                   - 0xA1 GOOSE, 0xA2 SV
+ *  1: LI = 0x18            - the length of the session header after LI
+ *  2: PI = 0x80            - Common session header
+ *  3: LI = 0x16
+ *  4: SPDU length(4)       - bytes after this field till the end of SPDU
+ *  8: SPDU number(4)
+ * 12: Version(2)
+ * 14: TimeOfCurrentKey(4)  - Security information
+ * 18: TimeToNextKey(2)
+ * 20: Encryption algorithm(1)
+ * 21: MAC algorithm(1)
+ * 22: Key ID(4)
+ * 26: Payload length(4)    - the payload PDU: type tag ... APDU
+ * 30: Payload type(1)      - 0x81 GOOSE, 0x82 SV
+ * 31: Simulation(1)
+ * 32: APPID(2)
+ * 34: APDU length(2)
+ * 36: APDU                 - the same as in L2 frames
+ *   : Signature tag 0x85, length(1), MAC
+ */
+namespace RSession
+{
+    const uint16_t UDP_PORT = 102;
+
+    const uint8_t SI_GOOSE = 0xA1;
+    const uint8_t SI_SV = 0xA2;
+    const uint8_t SESSION_LI = 0x18;
+    const uint8_t COMMON_PI = 0x80;
+    const uint8_t COMMON_LI = 0x16;
+    const uint8_t PAYLOAD_GOOSE = 0x81;
+    const uint8_t PAYLOAD_SV = 0x82;
+    const uint8_t SIGNATURE_TAG = 0x85;
+
+    const uint16_t VERSION = 2;
+
+    // The default multicast group, 239.192.0.1 in host order
+    const uint32_t DEF_GROUP = 0xEFC00001;
+
+    enum Offsets : uint16_t
+    {
+        SI_OFFSET = 0,
+        COMMON_PI_OFFSET = 2,
+        SPDU_LENGTH_OFFSET = 4,
+        SPDU_NUMBER_OFFSET = 8,
+        VERSION_OFFSET = 12,
+        KEY_TIME_OFFSET = 14,
+        NEXT_KEY_TIME_OFFSET = 18,
+        ENCRYPTION_OFFSET = 20,
+        MAC_OFFSET = 21,
+        KEY_ID_OFFSET = 22,
+        PAYLOAD_LENGTH_OFFSET = 26,
+        PAYLOAD_TYPE_OFFSET = 30,
+        SIMULATION_OFFSET = 31,
+        APPID_OFFSET = 32,
+        APDU_LENGTH_OFFSET = 34,
+        APDU_OFFSET = 36
+    };
+
+    // Signature without MAC: tag and zero length
+    const uint16_t SIGNATURE_SIZE = 2;
+
+    /**
+     * @brief Ethernet address of IPv4 multicast group (host order): 01:00:5E + low 23 bits
+     */
+    inline void multicast_mac(uint32_t group, uint8_t mac[6])
+    {
+        mac[0] = 0x01;
+        mac[1] = 0x00;
+        mac[2] = 0x5E;
+        mac[3] = (group >> 16) & 0x7F;
+        mac[4] = group >> 8;
+        mac[5] = group;
+    }
+}
@@ -2,9 +2,11 @@
 
 #include "mac_addr.hpp"
 #include "appid_container.hpp"
+#include "reorder_window.hpp"
 
 #include <format>
 #include <iostream>
+#include <memory>
 #include <ostream>
 
 /**
@@ -55,6 +57,27 @@ struct SVStreamPassport
 struct SVStreamState
 {
     uint16_t smpCnt = 0;
+    uint16_t step = 1;      // smpCnt of a frame is its first ASDU's: the number of ASDU
+};
+
+/**
+ * @brief Sequence of SV frames for the reorder window: smpCnt wraps to 0 at
+ * the sample rate, which isn't known, so a small smpCnt after a big one is
+ * the next second. smpCnt advances by the ASDU number of the frame.
+ */
+struct SVStreamOrder
+{
+    static constexpr uint16_t MAX_AHEAD = 1024;
+
+    static bool Before(const SVStreamState &a, const SVStreamState &b) {
+        if (b.smpCnt > a.smpCnt) {
+            return b.smpCnt - a.smpCnt <= MAX_AHEAD;
+        }
+        return (b.smpCnt < MAX_AHEAD) && (a.smpCnt - b.smpCnt > MAX_AHEAD);
+    }
+    static bool IsNext(const SVStreamState &last, const SVStreamState &s) {
+        return (s.smpCnt == last.smpCnt + s.step) || (s.smpCnt == 0);
+    }
 };
 
 class alignas(64) SVStreamSource
@@ -82,6 +105,14 @@ public:
         m_numASDU = num;
         return *this;
     }
+    /**
+     * @brief Out of order frames wait for the missing ones up to maxWait ticks,
+     * 0 - the states are processed as they come
+     */
+    SVStreamSource&    SetReorderWait(uint64_t maxWait) {
+        m_reorder.SetMaxWait(maxWait);
+        return *this;
+    }
 
     MAC             GetDMAC() const { 
         return m_dmac;
@@ -101,6 +132,9 @@ public:
     uint32_t        GetErrSeqNum() const {
         return m_errSmpCnt;
     }
+    const ReorderWindow< SVStreamState, SVStreamOrder >& GetReorder() const {
+        return m_reorder;
+    }
 
     SVStreamPassport GetPassport() const {
         SVStreamPassport pass;
@@ -114,7 +148,7 @@ public:
 
     inline void ProcessState(const SVStreamPassport &pass,
                              const SVStreamState &state) {
-        if ((state.smpCnt != (m_smpCnt + 1)) && (state.smpCnt != 0)) {
+        if ((state.smpCnt != (m_smpCnt + GetStep())) && (state.smpCnt != 0)) {
             ++m_errSmpCnt;
             /*
             std::cout << "Wrong smpCnt: " << m_smpCnt
@@ -125,6 +159,45 @@ public:
         m_smpCnt = state.smpCnt;
     }
 
+    /**
+     * @brief The state of a frame received at the TSC moment goes through
+     * the reorder window if it's enabled
+     */
+    inline void ProcessState(const SVStreamPassport &pass,
+                             const SVStreamState &state, uint64_t tsc) {
+        if (!m_reorder.IsEnabled()) {
+            ProcessState(pass, state);
+            return;
+        }
+        SVStreamState stepped = state;
+        stepped.step = GetStep();
+        m_reorder.Push(stepped, tsc, [&](const SVStreamState &s) { ProcessState(pass, s); });
+    }
+
+    void FlushReorder() {
+        const SVStreamPassport pass = GetPassport();
+        m_reorder.Flush([&](const SVStreamState &s) { ProcessState(pass, s); });
+    }
+
+    /**
+     * @brief States which waited for the limit are processed
+     * @return true if states are still pending
+     */
+    bool ExpireReorder(uint64_t now) {
+        if (m_reorder.GetPendingNum() > 0) {
+            const SVStreamPassport pass = GetPassport();
+            m_reorder.Expire(now, [&](const SVStreamState &s) { ProcessState(pass, s); });
+        }
+        return m_reorder.GetPendingNum() > 0;
+    }
+
+    /**
+     * @brief smpCnt advance per frame
+     */
+    inline uint16_t GetStep() const {
+        return (m_numASDU > 0) ? m_numASDU : 1;
+    }
+
     friend std::ostream& operator<<(std::ostream &out, const SVStreamSource &obj) {
         out << obj.GetPassport()
             << "\nState:\n"
@@ -144,6 +217,7 @@ private:
     // State
     uint32_t    m_smpCnt = 0;
     uint32_t    m_errSmpCnt = 0;
+    ReorderWindow< SVStreamState, SVStreamOrder > m_reorder;
 };
 
 using SVContainer = AppIdContainer< SVStreamPassport, SVStreamSource::ptr >;
@@ -1,6 +1,9 @@
 #include "utils.hpp"
 
+#include <arpa/inet.h>
+
 #include <iostream>
+#include <stdexcept>
 
 void set_thread_name(const std::string &name)
 {
@@ -76,3 +79,12 @@ void display_packet_as_array(const uint8_t *packet, size_t packetSize)
     printf("\n};\n");
 }
 
+
+uint32_t parse_ipv4(const std::string &ip)
+{
+    in_addr addr = {};
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address: " + ip);
+    }
+    return ntohl(addr.s_addr);
+}
@@ -20,3 +20,8 @@ int create_timerfd(int periodSec = 1);
 
 void display_packet_as_array(const uint8_t *packet, size_t packetSize);
 
+/**
+ * @brief Dotted IPv4 address in host order, throws std::invalid_argument
+ */
+uint32_t parse_ipv4(const std::string &ip);
+
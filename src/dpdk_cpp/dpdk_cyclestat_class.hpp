@@ -20,7 +20,8 @@ namespace DPDK
         }
         inline void MarkFinishCycling() {
             uint64_t finishTick = DPDK::Clocks::get_current_ticks();
-            m_loadPerc = (double)m_totalProcessTicks / (finishTick - m_startCycling) * 100.0;
+            m_totalCyclingTicks = finishTick - m_startCycling;
+            m_loadPerc = (double)m_totalProcessTicks / m_totalCyclingTicks * 100.0;
             m_waitPerc = (100.0 - m_loadPerc);
             m_maxProcUS = DPDK::Clocks::ticks_to_us(m_maxProcessByTicks);
             m_minProcUS = DPDK::Clocks::ticks_to_us(m_minProcessByTicks);
@@ -29,7 +30,10 @@ namespace DPDK
         inline void MarkProcBegin() {
             m_procBegin = DPDK::Clocks::get_current_ticks();
         }
-        inline void MarkProcEnd() {
+        /**
+         * @return The processing interval in ticks
+         */
+        inline uint64_t MarkProcEnd() {
             uint64_t delta = DPDK::Clocks::get_current_ticks() - m_procBegin;
             if (delta > m_maxProcessByTicks) {
                 m_maxProcessByTicks = delta;
@@ -38,6 +42,7 @@ namespace DPDK
                 m_minProcessByTicks = delta;
             }
             m_totalProcessTicks += delta;
+            return delta;
         }
 
         inline double GetLoadPerc() const {
@@ -52,10 +57,17 @@ namespace DPDK
         inline unsigned GetMinProcUS() const {
             return m_minProcUS;
         }
+        inline uint64_t GetProcessTicks() const {
+            return m_totalProcessTicks;
+        }
+        inline uint64_t GetCyclingTicks() const {
+            return m_totalCyclingTicks;
+        }
 
     private:
         uint64_t    m_startCycling = 0, m_procBegin = 0;
         uint64_t    m_totalProcessTicks = 0,
+                    m_totalCyclingTicks = 0,
                     m_maxProcessByTicks = 0,
                     m_minProcessByTicks = 0;
 
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <rte_bus_vdev.h>
+#include <rte_eventdev.h>
+#include <rte_service.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace DPDK
+{
+    /**
+     * @class EventDev
+     * @brief Software event device(event_sw) with one atomic queue: a port per
+     * worker and the producer's port after them. Events of a flow are never
+     * processed by two workers at once, any worker may take any flow.
+     *
+     * The scheduler of event_sw is a service, the producer's lcore runs it
+     * by Schedule(), so no service lcore is needed.
+     */
+    class EventDev
+    {
+    public:
+        static constexpr uint8_t QUEUE_ID = 0;
+
+        EventDev(const std::string &name, unsigned workerNum, uint16_t burstSize,
+                 int32_t eventLimit = 4096)
+            : m_name(name), m_workerNum(workerNum)
+        {
+            if (rte_vdev_init(name.c_str(), nullptr) != 0) {
+                throw std::runtime_error("Can't create event device: " + name);
+            }
+            int devID = rte_event_dev_get_dev_id(name.c_str());
+            if (devID < 0) {
+                rte_vdev_uninit(name.c_str());
+                throw std::runtime_error("Event device isn't found: " + name);
+            }
+            m_devID = devID;
+
+            try {
+                Configure(burstSize, eventLimit);
+            } catch (...) {
+                rte_event_dev_close(m_devID);
+                rte_vdev_uninit(m_name.c_str());
+                throw;
+            }
+        }
+
+        EventDev(const EventDev&) = delete;
+        EventDev& operator=(const EventDev&) = delete;
+
+        ~EventDev() {
+            rte_event_dev_stop(m_devID);
+            rte_event_dev_close(m_devID);
+            rte_vdev_uninit(m_name.c_str());
+        }
+
+        inline uint8_t GetID() const { return m_devID; }
+        inline uint8_t GetWorkerPort(unsigned idx) const { return idx; }
+        inline uint8_t GetProducerPort() const { return m_workerNum; }
+        inline uint16_t GetBurstSize() const { return m_burstSize; }
+
+        /**
+         * @brief One iteration of the scheduler: events go from the producer's
+         * port to the workers' ones
+         */
+        inline void Schedule() {
+            if (m_hasService) {
+                rte_service_run_iter_on_app_lcore(m_serviceID, 1);
+            }
+        }
+
+    private:
+        void Configure(uint16_t burstSize, int32_t eventLimit) {
+            rte_event_dev_info info;
+            if (rte_event_dev_info_get(m_devID, &info) != 0) {
+                throw std::runtime_error("Can't get event device info: " + m_name);
+            }
+            if (m_workerNum + 1 > info.max_event_ports) {
+                throw std::runtime_error("Event device has too few ports: "
+                                         + std::to_string(info.max_event_ports));
+            }
+            m_burstSize = std::min< uint16_t >(burstSize, std::min< uint32_t >(info.max_event_port_dequeue_depth,
+                                                                               info.max_event_port_enqueue_depth));
+
+            rte_event_dev_config devConf = {};
+            devConf.nb_event_queues = 1;
+            devConf.nb_event_ports = m_workerNum + 1;
+            devConf.nb_events_limit = std::min(eventLimit, info.max_num_events);
+            devConf.nb_event_queue_flows = info.max_event_queue_flows;
+            devConf.nb_event_port_dequeue_depth = m_burstSize;
+            devConf.nb_event_port_enqueue_depth = m_burstSize;
+            devConf.dequeue_timeout_ns = info.min_dequeue_timeout_ns;
+            if (rte_event_dev_configure(m_devID, &devConf) != 0) {
+                throw std::runtime_error("Can't configure event device: " + m_name);
+            }
+
+            rte_event_queue_conf queueConf;
+            rte_event_queue_default_conf_get(m_devID, QUEUE_ID, &queueConf);
+            queueConf.schedule_type = RTE_SCHED_TYPE_ATOMIC;
+            queueConf.nb_atomic_flows = info.max_event_queue_flows;
+            if (rte_event_queue_setup(m_devID, QUEUE_ID, &queueConf) != 0) {
+                throw std::runtime_error("Can't set up event queue: " + m_name);
+            }
+
+            const uint8_t queueID = QUEUE_ID;
+            for (unsigned port=0;port<=m_workerNum;++port) {
+                rte_event_port_conf portConf;
+                rte_event_port_default_conf_get(m_devID, port, &portConf);
+                portConf.dequeue_depth = m_burstSize;
+                portConf.enqueue_depth = m_burstSize;
+                // New events are refused above the limit: backpressure to the producer
+                portConf.new_event_threshold = devConf.nb_events_limit;
+                if (rte_event_port_setup(m_devID, port, &portConf) != 0) {
+                    throw std::runtime_error("Can't set up event port: " + std::to_string(port));
+                }
+                if (port < m_workerNum && rte_event_port_link(m_devID, port, &queueID, nullptr, 1) != 1) {
+                    throw std::runtime_error("Can't link event port: " + std::to_string(port));
+                }
+            }
+
+            // Hardware devices schedule by themselves
+            if (rte_event_dev_service_id_get(m_devID, &m_serviceID) == 0) {
+                rte_service_runstate_set(m_serviceID, 1);
+                rte_service_set_runstate_mapped_check(m_serviceID, 0);
+                m_hasService = true;
+            }
+
+            if (rte_event_dev_start(m_devID) != 0) {
+                throw std::runtime_error("Can't start event device: " + m_name);
+            }
+        }
+
+    private:
+        std::string m_name;
+        uint8_t     m_devID = 0;
+        unsigned    m_workerNum = 0;
+        uint16_t    m_burstSize = 0;
+        uint32_t    m_serviceID = 0;
+        bool        m_hasService = false;
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "dpdk_clocks_class.hpp"
+
+#include <rte_ethdev.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace DPDK
+{
+    /**
+     * @class NicClock
+     * @brief Mapping of CPU ticks to NIC's clock(rte_eth_read_clock) which is
+     * used by RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP. The rate is estimated by
+     * two samples, so call Calibrate() before the mapping. The owning lcore
+     * calls Recalibrate() periodically: the rate is measured over the whole
+     * interval since Calibrate() and the anchor is moved to the last sample.
+     * The mapping is published under a seqlock, ToNic() may be called by any lcore.
+     */
+    class NicClock
+    {
+    public:
+        explicit NicClock(uint16_t portID) : m_portID(portID) {}
+
+        void Calibrate(unsigned intervalMS = 100) {
+            Sample(m_firstTick, m_firstNic);
+            Clocks::delay_us(intervalMS * 1'000ULL);
+            Recalibrate();
+        }
+
+        /**
+         * @brief Re-anchor the mapping to a new sample, is called by one lcore only
+         */
+        void Recalibrate() {
+            uint64_t tick = 0, nic = 0;
+            Sample(tick, nic);
+            if (tick <= m_firstTick || nic <= m_firstNic) {
+                throw std::runtime_error("NIC clock doesn't run on port: " + std::to_string(m_portID));
+            }
+            Publish(tick, nic, (double)(nic - m_firstNic) / (double)(tick - m_firstTick));
+            m_recalibrateTick = tick + Clocks::get_ticks_per_sec();
+        }
+
+        /**
+         * @brief Recalibrate once per second, returns true if the mapping was updated
+         */
+        inline bool RecalibrateIfDue(uint64_t now) {
+            if (now < m_recalibrateTick) {
+                return false;
+            }
+            Recalibrate();
+            return true;
+        }
+
+        inline uint64_t ToNic(uint64_t tick) const {
+            uint32_t seq0 = 0;
+            uint64_t baseTick = 0, baseNic = 0;
+            double nicPerTick = 0.0;
+            do {
+                seq0 = m_seq.load(std::memory_order_acquire);
+                baseTick = m_baseTick.load(std::memory_order_relaxed);
+                baseNic = m_baseNic.load(std::memory_order_relaxed);
+                nicPerTick = m_nicPerTick.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((seq0 & 1) != 0 || seq0 != m_seq.load(std::memory_order_relaxed));
+
+            int64_t delta = (int64_t)(tick - baseTick);
+            return baseNic + (int64_t)(delta * nicPerTick);
+        }
+
+        inline double GetNicHz() const {
+            return m_nicPerTick.load(std::memory_order_relaxed) * Clocks::get_ticks_per_sec();
+        }
+
+    private:
+        /**
+         * @brief NIC clock is read between two CPU ticks, the middle is taken
+         */
+        void Sample(uint64_t &tick, uint64_t &nic) const {
+            uint64_t before = Clocks::get_current_ticks();
+            int retval = rte_eth_read_clock(m_portID, &nic);
+            uint64_t after = Clocks::get_current_ticks();
+            if (retval != 0) {
+                throw std::runtime_error("Can't read NIC clock on port: " + std::to_string(m_portID));
+            }
+            tick = before + (after - before) / 2;
+        }
+
+        inline void Publish(uint64_t tick, uint64_t nic, double nicPerTick) {
+            uint32_t seq = m_seq.load(std::memory_order_relaxed);
+            m_seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            m_baseTick.store(tick, std::memory_order_relaxed);
+            m_baseNic.store(nic, std::memory_order_relaxed);
+            m_nicPerTick.store(nicPerTick, std::memory_order_relaxed);
+
+            m_seq.store(seq + 2, std::memory_order_release);
+        }
+
+    private:
+        uint16_t    m_portID = 0xFFFF;
+
+        // Owned by the recalibrating lcore
+        uint64_t    m_firstTick = 0,
+                    m_firstNic = 0,
+                    m_recalibrateTick = UINT64_MAX;
+
+        // Mapping: read by all TX lcores
+        alignas(64) std::atomic< uint32_t > m_seq = 0;
+        std::atomic< uint64_t > m_baseTick = 0,
+                                m_baseNic = 0;
+        std::atomic< double >   m_nicPerTick = 1.0;
+    };
+}
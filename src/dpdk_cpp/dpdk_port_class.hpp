@@ -4,6 +4,7 @@
 #include <rte_ethdev.h>
 #include <rte_flow.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include <memory>
@@ -17,12 +18,23 @@ namespace DPDK
      */
     class Port
     {
-        Port(uint16_t m_portID) : m_portID(m_portID) {}
+        Port(uint16_t m_portID, bool txTimestamp = false, bool txUdpCksum = false, bool timesync = false)
+            : m_portID(m_portID), m_txTimestamp(txTimestamp), m_txUdpCksum(txUdpCksum),
+              m_timesync(timesync) {}
     public:
         Port() = delete;
         Port(const Port&) = delete;
         Port& operator=(const Port&) = delete;
 
+        Port(Port &&other) noexcept
+            : m_portID(other.m_portID), m_isStarted(other.m_isStarted),
+              m_txTimestamp(other.m_txTimestamp), m_txUdpCksum(other.m_txUdpCksum),
+              m_timesync(other.m_timesync), m_flows(std::move(other.m_flows))
+        {
+            other.m_portID = 0xFFFF;
+            other.m_isStarted = false;
+        }
+
         ~Port() {
             if (rte_eth_dev_is_valid_port(m_portID)) {
                 Stop();
@@ -54,6 +66,17 @@ namespace DPDK
 
         inline uint16_t GetID() const { return m_portID; }
 
+        /**
+         * @brief NUMA node of the port, the caller's one if it's unknown
+         */
+        static int GetSocket(uint16_t portID) {
+            int socket = rte_eth_dev_socket_id(portID);
+            return (socket >= 0) ? socket : (int)rte_socket_id();
+        }
+        inline bool IsTxTimestampEnabled() const { return m_txTimestamp; }
+        inline bool IsTxUdpCksumEnabled() const { return m_txUdpCksum; }
+        inline bool IsTimesyncEnabled() const { return m_timesync; }
+
         void SetPromisc(bool enable = true) {
             if (enable) {
                 rte_eth_promiscuous_enable(m_portID);
@@ -152,6 +175,92 @@ namespace DPDK
             }
         }
 
+        /**
+         * @brief GOOSE/SV of a publisher go to the queue: dst MAC, EtherType(after VLAN tag
+         * if vlan) and APPID, which is matched by RAW item right after EtherType.
+         * @param appid nullptr - any APPID
+         * @return nullptr if NIC can't offload the rule
+         */
+        rte_flow* AddBusFlow(const uint8_t dmac[6], uint16_t eth_type, const uint16_t *appid,
+                             bool vlan, uint16_t queue_id, uint32_t priority = 0) {
+            rte_flow_attr attr = { .priority = priority, .ingress = 1 };
+
+            rte_flow_item_eth eth_spec = {}, eth_mask = {};
+            std::copy(dmac, dmac + 6, eth_spec.dst.addr_bytes);
+            std::fill(eth_mask.dst.addr_bytes, eth_mask.dst.addr_bytes + 6, 0xFF);
+            eth_spec.type = rte_cpu_to_be_16(vlan ? RTE_ETHER_TYPE_VLAN : eth_type);
+            eth_mask.type = 0xFFFF;
+
+            rte_flow_item_vlan vlan_spec = { .inner_type = rte_cpu_to_be_16(eth_type) };
+            rte_flow_item_vlan vlan_mask = { .inner_type = 0xFFFF };
+
+            const uint16_t appid_be = rte_cpu_to_be_16(appid ? *appid : 0);
+            rte_flow_item_raw raw_spec = {};
+            raw_spec.relative = 1;
+            raw_spec.length = sizeof(appid_be);
+            raw_spec.pattern = (const uint8_t *)&appid_be;
+
+            rte_flow_item pattern[4] = {};
+            unsigned idx = 0;
+            pattern[idx++] = { RTE_FLOW_ITEM_TYPE_ETH, &eth_spec, nullptr, &eth_mask };
+            if (vlan) {
+                pattern[idx++] = { RTE_FLOW_ITEM_TYPE_VLAN, &vlan_spec, nullptr, &vlan_mask };
+            }
+            if (appid != nullptr) {
+                pattern[idx++] = { RTE_FLOW_ITEM_TYPE_RAW, &raw_spec, nullptr, nullptr };
+            }
+            pattern[idx] = { RTE_FLOW_ITEM_TYPE_END, nullptr, nullptr, nullptr };
+
+            rte_flow_action_queue queue = { .index = queue_id };
+            rte_flow_action actions[] = {
+                { RTE_FLOW_ACTION_TYPE_QUEUE, &queue },
+                { RTE_FLOW_ACTION_TYPE_END, nullptr },
+            };
+            return TryCreateFlow(attr, pattern, actions);
+        }
+
+        /**
+         * @brief Frames of the EtherType(after VLAN tag if vlan) are dropped by NIC,
+         * rules of higher priority(lower number) take them first
+         * @return nullptr if NIC can't offload the rule
+         */
+        rte_flow* AddDropFlow(uint16_t eth_type, bool vlan, uint32_t priority) {
+            rte_flow_attr attr = { .priority = priority, .ingress = 1 };
+
+            rte_flow_item_eth eth_spec = { .type = rte_cpu_to_be_16(vlan ? RTE_ETHER_TYPE_VLAN : eth_type) };
+            rte_flow_item_eth eth_mask = { .type = 0xFFFF };
+            rte_flow_item_vlan vlan_spec = { .inner_type = rte_cpu_to_be_16(eth_type) };
+            rte_flow_item_vlan vlan_mask = { .inner_type = 0xFFFF };
+
+            rte_flow_item pattern[] = {
+                { RTE_FLOW_ITEM_TYPE_ETH, &eth_spec, nullptr, &eth_mask },
+                { vlan ? RTE_FLOW_ITEM_TYPE_VLAN : RTE_FLOW_ITEM_TYPE_END,
+                  vlan ? &vlan_spec : nullptr, nullptr, vlan ? &vlan_mask : nullptr },
+                { RTE_FLOW_ITEM_TYPE_END, nullptr, nullptr, nullptr },
+            };
+
+            rte_flow_action actions[] = {
+                { RTE_FLOW_ACTION_TYPE_DROP, nullptr },
+                { RTE_FLOW_ACTION_TYPE_END, nullptr },
+            };
+            return TryCreateFlow(attr, pattern, actions);
+        }
+
+        /**
+         * @brief A flow of the port is destroyed, the rest stay
+         */
+        void RemoveFlow(rte_flow *flow) {
+            auto it = std::find(m_flows.begin(), m_flows.end(), flow);
+            if (it == m_flows.end()) {
+                return;
+            }
+            rte_flow_error error = {};
+            if (rte_flow_destroy(m_portID, flow, &error) < 0) {
+                std::cerr << "Can't destroy flow: " << (error.message ? error.message : "") << std::endl;
+            }
+            m_flows.erase(it);
+        }
+
         friend std::ostream& operator<<(std::ostream &out, Port &obj) {
             rte_eth_dev_info devInfo = {};
             if (rte_eth_dev_info_get(obj.m_portID, &devInfo) == 0) {
@@ -161,9 +270,26 @@ namespace DPDK
             return out;
         }
 
+    private:
+        inline rte_flow* TryCreateFlow(const rte_flow_attr &attr, const rte_flow_item *pattern,
+                                       const rte_flow_action *actions) {
+            rte_flow_error error = {};
+            if (rte_flow_validate(m_portID, &attr, pattern, actions, &error) != 0) {
+                return nullptr;
+            }
+            rte_flow* flow = rte_flow_create(m_portID, &attr, pattern, actions, &error);
+            if (flow != nullptr) {
+                m_flows.push_back(flow);
+            }
+            return flow;
+        }
+
     private:
         uint16_t m_portID = 0xFFFF;
         bool     m_isStarted = false;
+        bool     m_txTimestamp = false;
+        bool     m_txUdpCksum = false;
+        bool     m_timesync = false;
         std::vector< rte_flow* > m_flows;
 
     friend class PortBuilder;
@@ -195,6 +321,42 @@ namespace DPDK
             return *this;
         }
 
+        /**
+         * @brief Request RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP, it's silently
+         * skipped if NIC doesn't support it: check Port::IsTxTimestampEnabled()
+         */
+        PortBuilder& SetTxTimestamp(bool enable = true) {
+            m_txTimestamp = enable;
+            return *this;
+        }
+
+        /**
+         * @brief Request RTE_ETH_TX_OFFLOAD_UDP_CKSUM, it's silently skipped
+         * if NIC doesn't support it: check Port::IsTxUdpCksumEnabled()
+         */
+        PortBuilder& SetTxUdpCksum(bool enable = true) {
+            m_txUdpCksum = enable;
+            return *this;
+        }
+
+        /**
+         * @brief Request RTE_ETH_RX_OFFLOAD_SCATTER: frames over the data room
+         * of mbuf are chained, it's silently skipped if NIC doesn't support it
+         */
+        PortBuilder& SetRxScatter(bool enable = true) {
+            m_rxScatter = enable;
+            return *this;
+        }
+
+        /**
+         * @brief IEEE1588 timestamping(rte_eth_timesync_enable) and RX timestamp
+         * offload, check Port::IsTimesyncEnabled()
+         */
+        PortBuilder& SetTimestamping(bool enable = true) {
+            m_timestamping = enable;
+            return *this;
+        }
+
         Port Build() {
             if (m_mbufPool == nullptr) {
                 throw std::runtime_error("Mempool is not set!");
@@ -220,6 +382,22 @@ namespace DPDK
                 m_ethConf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_MULTI_SEGS;
             }
 
+            if (m_rxScatter && (devInfo.rx_offload_capa & RTE_ETH_RX_OFFLOAD_SCATTER)) {
+                m_ethConf.rxmode.offloads |= RTE_ETH_RX_OFFLOAD_SCATTER;
+            }
+
+            bool txTimestamp = false;
+            if (m_txTimestamp && (devInfo.tx_offload_capa & RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP)) {
+                m_ethConf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP;
+                txTimestamp = true;
+            }
+
+            bool txUdpCksum = false;
+            if (m_txUdpCksum && (devInfo.tx_offload_capa & RTE_ETH_TX_OFFLOAD_UDP_CKSUM)) {
+                m_ethConf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_UDP_CKSUM;
+                txUdpCksum = true;
+            }
+
             /* m_ethConf.link_speeds = RTE_ETH_LINK_SPEED_2_5G; */
             /* m_ethConf.link_speeds = RTE_ETH_LINK_SPEED_10G; */
             m_ethConf.link_speeds = RTE_ETH_LINK_SPEED_AUTONEG;
@@ -237,6 +415,8 @@ namespace DPDK
                 throw std::runtime_error("Can't adjust RX/TX descriptors");
             }
 
+            // Queues are on the node of the port
+            const int socket = Port::GetSocket(m_portID);
             for (uint16_t q=0;q<m_rxQueueNum;++q) {
                 rte_eth_rxconf *rxConf = &devInfo.default_rxconf;
                 rxConf->offloads = m_ethConf.rxmode.offloads;
@@ -244,7 +424,7 @@ namespace DPDK
                 if (rte_eth_rx_queue_setup(m_portID,
                                            q,
                                            m_rxDescNum,
-                                           rte_socket_id(),
+                                           socket,
                                            rxConf,
                                            m_mbufPool) != 0) {
                     throw std::runtime_error("RX queue setup failed");
@@ -258,16 +438,18 @@ namespace DPDK
                 if (rte_eth_tx_queue_setup(m_portID,
                                            q,
                                            m_txDescNum,
-                                           rte_socket_id(),
+                                           socket,
                                            txConf) != 0) {
                     throw std::runtime_error("TX queue setup failed");
                 }
             }
 
+            bool timesync = false;
             if (m_timestamping) {
-                rte_eth_timesync_enable(m_portID);
+                timesync = (rte_eth_timesync_enable(m_portID) == 0);
             }
-            return Port(m_portID);
+
+            return Port(m_portID, txTimestamp, txUdpCksum, timesync);
         }
 
     public:
@@ -279,6 +461,9 @@ namespace DPDK
         uint16_t        m_rxDescNum = 1024,
                         m_txDescNum = 1024;
         bool            m_timestamping = false;
+        bool            m_rxScatter = false;
+        bool            m_txTimestamp = false;
+        bool            m_txUdpCksum = false;
     };
 }
 
@@ -0,0 +1,47 @@
+#include "common/burst_stat.hpp"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(BurstStat, NicBursts)
+{
+    BurstStat burst;
+    burst.SetMaxBurst(32);
+    for (unsigned num : { 0, 0, 0, 0, 5, 32, 32, 7 }) {
+        burst.Record(num);
+    }
+    const BurstStat::Counters &c = burst.GetCounters();
+    ASSERT_EQ(c.GetPollNum(), 8);
+    ASSERT_DOUBLE_EQ(c.GetEmptyPerc(), 50.0);
+    ASSERT_DOUBLE_EQ(c.GetFullPerc(), 25.0);
+    ASSERT_DOUBLE_EQ(c.GetMeanBurst(), 19.0);
+    ASSERT_EQ(c.hist[5], 1);
+    ASSERT_EQ(c.hist[BurstStat::MAX_BUCKET], 2);
+
+    // The interval since a snapshot
+    const BurstStat::Counters last = c;
+    burst.Record(0);
+    burst.Record(32);
+    const BurstStat::Counters diff = burst.GetCounters() - last;
+    ASSERT_EQ(diff.GetPollNum(), 2);
+    ASSERT_DOUBLE_EQ(diff.GetEmptyPerc(), 50.0);
+    ASSERT_DOUBLE_EQ(diff.GetFullPerc(), 50.0);
+}
+
+TEST(BurstStat, RingBurstsAreScaled)
+{
+    BurstStat burst;
+    ASSERT_THROW(burst.SetMaxBurst(48), std::invalid_argument);
+    ASSERT_THROW(burst.SetMaxBurst(16), std::invalid_argument);
+
+    burst.SetMaxBurst(256);
+    burst.Record(0);
+    burst.Record(7);    // Less than a bucket isn't empty
+    burst.Record(16);
+    burst.Record(256);
+    const BurstStat::Counters &c = burst.GetCounters();
+    ASSERT_EQ(c.hist[0], 1);
+    ASSERT_EQ(c.hist[1], 1);
+    ASSERT_EQ(c.hist[2], 1);
+    ASSERT_EQ(c.hist[BurstStat::MAX_BUCKET], 1);
+}
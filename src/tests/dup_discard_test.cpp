@@ -0,0 +1,118 @@
+#include "common/dup_discard.hpp"
+#include "bus_processor/process_bus_parser.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+    const uint64_t SRC_MAC = 0x0A0B0C000001ULL;
+
+    /**
+     * @brief SV frame of 54 bytes with APPID = 0x4001 and PRP trailer
+     */
+    std::vector< uint8_t > make_prp_frame(uint16_t seq, uint8_t lan)
+    {
+        std::vector< uint8_t > frame = {
+            0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01,     // dst
+            0x0A, 0x0B, 0x0C, 0x00, 0x00, 0x01,     // src
+            0x88, 0xBA,                             // SV
+            0x40, 0x01,                             // APPID
+            0x00, 0x28,                             // Length
+            0x00, 0x00, 0x00, 0x00                  // Reserved
+        };
+        frame.resize(54, 0x00);
+        const uint16_t lsdu = frame.size() + ProcessBusParser::PRP_TRAILER_SIZE - 12;
+        frame.push_back(seq >> 8);
+        frame.push_back(seq & 0xFF);
+        frame.push_back((lan << 4) | (lsdu >> 8));
+        frame.push_back(lsdu & 0xFF);
+        frame.push_back(0x88);
+        frame.push_back(0xFB);
+        return frame;
+    }
+}
+
+TEST(DuplicateDiscard, DropSecondCopy)
+{
+    DuplicateDiscard dd(16);
+    for (uint16_t seq=0;seq<1000;++seq) {
+        ASSERT_FALSE(dd.IsDuplicate(SRC_MAC, seq, 0)) << seq;
+        ASSERT_TRUE(dd.IsDuplicate(SRC_MAC, seq, 1)) << seq;
+    }
+    // LAN B is ahead of LAN A
+    for (uint16_t seq=1000;seq<1100;seq+=2) {
+        ASSERT_FALSE(dd.IsDuplicate(SRC_MAC, seq + 1, 1));
+        ASSERT_FALSE(dd.IsDuplicate(SRC_MAC, seq, 0));
+        ASSERT_TRUE(dd.IsDuplicate(SRC_MAC, seq, 1));
+        ASSERT_TRUE(dd.IsDuplicate(SRC_MAC, seq + 1, 0));
+    }
+    ASSERT_EQ(dd.GetSourceNum(), 1);
+    ASSERT_EQ(dd.GetPassedNum(), 1100);
+    ASSERT_EQ(dd.GetDuplicateNum(), 1100);
+}
+
+TEST(DuplicateDiscard, MissingAndWrap)
+{
+    DuplicateDiscard dd(16);
+    // Sequence numbers wrap, LAN B loses 3 frames
+    for (uint32_t i=0;i<200;++i) {
+        const uint16_t seq = 65500 + i;
+        ASSERT_FALSE(dd.IsDuplicate(SRC_MAC, seq, 0));
+        if (i < 100 || i > 102) {
+            ASSERT_TRUE(dd.IsDuplicate(SRC_MAC, seq, 1)) << i;
+        }
+    }
+    ASSERT_EQ(dd.GetMissingNum(0), 0);
+    ASSERT_EQ(dd.GetMissingNum(1), 3);
+    ASSERT_EQ(dd.GetDuplicateNum(), 197);
+
+    // Out of the window: the source restarted
+    ASSERT_FALSE(dd.IsDuplicate(SRC_MAC, (uint16_t)(65500 + 199 - DuplicateDiscard::WINDOW), 0));
+    ASSERT_EQ(dd.GetOutOfWindowNum(), 1);
+}
+
+TEST(DuplicateDiscard, ManySources)
+{
+    DuplicateDiscard dd(8192);
+    for (uint64_t src=0;src<4000;++src) {
+        ASSERT_FALSE(dd.IsDuplicate(SRC_MAC + src, 7, 1));
+    }
+    for (uint64_t src=0;src<4000;++src) {
+        ASSERT_TRUE(dd.IsDuplicate(SRC_MAC + src, 7, 0));
+    }
+    ASSERT_EQ(dd.GetSourceNum(), 4000);
+    ASSERT_EQ(dd.GetOverflowNum(), 0);
+    ASSERT_THROW(DuplicateDiscard(1000), std::invalid_argument);
+}
+
+TEST(RedundancyTag, PrpTrailerAndHsrTag)
+{
+    std::vector< uint8_t > prp = make_prp_frame(0x1234, 0xB);
+    RedundancyTag tag;
+    ASSERT_TRUE(ProcessBusParser::get_redundancy_tag(prp.data(), prp.size(), tag));
+    ASSERT_FALSE(tag.hsr);
+    ASSERT_EQ(tag.seq, 0x1234);
+    ASSERT_EQ(tag.lan, 1);
+    ASSERT_EQ(ProcessBusParser::get_src_mac(prp.data()), SRC_MAC);
+
+    // The trailer isn't a part of the PDU
+    BusPduLocation loc;
+    ASSERT_EQ(ProcessBusParser::locate_pdu(prp.data(), prp.size(), loc), BUS_PROTO_SV);
+    ASSERT_EQ(loc.end, prp.size() - ProcessBusParser::PRP_TRAILER_SIZE);
+
+    // Wrong LSDU size: not a trailer
+    prp[prp.size() - 3] += 1;
+    ASSERT_FALSE(ProcessBusParser::get_redundancy_tag(prp.data(), prp.size(), tag));
+
+    // HSR tag of port A before the SV EtherType
+    std::vector< uint8_t > hsr = make_prp_frame(0, 0xA);
+    hsr.resize(hsr.size() - ProcessBusParser::PRP_TRAILER_SIZE);
+    const uint8_t hsrTag[] = { 0x89, 0x2F, 0x00, 0x2C, 0x00, 0x42 };
+    hsr.insert(hsr.begin() + 12, hsrTag, hsrTag + sizeof(hsrTag));
+    ASSERT_TRUE(ProcessBusParser::get_redundancy_tag(hsr.data(), hsr.size(), tag));
+    ASSERT_TRUE(tag.hsr);
+    ASSERT_EQ(tag.seq, 0x42);
+    ASSERT_EQ(tag.lan, 0);
+    ASSERT_EQ(ProcessBusParser::get_appid(hsr.data(), hsr.size()), 0x4001);
+}
@@ -207,7 +207,7 @@ TEST(BusGenerator, BasicUsage)
     auto units = gen.GetTxUnits();
     for (const auto &unit : units) {
         for (size_t i=0;i<unit.blocks.size();++i) {
-            auto &blk = unit.blocks[i];
+            const auto &blk = unit.blocks[i];
 
             for (size_t j=0;j<blk.packets.size();++j) {
                 gen.AmendPacket(buffer.data(), blk.packets[j]);
@@ -234,7 +234,7 @@ TEST(BusGenerator, CheckPacketsByLibiec61850)
     auto &units = gen.GetTxUnits();
     for (const auto &unit : units) {
         for (size_t i=0;i<unit.blocks.size();++i) {
-            auto &blk = unit.blocks[i];
+            const auto &blk = unit.blocks[i];
 
             for (size_t j=0;j<blk.packets.size();++j) {
                 gen.AmendPacket(buffer.data(), blk.packets[j]);
@@ -247,6 +247,91 @@ TEST(BusGenerator, CheckPacketsByLibiec61850)
     }
 }
 
+TEST(BusGenerator, GooseEventState)
+{
+    const unsigned GooseNum = 2, SndFreq = 1, SignalNum = 16;
+    GooseTrafficGen gen(GooseNum, SndFreq, SignalNum);
+
+    std::vector< uint8_t > buffer(gen.GetSkeletonBuffer(),
+                                  gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+    GoosePassport passport;
+    GooseState state;
+
+    // A change and its retransmissions: stNum is kept, sqNum goes from 0
+    gen.ChangeState(1, GooseTrafficGen::ToUtcTime(1'000'000'000ULL));
+    for (uint32_t sq=0;sq<3;++sq) {
+        size_t size = gen.AmendEventPacket(buffer.data(), GoosePacketDesc{ 1 });
+        ASSERT_EQ(ProcessBusParser::parse_goose_packet(buffer.data(), size, passport, state), 0);
+        ASSERT_EQ(state.stNum, 1);
+        ASSERT_EQ(state.sqNum, sq);
+    }
+
+    gen.ChangeState(1, GooseTrafficGen::ToUtcTime(2'000'000'000ULL));
+    size_t size = gen.AmendEventPacket(buffer.data(), GoosePacketDesc{ 1 });
+    ASSERT_EQ(ProcessBusParser::parse_goose_packet(buffer.data(), size, passport, state), 0);
+    ASSERT_EQ(state.stNum, 2);
+    ASSERT_EQ(state.sqNum, 0);
+}
+
+TEST(GooseFastParser, RoutableGoose)
+{
+    const unsigned GooseNum = 2, SndFreq = 1, SignalNum = 16;
+    GooseTrafficGen gen(GooseNum, SndFreq, SignalNum);
+    gen.MakeRoutable(RoutableConfig());
+
+    std::vector< uint8_t > buffer(gen.GetSkeletonBuffer(),
+                                  gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+    GoosePassport passport;
+    GooseState state;
+
+    size_t size = gen.AmendPacket(buffer.data(), GoosePacketDesc{ 1 });
+    unsigned appid = 0;
+    ASSERT_EQ(ProcessBusParser::get_proto_type(buffer.data(), size, &appid), BUS_PROTO_GOOSE);
+    ASSERT_EQ(appid, 2);
+
+    ASSERT_EQ(ProcessBusParser::parse_goose_packet(buffer.data(), size, passport, state), 0);
+    ASSERT_EQ(passport.appid, 2);
+    ASSERT_EQ(passport.dmac, MAC("01:00:5E:40:00:01"));
+    ASSERT_EQ(passport.num, SignalNum);
+    uint32_t stNum = state.stNum;
+
+    gen.AmendPacket(buffer.data(), GoosePacketDesc{ 1 });
+    ASSERT_EQ(ProcessBusParser::parse_goose_packet(buffer.data(), size, passport, state), 0);
+    ASSERT_EQ(state.stNum, stNum + 1);
+
+    // Not UDP port 102: IP traffic
+    buffer[18 + 20 + 3] = 103;
+    ASSERT_EQ(ProcessBusParser::get_proto_type(buffer.data(), size, &appid), NON_BUS_PROTO);
+}
+
+TEST(BusGenerator, TxSchedule)
+{
+    // 70 IEDs in blocks of 32: 32 + 32 + 6
+    TxSchedule< GoosePacketDesc > units(3, 70, 32);
+    ASSERT_EQ(units.size(), 3);
+
+    ASSERT_EQ(units[0].offsetNS, 0);
+    ASSERT_EQ(units[1].offsetNS, 333'333'333);
+    ASSERT_EQ(units[2].offsetNS, 666'666'666);
+    ASSERT_EQ(units[2].offsetUS, 666'666);
+
+    for (const auto &unit : units) {
+        ASSERT_EQ(unit.GetPacketNum(), 70);
+        ASSERT_EQ(unit.blocks.size(), 3);
+        ASSERT_EQ(unit.blocks[2].packets.size(), 6);
+
+        // Each IED once, in order
+        unsigned next = 0;
+        for (const auto &blk : unit.blocks) {
+            for (const auto &desc : blk.packets) {
+                ASSERT_EQ(desc.idx, next);
+                ++next;
+            }
+        }
+        ASSERT_EQ(next, 70);
+    }
+}
+
 TEST(GooseFastParser, BasicUsage)
 {
     uint8_t packet[MAX_PACKET_SIZE] = { 0 };
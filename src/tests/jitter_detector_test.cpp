@@ -0,0 +1,81 @@
+#include "common/jitter_detector.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    const uint64_t TICKS_PER_US = 1000;
+    const uint64_t THRESHOLD = 50 * TICKS_PER_US;
+}
+
+TEST(JitterDetector, HistogramAndStalls)
+{
+    JitterDetector jd(3, THRESHOLD, TICKS_PER_US);
+
+    uint64_t now = 1'000'000;
+    jd.Poll(now);
+    for (unsigned i=0;i<1000;++i) {
+        now += 200;
+        jd.Poll(now);
+    }
+    // 3 us, then a stall of 100 us
+    now += 3 * TICKS_PER_US;
+    jd.Poll(now);
+    now += 100 * TICKS_PER_US;
+    jd.Poll(now);
+
+    ASSERT_EQ(jd.GetSampleNum(), 1002);
+    ASSERT_EQ(jd.GetBucketNum(0), 1000);
+    ASSERT_EQ(jd.GetBucketNum(2), 1);       // [2, 4) us
+    ASSERT_EQ(jd.GetBucketNum(7), 1);       // [64, 128) us
+    ASSERT_EQ(JitterDetector::GetBucketStartUS(7), 64);
+    ASSERT_EQ(jd.GetMaxUS(), 100);
+
+    auto stalls = jd.ReadStalls();
+    ASSERT_EQ(stalls.size(), 1);
+    ASSERT_EQ(stalls[0].tsc, now);
+    ASSERT_EQ(stalls[0].ticks, 100 * TICKS_PER_US);
+    ASSERT_EQ(stalls[0].lcore, 3);
+}
+
+TEST(JitterDetector, RingKeepsLastStalls)
+{
+    JitterDetector jd(0, THRESHOLD, TICKS_PER_US);
+
+    const unsigned STALL_NUM = JitterDetector::RING_SIZE + 10;
+    for (unsigned i=0;i<STALL_NUM;++i) {
+        jd.Record(THRESHOLD + i, i);
+    }
+    ASSERT_EQ(jd.GetStallNum(), STALL_NUM);
+
+    auto stalls = jd.ReadStalls();
+    ASSERT_EQ(stalls.size(), JitterDetector::RING_SIZE);
+    ASSERT_EQ(stalls.front().tsc, 10);
+    ASSERT_EQ(stalls.back().tsc, STALL_NUM - 1);
+
+    stalls = jd.ReadStalls(4);
+    ASSERT_EQ(stalls.size(), 4);
+    ASSERT_EQ(stalls.front().tsc, STALL_NUM - 4);
+
+    // The last bucket takes everything longer
+    jd.Record(TICKS_PER_US << 40, 0);
+    ASSERT_EQ(jd.GetBucketNum(JitterDetector::BUCKET_NUM - 1), 1);
+}
+
+TEST(JitterDetector, WorkOverruns)
+{
+    JitterDetector jd(0, THRESHOLD, TICKS_PER_US);
+
+    // A pass of 80 us is in the gap, but it's counted as an overrun too
+    uint64_t now = 1'000'000;
+    jd.Poll(now);
+    jd.RecordWork(80 * TICKS_PER_US);
+    now += 81 * TICKS_PER_US;
+    jd.Poll(now);
+    jd.RecordWork(10 * TICKS_PER_US);
+
+    ASSERT_EQ(jd.GetStallNum(), 1);
+    ASSERT_EQ(jd.GetMaxUS(), 81);
+    ASSERT_EQ(jd.GetOverrunNum(), 1);
+    ASSERT_EQ(jd.GetMaxWorkUS(), 80);
+}
@@ -174,3 +174,86 @@ TEST(Pipeline, BasicUsage2)
     ASSERT_EQ(result, 5);
 }
 
+
+namespace
+{
+    uint64_t g_fakeClock = 0;
+
+    uint64_t fake_clock()
+    {
+        return g_fakeClock += 10;
+    }
+}
+
+TEST(Pipeline, StageCycleStat)
+{
+    using TestStat = Pipeline::StageCycleStat< STAGE_NUM, &fake_clock >;
+    using TestMatrix = Pipeline::Matrix< EStages,
+                                         Pipeline::Frame< uint8_t, 32 >,
+                                         TestApp,
+                                         TestStat >;
+    TestApp app;
+    TestMatrix matrix(&app);
+
+    unsigned packets[] = { EStages::GOOSE, EStages::SV, EStages::SV, EStages::IP };
+    const unsigned TOTAL = sizeof(packets) / sizeof(packets[0]);
+    for (unsigned i=0;i<TOTAL;++i) {
+        matrix.stages[START_STAGE].buf[i] = (uint8_t *)&packets[i];
+    }
+    matrix.stages[START_STAGE].num = TOTAL;
+
+    using MeasuredChain = Pipeline::StaticChain<
+        Pipeline::Measured< ROUTER, RouterStage< TestMatrix > >,
+        Pipeline::Measured< GOOSE, GooseStage< TestMatrix > >,
+        Pipeline::Measured< SV, SampledValuesStage< TestMatrix > >,
+        Pipeline::Measured< IP, IPStage< TestMatrix > >
+    >;
+    MeasuredChain::run(matrix);
+
+    ASSERT_EQ(app.goose, 1);
+    ASSERT_EQ(app.sv, 2);
+    ASSERT_EQ(app.ip, 1);
+
+    ASSERT_EQ(matrix.stat.packets[ROUTER], TOTAL);
+    ASSERT_EQ(matrix.stat.packets[GOOSE], 1);
+    ASSERT_EQ(matrix.stat.packets[SV], 2);
+    ASSERT_EQ(matrix.stat.packets[IP], 1);
+    for (unsigned i=0;i<STAGE_NUM;++i) {
+        ASSERT_EQ(matrix.stat.calls[i], 1) << "Stage = " << i;
+        ASSERT_EQ(matrix.stat.cycles[i], 10) << "Stage = " << i;
+    }
+
+    // Empty frames aren't accounted
+    MeasuredChain::run(matrix);
+    ASSERT_EQ(matrix.stat.calls[ROUTER], 1);
+}
+
+TEST(Pipeline, NoStageStatIsEmpty)
+{
+    using TestMatrix = Pipeline::Matrix< EStages,
+                                         Pipeline::Frame< uint8_t, 32 >,
+                                         TestApp >;
+    using BareMatrix = struct {
+        Pipeline::Frame< uint8_t, 32 > stages[STAGE_NUM];
+        TestApp *app;
+    };
+    ASSERT_EQ(sizeof(TestMatrix), sizeof(BareMatrix));
+}
+
+TEST(Pipeline, FrameOverflow)
+{
+    Pipeline::Frame< uint8_t, 4 > frame;
+    uint8_t data[5] = {};
+
+    ASSERT_EQ(frame.CAPACITY, 4);
+    for (unsigned i=0;i<4;++i) {
+        ASSERT_FALSE(frame.IsFull());
+        ASSERT_TRUE(frame.PutBuffer(&data[i]));
+    }
+    ASSERT_TRUE(frame.IsFull());
+
+    // Full frame keeps its buffers
+    ASSERT_FALSE(frame.PutBuffer(&data[4]));
+    ASSERT_EQ(frame.num, 4);
+    ASSERT_EQ(frame.buf[3], &data[3]);
+}
@@ -0,0 +1,51 @@
+#include "bus_processor/pool_sizing.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(PoolSizing, ByConfiguredStreams)
+{
+    PoolSizing::Config conf;
+    conf.gooseNum = 100;
+    conf.sv80Num = 100;
+    conf.portNum = 2;
+    conf.lcoreNum = 3;
+    conf.ringNum = 2;
+
+    const PoolSizing sizing(conf);
+    ASSERT_EQ(sizing.GetPPS(), 100 * PoolSizing::GOOSE_PPS + 100 * PoolSizing::SV80_PPS
+                               + PoolSizing::OTHER_PPS);
+    // 5100 frames of 10 ms
+    ASSERT_EQ(sizing.GetRxDescNum(), 8192);
+    ASSERT_EQ(sizing.GetRingSize(), 8192);
+    ASSERT_EQ(sizing.GetMbufNum(), 64 * 1024 - 1);
+    ASSERT_GE(sizing.GetMbufNum(), 2 * (8192 + conf.txDescNum) + 2 * 8192
+                                   + 3 * (conf.frameSize + conf.cacheNum * 3 / 2));
+    ASSERT_EQ(sizing.GetDataRoom(), PoolSizing::SMALL_DATA);
+    ASSERT_EQ(sizing.GetMbufSize(), conf.headroom + PoolSizing::SMALL_DATA);
+    // Far from 2M mbufs of 2 KB
+    ASSERT_LT(sizing.GetBytes(), 64ULL * 1024 * 1024);
+}
+
+TEST(PoolSizing, Limits)
+{
+    PoolSizing::Config conf;
+    conf.sv256Num = 1;
+    PoolSizing sizing(conf);
+    ASSERT_EQ(sizing.GetRxDescNum(), PoolSizing::MIN_DESC);
+    ASSERT_EQ(sizing.GetRingSize(), PoolSizing::MIN_RING);
+    ASSERT_EQ(sizing.GetDataRoom(), PoolSizing::LARGE_DATA);
+
+    conf.sv80Num = 4000;
+    conf.bufferUS = 100000;
+    conf.dataRoom = 2048;
+    sizing = PoolSizing(conf);
+    ASSERT_EQ(sizing.GetRxDescNum(), PoolSizing::MAX_DESC);
+    ASSERT_EQ(sizing.GetRingSize(), PoolSizing::MAX_RING);
+    ASSERT_EQ(sizing.GetDataRoom(), 2048);
+
+    // af_xdp rejects a smaller data room than its frame
+    conf.dataRoom = 0;
+    conf.xdp = true;
+    sizing = PoolSizing(conf);
+    ASSERT_EQ(sizing.GetDataRoom(), PoolSizing::XDP_DATA);
+}
@@ -0,0 +1,96 @@
+#include "common/ptp_clock.hpp"
+#include "bus_processor/process_bus_parser.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    // 2 GHz TSC which runs 50 ppm faster than PTP time
+    const uint64_t TICKS_PER_SEC = 2'000'000'000ULL;
+    const double TSC_PPM = 50.0;
+    const int64_t PTP_START_NS = 1'700'000'000'000'000'000LL;
+
+    inline int64_t true_ptp(uint64_t tsc) {
+        return PTP_START_NS + (int64_t)((double)tsc / (TICKS_PER_SEC * (1.0 + TSC_PPM * 1e-6)) * 1e9);
+    }
+}
+
+TEST(PtpClock, NotSynchronized)
+{
+    PtpClock clock(TICKS_PER_SEC);
+    ASSERT_EQ(clock.GetState(), PtpClock::UNLOCKED);
+    ASSERT_EQ(clock.ToPtp(12345), 0);
+}
+
+TEST(PtpClock, ServoConvergence)
+{
+    PtpClock clock(TICKS_PER_SEC);
+
+    // Sync each second with +-40 ns of timestamp noise
+    uint64_t tsc = 1'000'000;
+    for (unsigned i=0;i<30;++i) {
+        int64_t noise = (int64_t)((i * 7919) % 81) - 40;
+        clock.Update(tsc, true_ptp(tsc) + noise);
+        tsc += TICKS_PER_SEC;
+    }
+    ASSERT_TRUE(clock.IsLocked());
+    ASSERT_EQ(clock.GetStepNum(), 0);
+    ASSERT_LT(std::llabs(clock.GetLastOffset()), 100);
+    ASSERT_NEAR(clock.GetFreqPPB(), -TSC_PPM * 1000.0 / (1.0 + TSC_PPM * 1e-6), 200.0);
+
+    // Between samples the mapping follows PTP time
+    uint64_t mid = tsc - TICKS_PER_SEC / 2;
+    ASSERT_LT(std::llabs(clock.ToPtp(mid) - true_ptp(mid)), 200);
+}
+
+TEST(PtpClock, StepOnLargeOffset)
+{
+    PtpClock clock(TICKS_PER_SEC);
+    uint64_t tsc = 0;
+    for (unsigned i=0;i<5;++i) {
+        clock.Update(tsc, true_ptp(tsc));
+        tsc += TICKS_PER_SEC;
+    }
+
+    // Grandmaster's time jumps by 1 sec
+    clock.Update(tsc, true_ptp(tsc) + 1'000'000'000LL);
+    ASSERT_EQ(clock.GetStepNum(), 1);
+    ASSERT_LT(std::llabs(clock.ToPtp(tsc) - true_ptp(tsc) - 1'000'000'000LL), 10);
+}
+
+TEST(PtpParser, FollowUp)
+{
+    std::vector< uint8_t > packet = {
+        0x01, 0x1B, 0x19, 0x00, 0x00, 0x00,     // dst
+        0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5,     // src
+        0x88, 0xF7,                             // PTP
+        0x08, 0x02, 0x00, 0x2C,                 // Follow_Up, v2, length 44
+        0x05, 0x00, 0x00, 0x00,                 // domain 5, flags
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, // correction 100 ns
+        0x00, 0x00, 0x00, 0x00,
+        0x00, 0x11, 0x22, 0xFF, 0xFE, 0x33, 0x44, 0x55, 0x00, 0x01, // sourcePortIdentity
+        0x12, 0x34,                             // sequenceId
+        0x02, 0x00,
+        0x00, 0x00, 0x65, 0x00, 0x00, 0x00,     // seconds
+        0x00, 0x00, 0x03, 0xE8                  // 1000 ns
+    };
+    unsigned appid = 0;
+    ASSERT_EQ(ProcessBusParser::get_proto_type(packet.data(), packet.size(), &appid), BUS_PROTO_PTP);
+
+    PtpMessage msg;
+    ASSERT_EQ(ProcessBusParser::parse_ptp_packet(packet.data(), packet.size(), msg), 0);
+    ASSERT_EQ(msg.type, PTP_FOLLOW_UP);
+    ASSERT_FALSE(msg.IsEvent());
+    ASSERT_EQ(msg.domain, 5);
+    ASSERT_EQ(msg.correctionNS, 100);
+    ASSERT_EQ(msg.clockID, 0x001122FFFE334455ULL);
+    ASSERT_EQ(msg.portNum, 1);
+    ASSERT_EQ(msg.seqID, 0x1234);
+    ASSERT_EQ(msg.timestampNS, 0x65000000LL * 1'000'000'000LL + 1000);
+
+    // PTPv1 isn't supported
+    packet[15] = 0x01;
+    ASSERT_NE(ProcessBusParser::parse_ptp_packet(packet.data(), packet.size(), msg), 0);
+}
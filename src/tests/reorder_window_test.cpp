@@ -0,0 +1,161 @@
+#include "common/reorder_window.hpp"
+#include "common/sv_container.hpp"
+#include "common/goose_container.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+    const uint64_t MAX_WAIT = 100;
+
+    using SVWindow = ReorderWindow< SVStreamState, SVStreamOrder, 8 >;
+
+    std::vector< uint16_t > push_all(SVWindow &window, const std::vector< uint16_t > &smpCnts,
+                                     uint64_t tsc = 0)
+    {
+        std::vector< uint16_t > released;
+        for (uint16_t smpCnt : smpCnts) {
+            window.Push(SVStreamState{ smpCnt }, tsc,
+                        [&](const SVStreamState &s) { released.push_back(s.smpCnt); });
+        }
+        return released;
+    }
+}
+
+TEST(ReorderWindow, ReleaseInOrder)
+{
+    SVWindow window;
+    window.SetMaxWait(MAX_WAIT);
+
+    auto released = push_all(window, { 0, 1, 3, 2, 4, 6, 7, 5, 8 });
+    ASSERT_EQ(released, std::vector< uint16_t >({ 0, 1, 2, 3, 4, 5, 6, 7, 8 }));
+    ASSERT_EQ(window.GetReorderedNum(), 2);
+    ASSERT_EQ(window.GetLateNum(), 0);
+    ASSERT_EQ(window.GetSkippedNum(), 0);
+    ASSERT_EQ(window.GetPendingNum(), 0);
+
+    // A copy and a frame behind the released ones
+    released = push_all(window, { 8, 3 });
+    ASSERT_TRUE(released.empty());
+    ASSERT_EQ(window.GetDuplicateNum(), 1);
+    ASSERT_EQ(window.GetLateNum(), 1);
+}
+
+TEST(ReorderWindow, WaitIsBounded)
+{
+    SVWindow window;
+    window.SetMaxWait(MAX_WAIT);
+
+    // 2 is lost: 3 and 4 wait until the limit
+    auto released = push_all(window, { 0, 1, 3, 4 }, 1000);
+    ASSERT_EQ(released, std::vector< uint16_t >({ 0, 1 }));
+    ASSERT_EQ(window.GetPendingNum(), 2);
+
+    released = push_all(window, { 5 }, 1000 + MAX_WAIT);
+    ASSERT_EQ(released, std::vector< uint16_t >({ 3, 4, 5 }));
+    ASSERT_EQ(window.GetSkippedNum(), 1);
+
+    // Late after the skip
+    released = push_all(window, { 2 }, 1000 + MAX_WAIT);
+    ASSERT_TRUE(released.empty());
+    ASSERT_EQ(window.GetLateNum(), 1);
+
+    // A full window doesn't wait
+    released = push_all(window, { 7, 8, 9, 10, 11, 12, 13 }, 2000);
+    ASSERT_TRUE(released.empty());
+    released = push_all(window, { 14 }, 2000);
+    ASSERT_EQ(released, std::vector< uint16_t >({ 7, 8, 9, 10, 11, 12, 13, 14 }));
+    ASSERT_EQ(window.GetSkippedNum(), 2);
+}
+
+TEST(ReorderWindow, SmpCntWrapAndRestart)
+{
+    SVWindow window;
+    window.SetMaxWait(MAX_WAIT);
+
+    // smpCnt 0 is always next, so the frames after it can be reordered only
+    auto released = push_all(window, { 3998, 3999, 1, 0, 2 });
+    ASSERT_EQ(released, std::vector< uint16_t >({ 3998, 3999, 0, 1, 2 }));
+    ASSERT_EQ(window.GetReorderedNum(), 1);
+
+    // The publisher restarted far behind: the window follows it after a run of late frames
+    std::vector< uint16_t > restart;
+    for (uint16_t i=0;i<SVWindow::RESYNC_LATE_NUM;++i) {
+        restart.push_back(2000 + i);
+    }
+    restart.push_back(2000 + SVWindow::RESYNC_LATE_NUM);
+    released = push_all(window, restart);
+    ASSERT_EQ(released.size(), 2);
+    ASSERT_EQ(released.back(), 2000 + SVWindow::RESYNC_LATE_NUM);
+}
+
+TEST(ReorderWindow, NoSequenceErrorsOfReorderedStreams)
+{
+    SVStreamSource sv;
+    sv.SetReorderWait(MAX_WAIT);
+    const SVStreamPassport svPass = sv.GetPassport();
+    for (uint16_t smpCnt : { 0, 2, 1, 3, 5, 4, 6 }) {
+        sv.ProcessState(svPass, SVStreamState{ smpCnt }, 0);
+    }
+    ASSERT_EQ(sv.GetErrSeqNum(), 0);
+    ASSERT_EQ(sv.GetSmpCnt(), 6);
+    ASSERT_EQ(sv.GetReorder().GetReorderedNum(), 2);
+
+    GooseSource goose;
+    goose.SetReorderWait(MAX_WAIT);
+    const GoosePassport goosePass = goose.GetPassport();
+    const GooseState states[] = { { 0, 1, 0 }, { 0, 3, 0 }, { 0, 2, 0 }, { 0, 4, 0 } };
+    for (const GooseState &state : states) {
+        goose.ProcessState(goosePass, state, 0);
+    }
+    goose.FlushReorder();
+    ASSERT_EQ(goose.GetErrSeqNum(), 0);
+    ASSERT_EQ(goose.GetState().stNum, 4);
+    ASSERT_EQ(goose.GetReorder().GetReorderedNum(), 1);
+    ASSERT_EQ(goose.GetReorder().GetSkippedNum(), 0);
+}
+
+TEST(ReorderWindow, SmpCntStepsByASDUNum)
+{
+    // SV256: 8 ASDU per frame, smpCnt of the frame is the first ASDU's
+    SVStreamSource sv;
+    sv.SetNumASDU(8).SetReorderWait(MAX_WAIT);
+    const SVStreamPassport svPass = sv.GetPassport();
+    for (uint16_t smpCnt : { 0, 8, 16, 24, 40, 32, 48 }) {
+        sv.ProcessState(svPass, SVStreamState{ smpCnt }, 0);
+    }
+    ASSERT_EQ(sv.GetErrSeqNum(), 0);
+    ASSERT_EQ(sv.GetSmpCnt(), 48);
+    ASSERT_EQ(sv.GetReorder().GetReorderedNum(), 1);
+    ASSERT_EQ(sv.GetReorder().GetSkippedNum(), 0);
+    ASSERT_EQ(sv.GetReorder().GetPendingNum(), 0);
+}
+
+TEST(ReorderWindow, QuietStreamExpires)
+{
+    // 2 is lost and the stream goes quiet: 3 is released by the expiry only
+    SVStreamSource sv;
+    sv.SetReorderWait(MAX_WAIT);
+    const SVStreamPassport svPass = sv.GetPassport();
+    for (uint16_t smpCnt : { 0, 1, 3 }) {
+        sv.ProcessState(svPass, SVStreamState{ smpCnt }, 1000);
+    }
+    ASSERT_EQ(sv.GetSmpCnt(), 1);
+
+    ReorderPending< SVStreamSource > pending;
+    pending.Track(&sv);
+    pending.Track(&sv);
+    ASSERT_EQ(pending.GetStreamNum(), 1);
+
+    pending.Expire(1000 + MAX_WAIT - 1);
+    ASSERT_EQ(sv.GetSmpCnt(), 1);
+    ASSERT_FALSE(pending.IsEmpty());
+
+    pending.Expire(1000 + MAX_WAIT);
+    ASSERT_EQ(sv.GetSmpCnt(), 3);
+    ASSERT_EQ(sv.GetErrSeqNum(), 1);
+    ASSERT_EQ(sv.GetReorder().GetSkippedNum(), 1);
+    ASSERT_EQ(sv.GetReorder().GetPendingNum(), 0);
+    ASSERT_TRUE(pending.IsEmpty());
+}
@@ -0,0 +1,131 @@
+#include "bus_generator/routable_frame.hpp"
+#include "bus_processor/process_bus_parser.hpp"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief L2 GOOSE: VLAN tag, APPID = 0x0102 and a fake APDU of apduLen bytes
+     */
+    std::vector< uint8_t > make_l2_frame(size_t apduLen)
+    {
+        std::vector< uint8_t > frame = {
+            0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01,     // dst
+            0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5,     // src
+            0x81, 0x00, 0x80, 0x00,                 // VLAN
+            0x88, 0xB8,                             // GOOSE
+            0x01, 0x02,                             // APPID
+            0x00, (uint8_t)(8 + apduLen),           // Length
+            0x00, 0x00, 0x00, 0x00                  // Reserved
+        };
+        for (size_t i=0;i<apduLen;++i) {
+            frame.push_back(0x61 + i);
+        }
+        return frame;
+    }
+}
+
+TEST(RoutableFrame, SessionLayout)
+{
+    const size_t APDU_LEN = 40;
+    std::vector< uint8_t > l2 = make_l2_frame(APDU_LEN);
+    std::vector< uint8_t > skeleton(l2);
+    skeleton.resize(512);
+
+    size_t size = l2.size();
+    RoutableFrame frame;
+    int shift = frame.Wrap(skeleton.data(), size, skeleton.size(), RSession::SI_GOOSE, RoutableConfig());
+
+    // Eth(18 with VLAN) + IPv4(20) + UDP(8) + session + APDU + signature
+    const size_t sessionOffset = 18 + 20 + 8;
+    ASSERT_EQ(size, sessionOffset + RSession::APDU_OFFSET + APDU_LEN + RSession::SIGNATURE_SIZE);
+    ASSERT_EQ(shift, (int)(sessionOffset + RSession::APDU_OFFSET) - 26);
+
+    const uint8_t *p = skeleton.data();
+    ASSERT_EQ(p[0], 0x01); ASSERT_EQ(p[1], 0x00); ASSERT_EQ(p[2], 0x5E); // IPv4 multicast MAC
+    ASSERT_EQ(p[16], 0x08); ASSERT_EQ(p[17], 0x00);
+
+    const uint8_t *s = p + sessionOffset;
+    ASSERT_EQ(s[RSession::SI_OFFSET], RSession::SI_GOOSE);
+    ASSERT_EQ(s[1], RSession::SESSION_LI);
+    ASSERT_EQ(s[2], RSession::COMMON_PI);
+    ASSERT_EQ(s[3], RSession::COMMON_LI);
+    ASSERT_EQ(s[RSession::PAYLOAD_TYPE_OFFSET], RSession::PAYLOAD_GOOSE);
+    ASSERT_EQ(s[RSession::APPID_OFFSET], 0x01);
+    ASSERT_EQ(s[RSession::APPID_OFFSET + 1], 0x02);
+    ASSERT_EQ(frame.GetAppIDOffset(), sessionOffset + RSession::APPID_OFFSET);
+    ASSERT_EQ(std::memcmp(s + RSession::APDU_OFFSET, l2.data() + 26, APDU_LEN), 0);
+    ASSERT_EQ(s[RSession::APDU_OFFSET + APDU_LEN], RSession::SIGNATURE_TAG);
+    ASSERT_EQ(s[RSession::APDU_OFFSET + APDU_LEN + 1], 0);
+}
+
+TEST(RoutableFrame, IncrementalChecksum)
+{
+    const size_t APDU_LEN = 41;
+    std::vector< uint8_t > skeleton = make_l2_frame(APDU_LEN);
+    size_t size = skeleton.size();
+    skeleton.resize(512);
+
+    RoutableFrame frame;
+    int shift = frame.Wrap(skeleton.data(), size, skeleton.size(), RSession::SI_GOOSE, RoutableConfig());
+
+    // Fields at even and odd offsets of the APDU
+    const uint16_t apdu = 26 + shift;
+    frame.AddVarField(apdu + 3, 8);
+    frame.AddVarField(apdu + 12, 4);
+    frame.AddVarField(apdu + 21, 1);
+
+    std::vector< uint8_t > base(skeleton.begin(), skeleton.begin() + size);
+    uint16_t baseSum = frame.BaseSum(base.data());
+
+    std::vector< uint8_t > packet(skeleton.begin(), skeleton.begin() + size);
+    uint32_t spduNum = 0x01020304;
+    for (int k=0;k<100;++k) {
+        for (size_t i=0;i<8;++i) {
+            packet[apdu + 3 + i] = k * 7 + i;
+        }
+        *(uint32_t *)(packet.data() + apdu + 12) = k * 0x01010101;
+        packet[apdu + 21] = k;
+
+        frame.Finish(packet.data(), spduNum, baseSum);
+
+        // The full checksum of the same packet
+        rte_ipv4_hdr *ip = (rte_ipv4_hdr *)(packet.data() + 18);
+        rte_udp_hdr *udp = (rte_udp_hdr *)(packet.data() + 18 + 20);
+        uint16_t incremental = udp->dgram_cksum;
+        udp->dgram_cksum = 0;
+        ASSERT_EQ(incremental, rte_ipv4_udptcp_cksum(ip, udp)) << k;
+        udp->dgram_cksum = incremental;
+    }
+    ASSERT_EQ(spduNum, 0x01020304 + 100);
+}
+
+TEST(RoutableFrame, TruncatedSessionIsNotBus)
+{
+    const size_t APDU_LEN = 40;
+    std::vector< uint8_t > skeleton = make_l2_frame(APDU_LEN);
+    size_t size = skeleton.size();
+    skeleton.resize(512);
+
+    RoutableFrame frame;
+    frame.Wrap(skeleton.data(), size, skeleton.size(), RSession::SI_GOOSE, RoutableConfig());
+
+    BusPduLocation loc;
+    ASSERT_EQ(ProcessBusParser::locate_pdu(skeleton.data(), size, loc), BUS_PROTO_GOOSE);
+    ASSERT_TRUE(loc.routable);
+
+    // The session header is cut: nothing behind the frame is read
+    const unsigned sessionOffset = 18 + 20 + 8;
+    for (unsigned cut=2;cut<RSession::APDU_OFFSET;++cut) {
+        std::vector< uint8_t > packet(skeleton.begin(), skeleton.begin() + sessionOffset + cut);
+        ASSERT_EQ(ProcessBusParser::locate_pdu(packet.data(), packet.size(), loc), NON_BUS_PROTO) << cut;
+    }
+
+    // A wrong session length isn't taken as the payload's offset
+    std::vector< uint8_t > packet(skeleton.begin(), skeleton.begin() + size);
+    packet[sessionOffset + 1] = 0xFF;
+    ASSERT_EQ(ProcessBusParser::locate_pdu(packet.data(), packet.size(), loc), NON_BUS_PROTO);
+}
@@ -117,6 +117,25 @@ TEST(SVFastParser, BasicUsage)
     ASSERT_EQ(passport.svid, sv80.GetSVID()) << passport;
 }
 
+TEST(SVFastParser, RoutableSV)
+{
+    SVTrafficGen gen(2, SV_TYPE::SV256);
+    gen.MakeRoutable(RoutableConfig());
+
+    std::vector< uint8_t > buffer(gen.GetSkeletonBuffer(),
+                                  gen.GetSkeletonBuffer() + gen.GetSkeletonSize());
+    size_t size = gen.AmendPacketSV256(buffer.data(), SVPacketDesc{ 0 });
+
+    SVStreamPassport passport;
+    SVStreamState state;
+    int retval = ProcessBusParser::parse_sv_packet(buffer.data(), size, passport, state);
+    ASSERT_EQ(retval, 0);
+    ASSERT_EQ(passport.appid, 1);
+    ASSERT_EQ(passport.num, 8);
+    ASSERT_TRUE(passport.svid.starts_with("SVID"));
+    ASSERT_EQ(passport.dmac, MAC("01:00:5E:40:00:01"));
+}
+
 TEST(SVStreamContainer, BasicUsage)
 {
     SVContainer svStreamMap;
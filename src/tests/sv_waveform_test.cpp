@@ -0,0 +1,81 @@
+#include "bus_generator/sv_waveform.hpp"
+#include "bus_generator/comtrade.hpp"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+
+TEST(SVWaveform, Synthesize)
+{
+    SVWaveformConfig conf;
+    conf.currentA = 100.0;
+    conf.voltageV = 1'000.0;
+
+    auto wave = SVWaveform::Synthesize(conf, 4000);
+    ASSERT_EQ(wave->GetRowNum(), 4000);
+
+    // 80 samples per period: the peak of phase A is at 20
+    ASSERT_EQ(wave->GetValue(0, 0), 0);
+    ASSERT_NEAR(wave->GetValue(20, 0), 100.0 * M_SQRT2 / SV_CURRENT_LSB, 1);
+    ASSERT_NEAR(wave->GetValue(20, 4), 1'000.0 * M_SQRT2 / SV_VOLTAGE_LSB, 1);
+
+    // Symmetrical: neutrals are zero
+    for (size_t i=0;i<80;++i) {
+        ASSERT_NEAR(wave->GetValue(i, 3), 0, 2) << i;
+        ASSERT_NEAR(wave->GetValue(i, 7), 0, 2) << i;
+    }
+}
+
+TEST(SVWaveform, FaultStep)
+{
+    SVWaveformConfig conf;
+    conf.currentA = 100.0;
+    conf.faultMS = 500.0;
+    conf.faultPhases = "A";
+    conf.faultCurrentMult = 10.0;
+
+    auto wave = SVWaveform::Synthesize(conf, 4000);
+
+    // Before and after the fault at 2000th sample
+    ASSERT_NEAR(wave->GetValue(1940, 0), 100.0 * M_SQRT2 / SV_CURRENT_LSB, 1);
+    ASSERT_NEAR(wave->GetValue(2020, 0), 1'000.0 * M_SQRT2 / SV_CURRENT_LSB, 10);
+    // Phase B isn't faulted, neutral is the sum
+    ASSERT_NEAR(wave->GetValue(2020, 1), 100.0 * M_SQRT2 * std::sin(M_PI / 2 - 2 * M_PI / 3) / SV_CURRENT_LSB, 1);
+    ASSERT_NE(wave->GetValue(2020, 3), 0);
+}
+
+TEST(SVWaveform, Comtrade)
+{
+    std::stringstream cfg(
+        "Station,Relay,1999\r\n"
+        "2,2A,0D\r\n"
+        "1,IA,A,,A,0.5,0,0,-32767,32767,1000,1,P\r\n"
+        "2,UA,A,,kV,0.1,0,0,-32767,32767,110,0.1,P\r\n"
+        "50\r\n"
+        "1\r\n"
+        "1000,3\r\n"
+        "01/01/2024,00:00:00.000000\r\n"
+        "01/01/2024,00:00:00.000000\r\n"
+        "ASCII\r\n"
+        "1\r\n");
+    std::stringstream dat(
+        "1,0,0,0\r\n"
+        "2,1000,200,10\r\n"
+        "3,2000,400,20\r\n");
+
+    auto rec = ComtradeRecord::Parse(cfg, dat);
+    ASSERT_EQ(rec.GetChannels().size(), 2);
+    ASSERT_EQ(rec.GetSampleNum(), 3);
+    ASSERT_DOUBLE_EQ(rec.GetTimeUS(2), 2'000.0);
+    ASSERT_DOUBLE_EQ(rec.GetValue(0, 1), 100.0);
+
+    // 1 kHz -> 4 kHz: 2 ms is 9 rows, values are interpolated
+    auto wave = SVWaveform::FromComtrade(rec, 4000);
+    ASSERT_EQ(wave->GetRowNum(), 9);
+    ASSERT_EQ(wave->GetValue(2, 0), (int32_t)(50.0 / SV_CURRENT_LSB));
+    ASSERT_EQ(wave->GetValue(8, 0), (int32_t)(200.0 / SV_CURRENT_LSB));
+    ASSERT_EQ(wave->GetValue(4, 4), (int32_t)(1'000.0 / SV_VOLTAGE_LSB));
+    // Phases B and C are absent
+    ASSERT_EQ(wave->GetValue(4, 1), 0);
+    ASSERT_EQ(wave->GetValue(4, 3), wave->GetValue(4, 0));
+}
@@ -0,0 +1,75 @@
+#include "bus_generator/timing_wheel.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(TimingWheel, ExpireAcrossLevels)
+{
+    TimingWheel< 3, 4 > wheel(4); // 16 slots per level
+
+    // The first level, the second and the third one
+    wheel.Schedule(0, 5);
+    wheel.Schedule(1, 16);
+    wheel.Schedule(2, 300);
+    wheel.Schedule(3, 4000);
+
+    std::vector< uint64_t > expired(4, 0);
+    for (unsigned t=0;t<4096;++t) {
+        wheel.Advance([&](uint32_t id) { expired[id] = wheel.GetNow(); });
+    }
+
+    ASSERT_EQ(expired[0], 5);
+    ASSERT_EQ(expired[1], 16);
+    ASSERT_EQ(expired[2], 300);
+    ASSERT_EQ(expired[3], 4000);
+    for (uint32_t id=0;id<4;++id) {
+        ASSERT_FALSE(wheel.IsScheduled(id));
+    }
+}
+
+TEST(TimingWheel, RescheduleAndCancel)
+{
+    TimingWheel<> wheel(3);
+    wheel.Schedule(0, 10);
+    wheel.Schedule(1, 10);
+    wheel.Schedule(2, 10);
+    ASSERT_EQ(wheel.GetDueNum(), 0);
+
+    wheel.Cancel(1);
+    wheel.Schedule(2, 3); // Earlier
+
+    // Periodic: each expiry schedules the next one
+    std::vector< uint64_t > fired;
+    for (unsigned t=0;t<30;++t) {
+        wheel.Advance([&](uint32_t id) {
+            fired.push_back(wheel.GetNow() * 10 + id);
+            if (id == 0) {
+                wheel.Schedule(0, 10);
+            }
+        });
+    }
+
+    ASSERT_EQ(fired, (std::vector< uint64_t >{ 32, 100, 200, 300 }));
+    ASSERT_FALSE(wheel.IsScheduled(1));
+    ASSERT_TRUE(wheel.IsScheduled(0));
+}
+
+TEST(TimingWheel, GooseRetransmissionCurve)
+{
+    // T0 = 2 ticks, heartbeat = 32 ticks
+    const uint64_t T0 = 2, HEARTBEAT = 32;
+    TimingWheel<> wheel(1);
+    uint64_t interval = T0;
+    wheel.Schedule(0, interval);
+
+    std::vector< uint64_t > moments;
+    for (unsigned t=0;t<100;++t) {
+        wheel.Advance([&](uint32_t id) {
+            moments.push_back(wheel.GetNow());
+            interval = std::min(interval * 2, HEARTBEAT);
+            wheel.Schedule(id, interval);
+        });
+    }
+
+    ASSERT_EQ(moments, (std::vector< uint64_t >{ 2, 6, 14, 30, 62, 94 }));
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * XDP program of AF_XDP mode: ProcessBus frames go to the AF_XDP socket of
+ * the RX queue, the rest of traffic(IP, ARP, LLDP...) stays in the kernel.
+ *
+ * Redirected: GOOSE(0x88B8), SV(0x88BA), PTP(0x88F7), HSR(0x892F) with or
+ * without VLAN tag and R-GOOSE/R-SV(IPv4/UDP, dst port 102).
+ *
+ * DPDK's net_af_xdp loads it by xdp_prog=, the map must be named xsks_map.
+ */
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/in.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#define ETH_P_GOOSE     0x88B8
+#define ETH_P_SV        0x88BA
+#define ETH_P_PTP       0x88F7
+#define ETH_P_HSR_TAG   0x892F
+#define ETH_P_VLAN      0x8100
+#define R_BUS_UDP_PORT  102     /* IEC 61850-90-5 */
+#define IP_FRAGMENTS    0x3FFF  /* MF and offset */
+
+#define MAX_QUEUES      64
+
+struct {
+    __uint(type, BPF_MAP_TYPE_XSKMAP);
+    __uint(max_entries, MAX_QUEUES);
+    __type(key, __u32);
+    __type(value, __u32);
+} xsks_map SEC(".maps");
+
+static __always_inline int is_routable_bus(void *l3, void *end)
+{
+    struct iphdr *ip = l3;
+    if ((void *)(ip + 1) > end || ip->version != 4 || ip->protocol != IPPROTO_UDP) {
+        return 0;
+    }
+    /* Fragments go to the kernel as the processor does */
+    if (ip->frag_off & bpf_htons(IP_FRAGMENTS)) {
+        return 0;
+    }
+
+    struct udphdr *udp = l3 + ip->ihl * 4;
+    if ((void *)(udp + 1) > end) {
+        return 0;
+    }
+    return udp->dest == bpf_htons(R_BUS_UDP_PORT);
+}
+
+SEC("xdp")
+int pbus_xdp(struct xdp_md *ctx)
+{
+    void *data = (void *)(long)ctx->data;
+    void *end = (void *)(long)ctx->data_end;
+
+    struct ethhdr *eth = data;
+    if ((void *)(eth + 1) > end) {
+        return XDP_PASS;
+    }
+
+    void *l3 = eth + 1;
+    __u16 type = bpf_ntohs(eth->h_proto);
+    if (type == ETH_P_VLAN) {
+        /* TCI(2) + EtherType(2) */
+        if (l3 + 4 > end) {
+            return XDP_PASS;
+        }
+        type = bpf_ntohs(*(__be16 *)(l3 + 2));
+        l3 += 4;
+    }
+
+    int redirect = 0;
+    switch (type) {
+    case ETH_P_GOOSE:
+    case ETH_P_SV:
+    case ETH_P_PTP:
+    case ETH_P_HSR_TAG:
+        redirect = 1;
+        break;
+    case ETH_P_IP:
+        redirect = is_routable_bus(l3, end);
+        break;
+    default:
+        break;
+    }
+
+    if (!redirect) {
+        return XDP_PASS;
+    }
+    /* No socket on the queue: the frame stays in the kernel */
+    return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+}
+
+char _license[] SEC("license") = "GPL";